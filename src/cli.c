@@ -873,6 +873,16 @@ int main(int argc, char **argv)
         http_options.proxy_url = NULL;
     }
 
+    // bandwidth limits in bytes per second
+    char *upload_rate_limit = getenv("STORJ_UPLOAD_RATE_LIMIT");
+    char *download_rate_limit = getenv("STORJ_DOWNLOAD_RATE_LIMIT");
+    if (upload_rate_limit) {
+        http_options.upload_rate_limit = strtoull(upload_rate_limit, NULL, 10);
+    }
+    if (download_rate_limit) {
+        http_options.download_rate_limit = strtoull(download_rate_limit, NULL, 10);
+    }
+
     char *user = NULL;
     char *pass = NULL;
     char *mnemonic = NULL;
@@ -258,15 +258,25 @@ static int upload_file(storj_env_t *env, char *bucket_id, const char *file_path,
     char *prepare_frame_limit = getenv("STORJ_PREPARE_FRAME_LIMIT");
     char *push_frame_limit = getenv("STORJ_PUSH_FRAME_LIMIT");
     char *push_shard_limit = getenv("STORJ_PUSH_SHARD_LIMIT");
+    char *push_shard_min = getenv("STORJ_PUSH_SHARD_MIN");
+    char *push_shard_max = getenv("STORJ_PUSH_SHARD_MAX");
+    char *encode_threads = getenv("STORJ_ENCODE_THREADS");
     char *rs = getenv("STORJ_REED_SOLOMON");
+    char *stream = getenv("STORJ_STREAM_UPLOAD");
+    char *journal = getenv("STORJ_UPLOAD_JOURNAL");
 
     storj_upload_opts_t upload_opts = {
         .prepare_frame_limit = (prepare_frame_limit) ? atoi(prepare_frame_limit) : 1,
         .push_frame_limit = (push_frame_limit) ? atoi(push_frame_limit) : 64,
         .push_shard_limit = (push_shard_limit) ? atoi(push_shard_limit) : 64,
+        .push_shard_min = (push_shard_min) ? atoi(push_shard_min) : 0,
+        .push_shard_max = (push_shard_max) ? atoi(push_shard_max) : 0,
+        .encode_threads = (encode_threads) ? atoi(encode_threads) : 0,
         .rs = (!rs) ? true : (strcmp(rs, "false") == 0) ? false : true,
+        .stream = (stream && strcmp(stream, "true") == 0) ? true : false,
         .bucket_id = bucket_id,
         .file_name = file_name,
+        .journal_path = journal,
         .fd = fd
     };
 
@@ -351,13 +361,21 @@ static int upload_files(storj_env_t *env, char *bucket_id, const char *file_path
     char *prepare_frame_limit = getenv("STORJ_PREPARE_FRAME_LIMIT");
     char *push_frame_limit = getenv("STORJ_PUSH_FRAME_LIMIT");
     char *push_shard_limit = getenv("STORJ_PUSH_SHARD_LIMIT");
+    char *push_shard_min = getenv("STORJ_PUSH_SHARD_MIN");
+    char *push_shard_max = getenv("STORJ_PUSH_SHARD_MAX");
+    char *encode_threads = getenv("STORJ_ENCODE_THREADS");
     char *rs = getenv("STORJ_REED_SOLOMON");
+    char *stream = getenv("STORJ_STREAM_UPLOAD");
 
     storj_upload_opts_t upload_opts = {
         .prepare_frame_limit = (prepare_frame_limit) ? atoi(prepare_frame_limit) : 1,
         .push_frame_limit = (push_frame_limit) ? atoi(push_frame_limit) : 64,
         .push_shard_limit = (push_shard_limit) ? atoi(push_shard_limit) : 64,
+        .push_shard_min = (push_shard_min) ? atoi(push_shard_min) : 0,
+        .push_shard_max = (push_shard_max) ? atoi(push_shard_max) : 0,
+        .encode_threads = (encode_threads) ? atoi(encode_threads) : 0,
         .rs = (!rs) ? true : (strcmp(rs, "false") == 0) ? false : true,
+        .stream = (stream && strcmp(stream, "true") == 0) ? true : false,
         .bucket_id = bucket_id,
         .file_name = file_name,
         .fd = fd
@@ -464,6 +482,12 @@ static void download_file_complete(int status, FILE *fd, void *handle)
     cli_api_t *cli_api = handle;
     cli_api->rcvd_cmd_resp = "download-file-resp";
 
+    // streamed downloads are written to the destination of the command
+    if (!fd) {
+        fd = cli_api->dst_fd;
+        cli_api->dst_fd = NULL;
+    }
+
     printf("\n");
     fclose(fd);
     if (status) {
@@ -485,6 +509,18 @@ static void download_file_complete(int status, FILE *fd, void *handle)
     queue_next_cmd_req(cli_api);
 }
 
+static int download_file_write(const uint8_t *buffer, size_t length,
+                               void *handle)
+{
+    cli_api_t *cli_api = handle;
+
+    if (fwrite(buffer, sizeof(uint8_t), length, cli_api->dst_fd) != length) {
+        return 1;
+    }
+
+    return 0;
+}
+
 static void download_signal_handler(uv_signal_t *req, int signum)
 {
     storj_download_state_t *state = req->data;
@@ -500,7 +536,19 @@ static int download_file(storj_env_t *env, char *bucket_id,
 {
     FILE *fd = NULL;
 
-    if (path) {
+    // Download opts env variables:
+    char *stream = getenv("STORJ_STREAM_DOWNLOAD");
+    char *journal = getenv("STORJ_DOWNLOAD_JOURNAL");
+    char *min_concurrency = getenv("STORJ_DOWNLOAD_MIN_CONCURRENCY");
+    char *max_concurrency = getenv("STORJ_DOWNLOAD_MAX_CONCURRENCY");
+
+    // a download with a journal continues to the existing file
+    bool resume = path && journal && access(journal, F_OK) != -1 &&
+        access(path, F_OK) != -1;
+
+    if (path && resume) {
+        fd = fopen(path, "r+");
+    } else if (path) {
         char user_input[BUFSIZ];
         memset(user_input, '\0', BUFSIZ);
 
@@ -543,13 +591,36 @@ static int download_file(storj_env_t *env, char *bucket_id,
         progress_cb = file_progress;
     }
 
-    storj_download_state_t *state = storj_bridge_resolve_file(env, bucket_id,
-                                                              file_id, fd, handle,
-                                                              progress_cb,
-                                                              download_file_complete);
+    storj_download_state_t *state = NULL;
+
+    // stdout can not be written at random positions and is always streamed
+    if (!path || (stream && strcmp(stream, "true") == 0)) {
+        cli_api_t *cli_api = handle;
+        cli_api->dst_fd = fd;
+
+        state = storj_bridge_resolve_file_stream(env, bucket_id, file_id,
+                                                 handle,
+                                                 download_file_write,
+                                                 progress_cb,
+                                                 download_file_complete);
+    } else {
+        state = storj_bridge_resolve_file(env, bucket_id,
+                                          file_id, fd, handle,
+                                          progress_cb,
+                                          download_file_complete);
+        if (state) {
+            state->journal_path = journal;
+        }
+    }
     if (!state) {
         return 1;
     }
+    if (min_concurrency) {
+        state->download_min_concurrency = atoi(min_concurrency);
+    }
+    if (max_concurrency) {
+        state->download_max_concurrency = atoi(max_concurrency);
+    }
     sig->data = state;
 
     return state->error_status;
@@ -1,5 +1,11 @@
 #include "crypto.h"
 
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define STORJ_CRYPTO_X86 1
+#include <cpuid.h>
+#include <immintrin.h>
+#endif
+
 int ripemd160sha256_as_string(uint8_t *data, uint64_t data_size, char *digest)
 {
     uint8_t *ripemd160_digest = calloc(RIPEMD160_DIGEST_SIZE, sizeof(char));
@@ -141,71 +147,58 @@ cleanup:
     return status;
 }
 
-int decrypt_bucket_name(const char *mnemonic, const char *encrypted_name, char **decrypted_name) {
-    return decrypt_file_name(mnemonic, BUCKET_NAME_MAGIC, encrypted_name, decrypted_name);
+static void get_name_key(const uint8_t *bucket_key, uint8_t *key)
+{
+    // Get encryption key with first half of hmac w/ magic
+    struct hmac_sha512_ctx ctx1;
+    hmac_sha512_set_key(&ctx1, SHA256_DIGEST_SIZE, bucket_key);
+    hmac_sha512_update(&ctx1, SHA256_DIGEST_SIZE, BUCKET_META_MAGIC);
+    hmac_sha512_digest(&ctx1, SHA256_DIGEST_SIZE, key);
 }
 
-int decrypt_file_name(const char *mnemonic, const char* bucket_id,
-                      const char *encrypted_name, char **decrypted_name) {
+static int decrypt_name(const char *bucket_key_as_str,
+                        const char *encrypted_name, char **decrypted_name)
+{
     int status = 0;
 
-    // Derive a key based on the bucket id
-    char *bucket_key_as_str = calloc(DETERMINISTIC_KEY_SIZE + 1, sizeof(char));
-    generate_bucket_key(mnemonic, bucket_id, &bucket_key_as_str);
-
-    uint8_t *bucket_key = str2hex(strlen(bucket_key_as_str), bucket_key_as_str);
+    uint8_t *bucket_key = str2hex(strlen(bucket_key_as_str),
+                                  (char *)bucket_key_as_str);
     if (!bucket_key) {
         status = 1;
         goto cleanup;
     }
 
-    // Get encryption key with first half of hmac w/ magic
-    struct hmac_sha512_ctx ctx1;
-    hmac_sha512_set_key(&ctx1, SHA256_DIGEST_SIZE, bucket_key);
-    hmac_sha512_update(&ctx1, SHA256_DIGEST_SIZE, BUCKET_META_MAGIC);
     uint8_t key[SHA256_DIGEST_SIZE];
-    hmac_sha512_digest(&ctx1, SHA256_DIGEST_SIZE, key);
+    get_name_key(bucket_key, key);
 
     status = decrypt_meta(encrypted_name, key, decrypted_name);
 
+    memset_zero(key, SHA256_DIGEST_SIZE);
+
 cleanup:
 
     if (bucket_key) {
         memset_zero(bucket_key, BASE16_DECODE_LENGTH(strlen(bucket_key_as_str)) + 1);
         free(bucket_key);
     }
-    if (bucket_key_as_str) {
-        memset_zero(bucket_key_as_str, DETERMINISTIC_KEY_SIZE + 1);
-        free(bucket_key_as_str);
-    }
 
     return status;
 }
 
-int encrypt_bucket_name(const char *mnemonic, const char *bucket_name, char **encrypted_name) {
-    return encrypt_file_name(mnemonic, BUCKET_NAME_MAGIC, bucket_name, encrypted_name);
-}
-
-int encrypt_file_name(const char *mnemonic, const char* bucket_id,
-                      const char *file_name, char **encrypted_name) {
+static int encrypt_name(const char *bucket_key_as_str, const char *bucket_id,
+                        const char *file_name, char **encrypted_name)
+{
     int status = 0;
 
-    // Derive a key based on the bucket id
-    char *bucket_key_as_str = calloc(DETERMINISTIC_KEY_SIZE + 1, sizeof(char));
-    generate_bucket_key(mnemonic, bucket_id, &bucket_key_as_str);
-
-    uint8_t *bucket_key = str2hex(strlen(bucket_key_as_str), bucket_key_as_str);
+    uint8_t *bucket_key = str2hex(strlen(bucket_key_as_str),
+                                  (char *)bucket_key_as_str);
     if (!bucket_key) {
         status = 1;
         goto cleanup;
     }
 
-    // Get encryption key with first half of hmac w/ magic
-    struct hmac_sha512_ctx ctx1;
-    hmac_sha512_set_key(&ctx1, SHA256_DIGEST_SIZE, bucket_key);
-    hmac_sha512_update(&ctx1, SHA256_DIGEST_SIZE, BUCKET_META_MAGIC);
     uint8_t key[SHA256_DIGEST_SIZE];
-    hmac_sha512_digest(&ctx1, SHA256_DIGEST_SIZE, key);
+    get_name_key(bucket_key, key);
 
     // Generate the synthetic iv with first half of hmac w/ bucket and filename
     struct hmac_sha512_ctx ctx2;
@@ -219,17 +212,280 @@ int encrypt_file_name(const char *mnemonic, const char* bucket_id,
 
     status = encrypt_meta(file_name, key, iv, encrypted_name);
 
+    memset_zero(key, SHA256_DIGEST_SIZE);
+
 cleanup:
 
     if (bucket_key) {
         memset_zero(bucket_key, BASE16_DECODE_LENGTH(strlen(bucket_key_as_str)) + 1);
         free(bucket_key);
     }
-    if (bucket_key_as_str) {
-        memset_zero(bucket_key_as_str, DETERMINISTIC_KEY_SIZE + 1);
-        free(bucket_key_as_str);
+
+    return status;
+}
+
+int decrypt_bucket_name(const char *mnemonic, const char *encrypted_name, char **decrypted_name) {
+    return decrypt_file_name(mnemonic, BUCKET_NAME_MAGIC, encrypted_name, decrypted_name);
+}
+
+int decrypt_file_name(const char *mnemonic, const char* bucket_id,
+                      const char *encrypted_name, char **decrypted_name) {
+    int status = 0;
+
+    // Derive a key based on the bucket id
+    char *bucket_key_as_str = calloc(DETERMINISTIC_KEY_SIZE + 1, sizeof(char));
+    if (!bucket_key_as_str) {
+        return 1;
+    }
+    generate_bucket_key(mnemonic, bucket_id, &bucket_key_as_str);
+
+    status = decrypt_name(bucket_key_as_str, encrypted_name, decrypted_name);
+
+    memset_zero(bucket_key_as_str, DETERMINISTIC_KEY_SIZE + 1);
+    free(bucket_key_as_str);
+
+    return status;
+}
+
+int encrypt_bucket_name(const char *mnemonic, const char *bucket_name, char **encrypted_name) {
+    return encrypt_file_name(mnemonic, BUCKET_NAME_MAGIC, bucket_name, encrypted_name);
+}
+
+int encrypt_file_name(const char *mnemonic, const char* bucket_id,
+                      const char *file_name, char **encrypted_name) {
+    int status = 0;
+
+    // Derive a key based on the bucket id
+    char *bucket_key_as_str = calloc(DETERMINISTIC_KEY_SIZE + 1, sizeof(char));
+    if (!bucket_key_as_str) {
+        return 1;
+    }
+    generate_bucket_key(mnemonic, bucket_id, &bucket_key_as_str);
+
+    status = encrypt_name(bucket_key_as_str, bucket_id, file_name,
+                          encrypted_name);
+
+    memset_zero(bucket_key_as_str, DETERMINISTIC_KEY_SIZE + 1);
+    free(bucket_key_as_str);
+
+    return status;
+}
+
+static void key_cache_free(storj_key_cache_t *cache)
+{
+    memset_zero(cache, sizeof(storj_key_cache_t));
+
+#ifdef _POSIX_MEMLOCK
+    munlock(cache, sizeof(storj_key_cache_t));
+    free(cache);
+#elif _WIN32
+    VirtualUnlock(cache, sizeof(storj_key_cache_t));
+    VirtualFree(cache, 0, MEM_RELEASE);
+#else
+    free(cache);
+#endif
+}
+
+storj_key_cache_t *key_cache_new(const char *mnemonic)
+{
+    storj_key_cache_t *cache = NULL;
+
+    // prevent the seed and keys from being swapped unencrypted to disk
+#ifdef _POSIX_MEMLOCK
+    size_t page_size = sysconf(_SC_PAGESIZE);
+    size_t alloc_size = (sizeof(storj_key_cache_t) / page_size + 1) * page_size;
+
+#ifdef HAVE_ALIGNED_ALLOC
+    cache = aligned_alloc(page_size, alloc_size);
+#elif HAVE_POSIX_MEMALIGN
+    if (posix_memalign((void *)&cache, page_size, alloc_size)) {
+        return NULL;
+    }
+#else
+    cache = malloc(alloc_size);
+#endif
+
+    if (!cache) {
+        return NULL;
+    }
+
+    memset(cache, 0, alloc_size);
+    if (mlock(cache, sizeof(storj_key_cache_t))) {
+        free(cache);
+        return NULL;
+    }
+#elif _WIN32
+    cache = VirtualAlloc(NULL, sizeof(storj_key_cache_t),
+                         MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
+    if (!cache) {
+        return NULL;
+    }
+    memset(cache, 0, sizeof(storj_key_cache_t));
+    if (!VirtualLock(cache, sizeof(storj_key_cache_t))) {
+        VirtualFree(cache, 0, MEM_RELEASE);
+        return NULL;
+    }
+#else
+    cache = calloc(1, sizeof(storj_key_cache_t));
+    if (!cache) {
+        return NULL;
+    }
+#endif
+
+    if (uv_mutex_init(&cache->lock)) {
+        key_cache_free(cache);
+        return NULL;
+    }
+
+    cache->mnemonic = mnemonic;
+    cache->has_seed = false;
+    cache->total = 0;
+    cache->next = 0;
+
+    return cache;
+}
+
+void key_cache_destroy(storj_key_cache_t *cache)
+{
+    if (!cache) {
+        return;
+    }
+
+    uv_mutex_destroy(&cache->lock);
+    key_cache_free(cache);
+}
+
+int key_cache_get(storj_key_cache_t *cache, const char *bucket_id,
+                  char *bucket_key, uint8_t *name_key)
+{
+    int status = 0;
+    uint8_t *bucket_key_hex = NULL;
+
+    uv_mutex_lock(&cache->lock);
+
+    for (int i = 0; i < cache->total; i++) {
+        storj_key_cache_entry_t *entry = &cache->entries[i];
+        if (strcmp(entry->bucket_id, bucket_id) == 0) {
+            memcpy(bucket_key, entry->bucket_key, DETERMINISTIC_KEY_SIZE + 1);
+            memcpy(name_key, entry->name_key, SHA256_DIGEST_SIZE);
+            goto cleanup;
+        }
+    }
+
+    // The seed is only derived once as it's the most expensive step
+    if (!cache->has_seed) {
+        char *seed = cache->seed;
+        if (!mnemonic_to_seed(cache->mnemonic, "", &seed)) {
+            status = 1;
+            goto cleanup;
+        }
+        cache->seed[128] = '\0';
+        cache->has_seed = true;
+    }
+
+    if (get_deterministic_key(cache->seed, 128, bucket_id, &bucket_key)) {
+        status = 1;
+        goto cleanup;
+    }
+    bucket_key[DETERMINISTIC_KEY_SIZE] = '\0';
+
+    bucket_key_hex = str2hex(DETERMINISTIC_KEY_SIZE, bucket_key);
+    if (!bucket_key_hex) {
+        status = 1;
+        goto cleanup;
+    }
+    get_name_key(bucket_key_hex, name_key);
+
+    // Bucket ids are short, the bucket name magic is the longest
+    if (strlen(bucket_id) > STORJ_KEY_CACHE_ID_SIZE) {
+        goto cleanup;
+    }
+
+    storj_key_cache_entry_t *entry = &cache->entries[cache->next];
+    strcpy(entry->bucket_id, bucket_id);
+    memcpy(entry->bucket_key, bucket_key, DETERMINISTIC_KEY_SIZE + 1);
+    memcpy(entry->name_key, name_key, SHA256_DIGEST_SIZE);
+
+    cache->next = (cache->next + 1) % STORJ_KEY_CACHE_SIZE;
+    if (cache->total < STORJ_KEY_CACHE_SIZE) {
+        cache->total += 1;
+    }
+
+cleanup:
+    uv_mutex_unlock(&cache->lock);
+
+    if (bucket_key_hex) {
+        memset_zero(bucket_key_hex, DETERMINISTIC_KEY_HEX_SIZE);
+        free(bucket_key_hex);
+    }
+
+    return status;
+}
+
+int generate_file_key_cached(storj_key_cache_t *cache, const char *bucket_id,
+                             const char *index, char **file_key)
+{
+    char bucket_key[DETERMINISTIC_KEY_SIZE + 1];
+    uint8_t name_key[SHA256_DIGEST_SIZE];
+
+    int status = key_cache_get(cache, bucket_id, bucket_key, name_key);
+    if (!status) {
+        status = get_deterministic_key(bucket_key, 64, index, file_key);
+    }
+
+    memset_zero(bucket_key, DETERMINISTIC_KEY_SIZE + 1);
+    memset_zero(name_key, SHA256_DIGEST_SIZE);
+
+    return status;
+}
+
+int decrypt_bucket_name_cached(storj_key_cache_t *cache,
+                               const char *encrypted_name,
+                               char **decrypted_name)
+{
+    return decrypt_file_name_cached(cache, BUCKET_NAME_MAGIC, encrypted_name,
+                                    decrypted_name);
+}
+
+int decrypt_file_name_cached(storj_key_cache_t *cache, const char *bucket_id,
+                             const char *encrypted_name, char **decrypted_name)
+{
+    char bucket_key[DETERMINISTIC_KEY_SIZE + 1];
+    uint8_t name_key[SHA256_DIGEST_SIZE];
+
+    int status = key_cache_get(cache, bucket_id, bucket_key, name_key);
+    if (!status) {
+        status = decrypt_meta(encrypted_name, name_key, decrypted_name);
+    }
+
+    memset_zero(bucket_key, DETERMINISTIC_KEY_SIZE + 1);
+    memset_zero(name_key, SHA256_DIGEST_SIZE);
+
+    return status;
+}
+
+int encrypt_bucket_name_cached(storj_key_cache_t *cache,
+                               const char *bucket_name,
+                               char **encrypted_name)
+{
+    return encrypt_file_name_cached(cache, BUCKET_NAME_MAGIC, bucket_name,
+                                    encrypted_name);
+}
+
+int encrypt_file_name_cached(storj_key_cache_t *cache, const char *bucket_id,
+                             const char *file_name, char **encrypted_name)
+{
+    char bucket_key[DETERMINISTIC_KEY_SIZE + 1];
+    uint8_t name_key[SHA256_DIGEST_SIZE];
+
+    int status = key_cache_get(cache, bucket_id, bucket_key, name_key);
+    if (!status) {
+        status = encrypt_name(bucket_key, bucket_id, file_name, encrypted_name);
     }
 
+    memset_zero(bucket_key, DETERMINISTIC_KEY_SIZE + 1);
+    memset_zero(name_key, SHA256_DIGEST_SIZE);
+
     return status;
 }
 
@@ -288,6 +544,265 @@ int sha256_of_str(const uint8_t *str, int str_len, uint8_t *digest)
     return 0;
 }
 
+static const uint32_t SHA256_K[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5,
+    0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3,
+    0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc,
+    0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7,
+    0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13,
+    0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3,
+    0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5,
+    0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
+    0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+// Compresses the same number of blocks for each lane, each lane has its
+// own data and the data pointers are advanced past the blocks
+typedef void (*sha256_lanes_compress_func)(struct sha256_ctx *ctx,
+                                           const uint8_t **data,
+                                           unsigned lanes,
+                                           size_t blocks);
+
+static void sha256_lanes_compress_generic(struct sha256_ctx *ctx,
+                                          const uint8_t **data,
+                                          unsigned lanes,
+                                          size_t blocks)
+{
+    // nettle uses the fastest compression it has for a single context
+    for (size_t b = 0; b < blocks; b++) {
+        for (unsigned l = 0; l < lanes; l++) {
+            sha256_update(&ctx[l], SHA256_BLOCK_SIZE, data[l]);
+            data[l] += SHA256_BLOCK_SIZE;
+        }
+    }
+}
+
+#ifdef STORJ_CRYPTO_X86
+
+typedef uint32_t sha256_vec_t __attribute__ ((vector_size (32)));
+
+#define VEC_ROTR(x, n) (((x) >> (n)) | ((x) << (32 - (n))))
+#define VEC_CH(x, y, z) ((z) ^ ((x) & ((y) ^ (z))))
+#define VEC_MAJ(x, y, z) (((x) & (y)) | ((z) & ((x) | (y))))
+#define VEC_S0(x) (VEC_ROTR(x, 2) ^ VEC_ROTR(x, 13) ^ VEC_ROTR(x, 22))
+#define VEC_S1(x) (VEC_ROTR(x, 6) ^ VEC_ROTR(x, 11) ^ VEC_ROTR(x, 25))
+#define VEC_s0(x) (VEC_ROTR(x, 7) ^ VEC_ROTR(x, 18) ^ ((x) >> 3))
+#define VEC_s1(x) (VEC_ROTR(x, 17) ^ VEC_ROTR(x, 19) ^ ((x) >> 10))
+
+// Eight lanes at once in the 32 bit elements of AVX2 registers
+__attribute__ ((target ("avx2")))
+static void sha256_lanes_compress_avx2(struct sha256_ctx *ctx,
+                                       const uint8_t **data,
+                                       unsigned lanes,
+                                       size_t blocks)
+{
+    uint32_t words[16][STORJ_SHA256_LANES] __attribute__ ((aligned (32)));
+    uint32_t state[8][STORJ_SHA256_LANES] __attribute__ ((aligned (32)));
+    sha256_vec_t s[8];
+    sha256_vec_t w[16];
+
+    memset(words, 0, sizeof(words));
+    memset(state, 0, sizeof(state));
+
+    for (unsigned l = 0; l < lanes; l++) {
+        for (int i = 0; i < 8; i++) {
+            state[i][l] = ctx[l].state[i];
+        }
+    }
+    memcpy(s, state, sizeof(s));
+
+    for (size_t b = 0; b < blocks; b++) {
+        for (unsigned l = 0; l < lanes; l++) {
+            const uint8_t *p = data[l];
+            for (int t = 0; t < 16; t++) {
+                words[t][l] = ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) |
+                    ((uint32_t)p[2] << 8) | p[3];
+                p += 4;
+            }
+            data[l] += SHA256_BLOCK_SIZE;
+        }
+        memcpy(w, words, sizeof(w));
+
+        sha256_vec_t a = s[0], b_ = s[1], c = s[2], d = s[3];
+        sha256_vec_t e = s[4], f = s[5], g = s[6], h = s[7];
+
+        for (int t = 0; t < 64; t++) {
+            if (t >= 16) {
+                w[t & 15] += VEC_s1(w[(t - 2) & 15]) + w[(t - 7) & 15] +
+                    VEC_s0(w[(t - 15) & 15]);
+            }
+            sha256_vec_t t1 = h + VEC_S1(e) + VEC_CH(e, f, g) + SHA256_K[t] +
+                w[t & 15];
+            sha256_vec_t t2 = VEC_S0(a) + VEC_MAJ(a, b_, c);
+            h = g;
+            g = f;
+            f = e;
+            e = d + t1;
+            d = c;
+            c = b_;
+            b_ = a;
+            a = t1 + t2;
+        }
+
+        s[0] += a;
+        s[1] += b_;
+        s[2] += c;
+        s[3] += d;
+        s[4] += e;
+        s[5] += f;
+        s[6] += g;
+        s[7] += h;
+    }
+
+    memcpy(state, s, sizeof(state));
+    for (unsigned l = 0; l < lanes; l++) {
+        for (int i = 0; i < 8; i++) {
+            ctx[l].state[i] = state[i][l];
+        }
+        ctx[l].count += blocks;
+    }
+}
+
+// One lane at a time with the SHA extensions, each block is still
+// compressed for every lane before moving on to the next
+__attribute__ ((target ("sha,sse4.1,ssse3")))
+static void sha256_lanes_compress_shani(struct sha256_ctx *ctx,
+                                        const uint8_t **data,
+                                        unsigned lanes,
+                                        size_t blocks)
+{
+    const __m128i mask = _mm_set_epi64x(0x0c0d0e0f08090a0bULL,
+                                        0x0405060700010203ULL);
+    __m128i abef[STORJ_SHA256_LANES];
+    __m128i cdgh[STORJ_SHA256_LANES];
+
+    for (unsigned l = 0; l < lanes; l++) {
+        __m128i tmp = _mm_loadu_si128((const __m128i *)&ctx[l].state[0]);
+        __m128i state1 = _mm_loadu_si128((const __m128i *)&ctx[l].state[4]);
+        tmp = _mm_shuffle_epi32(tmp, 0xB1);
+        state1 = _mm_shuffle_epi32(state1, 0x1B);
+        abef[l] = _mm_alignr_epi8(tmp, state1, 8);
+        cdgh[l] = _mm_blend_epi16(state1, tmp, 0xF0);
+    }
+
+    for (size_t b = 0; b < blocks; b++) {
+        for (unsigned l = 0; l < lanes; l++) {
+            __m128i state0 = abef[l];
+            __m128i state1 = cdgh[l];
+            __m128i m[4];
+
+            for (int i = 0; i < 4; i++) {
+                m[i] = _mm_shuffle_epi8(
+                    _mm_loadu_si128((const __m128i *)(data[l] + 16 * i)), mask);
+            }
+            data[l] += SHA256_BLOCK_SIZE;
+
+            for (int i = 0; i < 16; i++) {
+                if (i >= 4) {
+                    __m128i tmp = _mm_sha256msg1_epu32(m[i & 3], m[(i + 1) & 3]);
+                    tmp = _mm_add_epi32(tmp, _mm_alignr_epi8(m[(i + 3) & 3],
+                                                             m[(i + 2) & 3], 4));
+                    m[i & 3] = _mm_sha256msg2_epu32(tmp, m[(i + 3) & 3]);
+                }
+                __m128i msg = _mm_add_epi32(
+                    m[i & 3], _mm_loadu_si128((const __m128i *)&SHA256_K[4 * i]));
+                state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+                msg = _mm_shuffle_epi32(msg, 0x0E);
+                state0 = _mm_sha256rnds2_epu32(state0, state1, msg);
+            }
+
+            abef[l] = _mm_add_epi32(abef[l], state0);
+            cdgh[l] = _mm_add_epi32(cdgh[l], state1);
+        }
+    }
+
+    for (unsigned l = 0; l < lanes; l++) {
+        __m128i tmp = _mm_shuffle_epi32(abef[l], 0x1B);
+        __m128i state1 = _mm_shuffle_epi32(cdgh[l], 0xB1);
+        __m128i state0 = _mm_blend_epi16(tmp, state1, 0xF0);
+        state1 = _mm_alignr_epi8(state1, tmp, 8);
+        _mm_storeu_si128((__m128i *)&ctx[l].state[0], state0);
+        _mm_storeu_si128((__m128i *)&ctx[l].state[4], state1);
+        ctx[l].count += blocks;
+    }
+}
+
+#endif
+
+static sha256_lanes_compress_func sha256_lanes_compress =
+    sha256_lanes_compress_generic;
+static uv_once_t sha256_lanes_once = UV_ONCE_INIT;
+
+static void sha256_lanes_select(void)
+{
+#ifdef STORJ_CRYPTO_X86
+    unsigned int eax = 0, ebx = 0, ecx = 0, edx = 0;
+
+    __builtin_cpu_init();
+
+    if (__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx) &&
+        (ebx & bit_SHA) &&
+        __builtin_cpu_supports("sse4.1") &&
+        __builtin_cpu_supports("ssse3")) {
+        sha256_lanes_compress = sha256_lanes_compress_shani;
+    } else if (__builtin_cpu_supports("avx2")) {
+        sha256_lanes_compress = sha256_lanes_compress_avx2;
+    }
+#endif
+}
+
+void sha256_update_lanes(struct sha256_ctx *ctx, unsigned lanes,
+                         size_t length, const uint8_t *data)
+{
+    const uint8_t *lane_data[STORJ_SHA256_LANES];
+    size_t lane_length[STORJ_SHA256_LANES];
+
+    uv_once(&sha256_lanes_once, sha256_lanes_select);
+
+    while (lanes > STORJ_SHA256_LANES) {
+        sha256_update_lanes(ctx, STORJ_SHA256_LANES, length, data);
+        ctx += STORJ_SHA256_LANES;
+        lanes -= STORJ_SHA256_LANES;
+    }
+
+    // Fill the partial block of each lane so that the rest of the data
+    // starts at a block boundary for every lane
+    size_t blocks = length / SHA256_BLOCK_SIZE;
+    for (unsigned l = 0; l < lanes; l++) {
+        size_t fill = 0;
+        if (ctx[l].index) {
+            fill = SHA256_BLOCK_SIZE - ctx[l].index;
+            if (fill > length) {
+                fill = length;
+            }
+            sha256_update(&ctx[l], fill, data);
+        }
+        lane_data[l] = data + fill;
+        lane_length[l] = length - fill;
+        if (lane_length[l] / SHA256_BLOCK_SIZE < blocks) {
+            blocks = lane_length[l] / SHA256_BLOCK_SIZE;
+        }
+    }
+
+    if (blocks) {
+        sha256_lanes_compress(ctx, lane_data, lanes, blocks);
+    }
+
+    for (unsigned l = 0; l < lanes; l++) {
+        size_t remaining = lane_length[l] - blocks * SHA256_BLOCK_SIZE;
+        if (remaining) {
+            sha256_update(&ctx[l], remaining, lane_data[l]);
+        }
+    }
+}
+
 int ripemd160_of_str(const uint8_t *str, int str_len, uint8_t *digest)
 {
     struct ripemd160_ctx ctx;
@@ -322,6 +837,256 @@ void pbkdf2_hmac_sha512 (
     SHA512_DIGEST_SIZE, iterations, salt_length, salt, length, dst);
 }
 
+// Encrypts the counter blocks of length bytes of data, incrementing the
+// counter once for each block including a final partial block
+typedef void (*aes256_ctr_func)(const struct aes256_ctx *ctx, uint8_t *ctr,
+                                size_t length, uint8_t *dst,
+                                const uint8_t *src);
+
+static void aes256_ctr_generic(const struct aes256_ctx *ctx, uint8_t *ctr,
+                               size_t length, uint8_t *dst,
+                               const uint8_t *src)
+{
+    ctr_crypt((void *)ctx, (nettle_cipher_func *)aes256_encrypt,
+              AES_BLOCK_SIZE, ctr, length, dst, src);
+}
+
+#ifdef STORJ_CRYPTO_X86
+
+#define AES256_ROUNDS 14
+
+static inline uint64_t load_be64(const uint8_t *p)
+{
+    return ((uint64_t)p[0] << 56) | ((uint64_t)p[1] << 48) |
+        ((uint64_t)p[2] << 40) | ((uint64_t)p[3] << 32) |
+        ((uint64_t)p[4] << 24) | ((uint64_t)p[5] << 16) |
+        ((uint64_t)p[6] << 8) | p[7];
+}
+
+static inline void store_be64(uint8_t *p, uint64_t v)
+{
+    for (int i = 7; i >= 0; i--) {
+        p[i] = v & 0xff;
+        v >>= 8;
+    }
+}
+
+// The counter is a big endian 128 bit number, kept as two halves
+#define CTR_NEXT(hi, lo) do { if (++(lo) == 0) { (hi)++; } } while (0)
+
+// The eight blocks of the pipelined kernels are written out so that they
+// stay in registers whatever the optimization level
+#define REPEAT8(X) X(0) X(1) X(2) X(3) X(4) X(5) X(6) X(7)
+
+// Eight blocks at a time so that the latency of each round is hidden,
+// the round keys are read from the nettle context, which keeps them in
+// the byte order used by AES-NI
+__attribute__ ((target ("aes,sse4.1")))
+static void aes256_ctr_aesni(const struct aes256_ctx *ctx, uint8_t *ctr,
+                             size_t length, uint8_t *dst,
+                             const uint8_t *src)
+{
+    __m128i keys[AES256_ROUNDS + 1];
+    for (int r = 0; r <= AES256_ROUNDS; r++) {
+        keys[r] = _mm_loadu_si128((const __m128i *)&ctx->keys[4 * r]);
+    }
+
+    uint64_t hi = load_be64(ctr);
+    uint64_t lo = load_be64(ctr + 8);
+
+#define AESNI_CTR(i) \
+    __m128i b##i = _mm_set_epi64x(__builtin_bswap64(lo), \
+                                  __builtin_bswap64(hi)); \
+    b##i = _mm_xor_si128(b##i, keys[0]); \
+    CTR_NEXT(hi, lo);
+#define AESNI_ENC(i) b##i = _mm_aesenc_si128(b##i, keys[r]);
+#define AESNI_LAST(i) b##i = _mm_aesenclast_si128(b##i, keys[AES256_ROUNDS]);
+#define AESNI_XOR(i) \
+    _mm_storeu_si128((__m128i *)dst + i, \
+                     _mm_xor_si128(b##i, \
+                                   _mm_loadu_si128((const __m128i *)src + i)));
+
+    while (length >= 8 * AES_BLOCK_SIZE) {
+        REPEAT8(AESNI_CTR)
+        for (int r = 1; r < AES256_ROUNDS; r++) {
+            REPEAT8(AESNI_ENC)
+        }
+        REPEAT8(AESNI_LAST)
+        REPEAT8(AESNI_XOR)
+
+        src += 8 * AES_BLOCK_SIZE;
+        dst += 8 * AES_BLOCK_SIZE;
+        length -= 8 * AES_BLOCK_SIZE;
+    }
+
+    // the remaining blocks one at a time
+    while (length > 0) {
+        AESNI_CTR(0)
+        for (int r = 1; r < AES256_ROUNDS; r++) {
+            AESNI_ENC(0)
+        }
+        AESNI_LAST(0)
+
+        if (length >= AES_BLOCK_SIZE) {
+            AESNI_XOR(0)
+            src += AES_BLOCK_SIZE;
+            dst += AES_BLOCK_SIZE;
+            length -= AES_BLOCK_SIZE;
+        } else {
+            uint8_t stream[AES_BLOCK_SIZE];
+            _mm_storeu_si128((__m128i *)stream, b0);
+            for (size_t j = 0; j < length; j++) {
+                dst[j] = src[j] ^ stream[j];
+            }
+            length = 0;
+        }
+    }
+
+#undef AESNI_CTR
+#undef AESNI_ENC
+#undef AESNI_LAST
+#undef AESNI_XOR
+
+    store_be64(ctr, hi);
+    store_be64(ctr + 8, lo);
+}
+
+#ifdef HAVE_VAES
+
+// Sixteen blocks at a time, two in each AVX2 register
+__attribute__ ((target ("vaes,avx2,aes,sse4.1")))
+static void aes256_ctr_vaes(const struct aes256_ctx *ctx, uint8_t *ctr,
+                            size_t length, uint8_t *dst,
+                            const uint8_t *src)
+{
+    __m256i keys[AES256_ROUNDS + 1];
+    for (int r = 0; r <= AES256_ROUNDS; r++) {
+        keys[r] = _mm256_broadcastsi128_si256(
+            _mm_loadu_si128((const __m128i *)&ctx->keys[4 * r]));
+    }
+
+    uint64_t hi = load_be64(ctr);
+    uint64_t lo = load_be64(ctr + 8);
+    uint64_t hi2;
+    uint64_t lo2;
+
+#define VAES_CTR(i) \
+    hi2 = hi; \
+    lo2 = lo; \
+    CTR_NEXT(hi2, lo2); \
+    __m256i b##i = _mm256_set_epi64x(__builtin_bswap64(lo2), \
+                                     __builtin_bswap64(hi2), \
+                                     __builtin_bswap64(lo), \
+                                     __builtin_bswap64(hi)); \
+    b##i = _mm256_xor_si256(b##i, keys[0]); \
+    hi = hi2; \
+    lo = lo2; \
+    CTR_NEXT(hi, lo);
+#define VAES_ENC(i) b##i = _mm256_aesenc_epi128(b##i, keys[r]);
+#define VAES_LAST(i) b##i = _mm256_aesenclast_epi128(b##i, keys[AES256_ROUNDS]);
+#define VAES_XOR(i) \
+    _mm256_storeu_si256((__m256i *)dst + i, \
+                        _mm256_xor_si256(b##i, \
+                            _mm256_loadu_si256((const __m256i *)src + i)));
+
+    while (length >= 16 * AES_BLOCK_SIZE) {
+        REPEAT8(VAES_CTR)
+        for (int r = 1; r < AES256_ROUNDS; r++) {
+            REPEAT8(VAES_ENC)
+        }
+        REPEAT8(VAES_LAST)
+        REPEAT8(VAES_XOR)
+
+        src += 16 * AES_BLOCK_SIZE;
+        dst += 16 * AES_BLOCK_SIZE;
+        length -= 16 * AES_BLOCK_SIZE;
+    }
+
+#undef VAES_CTR
+#undef VAES_ENC
+#undef VAES_LAST
+#undef VAES_XOR
+
+    store_be64(ctr, hi);
+    store_be64(ctr + 8, lo);
+
+    if (length > 0) {
+        aes256_ctr_aesni(ctx, ctr, length, dst, src);
+    }
+}
+
+#endif /* HAVE_VAES */
+
+#endif
+
+static aes256_ctr_func aes256_ctr = aes256_ctr_generic;
+static uv_once_t aes256_ctr_once = UV_ONCE_INIT;
+
+static void aes256_ctr_select(void)
+{
+#ifdef STORJ_CRYPTO_X86
+    aes256_ctr_func selected = NULL;
+
+    __builtin_cpu_init();
+
+    if (__builtin_cpu_supports("aes") && __builtin_cpu_supports("sse4.1")) {
+        selected = aes256_ctr_aesni;
+
+#ifdef HAVE_VAES
+        unsigned int eax = 0, ebx = 0, ecx = 0, edx = 0;
+        if (__builtin_cpu_supports("avx2") &&
+            __get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx) &&
+            (ecx & bit_VAES)) {
+            selected = aes256_ctr_vaes;
+        }
+#endif
+    }
+
+    if (!selected) {
+        return;
+    }
+
+    // The round keys are read from the nettle context, make sure that
+    // they are laid out as expected before using them
+    struct aes256_ctx ctx;
+    uint8_t key[AES256_KEY_SIZE];
+    uint8_t ctr[AES_BLOCK_SIZE];
+    uint8_t expected_ctr[AES_BLOCK_SIZE];
+    uint8_t data[AES_BLOCK_SIZE * 37 + 5];
+    uint8_t expected[sizeof(data)];
+    uint8_t actual[sizeof(data)];
+
+    for (int i = 0; i < sizeof(key); i++) {
+        key[i] = i * 11 + 1;
+    }
+    for (int i = 0; i < sizeof(data); i++) {
+        data[i] = i * 3 + 7;
+    }
+    // near the end of the lower half to check the carry
+    memset(ctr, 0xff, AES_BLOCK_SIZE);
+    ctr[0] = 0x12;
+    ctr[15] = 0xf0;
+    memcpy(expected_ctr, ctr, AES_BLOCK_SIZE);
+
+    aes256_set_encrypt_key(&ctx, key);
+    aes256_ctr_generic(&ctx, expected_ctr, sizeof(data), expected, data);
+    selected(&ctx, ctr, sizeof(data), actual, data);
+
+    if (memcmp(expected, actual, sizeof(data)) == 0 &&
+        memcmp(expected_ctr, ctr, AES_BLOCK_SIZE) == 0) {
+        aes256_ctr = selected;
+    }
+#endif
+}
+
+void aes256_ctr_crypt(const struct aes256_ctx *ctx, uint8_t *ctr,
+                      size_t length, uint8_t *dst, const uint8_t *src)
+{
+    uv_once(&aes256_ctr_once, aes256_ctr_select);
+
+    aes256_ctr(ctx, ctr, length, dst, src);
+}
+
 int increment_ctr_aes_iv(uint8_t *iv, uint64_t bytes_position)
 {
     if (bytes_position % AES_BLOCK_SIZE != 0) {
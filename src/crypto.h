@@ -15,6 +15,7 @@
 #include <nettle/ctr.h>
 #include <nettle/gcm.h>
 #include <nettle/base64.h>
+#include <uv.h>
 
 #include "bip39.h"
 #include "utils.h"
@@ -22,11 +23,54 @@
 #define DETERMINISTIC_KEY_SIZE 64
 #define DETERMINISTIC_KEY_HEX_SIZE 32
 #define BUCKET_NAME_MAGIC "398734aab3c4c30c9f22590e83a95f7e43556a45fc2b3060e0c39fde31f50272"
+#define STORJ_KEY_CACHE_SIZE 16
+#define STORJ_KEY_CACHE_ID_SIZE 64
+#define STORJ_SHA256_LANES 8
 
 static const uint8_t BUCKET_META_MAGIC[32] = {66,150,71,16,50,114,88,160,163,35,154,65,162,213,226,215,70,138,57,61,52,19,210,170,38,164,162,200,86,201,2,81};
 
+/** @brief A bucket key and the key for encrypting names in the bucket
+ */
+typedef struct {
+    char bucket_id[STORJ_KEY_CACHE_ID_SIZE + 1];
+    char bucket_key[DETERMINISTIC_KEY_SIZE + 1];
+    uint8_t name_key[SHA256_DIGEST_SIZE];
+} storj_key_cache_entry_t;
+
+/** @brief Keys derived from the mnemonic of an environment
+ *
+ * The seed of the mnemonic is derived once when first needed, and the most
+ * recently derived bucket keys are kept. The cache is kept in locked memory
+ * and can be used from worker threads.
+ */
+typedef struct storj_key_cache {
+    const char *mnemonic;
+    bool has_seed;
+    char seed[128 + 1];
+    storj_key_cache_entry_t entries[STORJ_KEY_CACHE_SIZE];
+    uint32_t total;
+    uint32_t next;
+    uv_mutex_t lock;
+} storj_key_cache_t;
+
 int sha256_of_str(const uint8_t *str, int str_len, uint8_t *digest);
 
+/**
+ * @brief Add the same data to several sha256 contexts
+ *
+ * The data is read once for all of the contexts, and the blocks of each
+ * context are compressed together, several lanes at once with AVX2 or
+ * with the SHA extensions when the CPU supports them. The contexts may
+ * have different amounts of data already added.
+ *
+ * @param[in] ctx The sha256 contexts
+ * @param[in] lanes The number of contexts
+ * @param[in] length The length of the data
+ * @param[in] data The data to add to every context
+ */
+void sha256_update_lanes(struct sha256_ctx *ctx, unsigned lanes,
+                         size_t length, const uint8_t *data);
+
 int sha512_of_str(const uint8_t *str, int str_len, uint8_t *digest);
 
 int ripemd160_of_str(const uint8_t *str, int str_len, uint8_t *digest);
@@ -122,6 +166,99 @@ int encrypt_file_name(const char *mnemonic,
                       const char *file_name,
                       char **encrypted_name);
 
+/**
+ * @brief Create a cache of keys derived from a mnemonic
+ *
+ * @param[in] mnemonic Character array of the mnemonic, must outlive the cache
+ * @return A pointer to the cache or NULL on error
+ */
+storj_key_cache_t *key_cache_new(const char *mnemonic);
+
+/**
+ * @brief Zero out and free a key cache
+ *
+ * @param[in] cache The key cache
+ */
+void key_cache_destroy(storj_key_cache_t *cache);
+
+/**
+ * @brief Get the keys of a bucket, deriving them if not cached
+ *
+ * @param[in] cache The key cache
+ * @param[in] bucket_id Character array of bucket id
+ * @param[out] bucket_key 65 byte character array for the bucket's key
+ * @param[out] name_key 32 byte array for the key of names in the bucket
+ * @return A non-zero error value on failure and 0 on success.
+ */
+int key_cache_get(storj_key_cache_t *cache, const char *bucket_id,
+                  char *bucket_key, uint8_t *name_key);
+
+/**
+ * @brief Generate a file's key using a key cache
+ *
+ * @param[in] cache The key cache
+ * @param[in] bucket_id Character array of bucket id
+ * @param[in] index Character array of index
+ * @param[out] file_key 64 byte character array that is the file's key
+ * @return A non-zero error value on failure and 0 on success.
+ */
+int generate_file_key_cached(storj_key_cache_t *cache,
+                             const char *bucket_id,
+                             const char *index,
+                             char **file_key);
+
+/**
+ * @brief Decrypt a bucket name using a key cache
+ *
+ * @param[in] cache The key cache
+ * @param[in] encrypted_name Character array of the encrypted name
+ * @param[out] decrypted_name Character array of the decrypted name
+ * @return A non-zero error value on failure and 0 on success.
+ */
+int decrypt_bucket_name_cached(storj_key_cache_t *cache,
+                               const char *encrypted_name,
+                               char **decrypted_name);
+
+/**
+ * @brief Decrypt a file name using a key cache
+ *
+ * @param[in] cache The key cache
+ * @param[in] bucket_id Character array of bucket id
+ * @param[in] encrypted_name Character array of the encrypted name
+ * @param[out] decrypted_name Character array of the decrypted name
+ * @return A non-zero error value on failure and 0 on success.
+ */
+int decrypt_file_name_cached(storj_key_cache_t *cache,
+                             const char *bucket_id,
+                             const char *encrypted_name,
+                             char **decrypted_name);
+
+/**
+ * @brief Encrypt a bucket name using a key cache
+ *
+ * @param[in] cache The key cache
+ * @param[in] bucket_name Character array of the bucket name
+ * @param[out] encrypted_name Character array of the encrypted name
+ * @return A non-zero error value on failure and 0 on success.
+ */
+int encrypt_bucket_name_cached(storj_key_cache_t *cache,
+                               const char *bucket_name,
+                               char **encrypted_name);
+
+/**
+ * @brief Encrypt a file name using a key cache
+ *
+ * @param[in] cache The key cache
+ * @param[in] bucket_id Character array of bucket id
+ * @param[in] file_name Character array of the file name
+ * @param[out] encrypted_name Character array of the encrypted name
+ * @return A non-zero error value on failure and 0 on success.
+ */
+int encrypt_file_name_cached(storj_key_cache_t *cache,
+                             const char *bucket_id,
+                             const char *file_name,
+                             char **encrypted_name);
+
 /**
  * @brief Calculate deterministic key by getting sha512 of key + id
  *
@@ -134,6 +271,22 @@ int encrypt_file_name(const char *mnemonic,
 int get_deterministic_key(const char *key, int key_len,
                           const char *id, char **buffer);
 
+/**
+ * @brief Encrypt or decrypt data with AES-256 in CTR mode
+ *
+ * A replacement for nettle's ctr_crypt with aes256_encrypt, the counter is
+ * incremented in the same way. Several blocks are encrypted at once with
+ * AES-NI or VAES when the CPU supports them, otherwise nettle is used.
+ *
+ * @param[in] ctx The AES-256 context with the encryption key
+ * @param[in/out] ctr The 16 byte counter, incremented for each block
+ * @param[in] length The length of the data
+ * @param[out] dst The output, may be the same as src
+ * @param[in] src The input
+ */
+void aes256_ctr_crypt(const struct aes256_ctx *ctx, uint8_t *ctr,
+                      size_t length, uint8_t *dst, const uint8_t *src);
+
 /**
  * @brief Increment the iv for ctr decryption/encryption
  *
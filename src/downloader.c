@@ -18,13 +18,17 @@ static void free_download_state(storj_download_state_t *state)
         free(pointer->shard_hash);
         free(pointer->farmer_id);
         free(pointer->farmer_address);
+        free(pointer->shard_data);
+        free(pointer->hedge_data);
+        free(pointer->hedge_farmer_id);
 
-        free_exchange_report(pointer->report);
+        // pointers skipped before a range do not have a report
+        if (pointer->report) {
+            free_exchange_report(pointer->report);
+        }
     }
 
-    if (state->excluded_farmer_ids) {
-        free(state->excluded_farmer_ids);
-    }
+    free(state->shard_rates);
 
     if (state->decrypt_key) {
         memset_zero(state->decrypt_key, SHA256_DIGEST_SIZE);
@@ -48,6 +52,25 @@ static void free_download_state(storj_download_state_t *state)
         free((char *)state->hmac);
     }
 
+    if (state->pointer_pages) {
+        uint32_t page_requests = state->env->bridge_options->pointer_page_requests;
+        for (int i = 0; i < page_requests; i++) {
+            if (state->pointer_pages[i].response) {
+                json_object_put(state->pointer_pages[i].response);
+            }
+        }
+        free(state->pointer_pages);
+    }
+
+    // the journal is kept to continue a download that didn't complete
+    journal_close(state->journal, state->error_status == STORJ_TRANSFER_OK);
+
+    index_queue_free(&state->created_pointers);
+    index_queue_free(&state->reported_pointers);
+
+    // the reports of the shards are sent without waiting for a full batch
+    report_queue_flush(state->env->reports);
+
     free(state->pointers);
     free(state);
 }
@@ -83,13 +106,12 @@ static void request_replace_pointer(uv_work_t *work)
 
     int status_code = 0;
 
-    int excluded_farmer_ids_len = (req->excluded_farmer_ids) ? strlen(req->excluded_farmer_ids) : 0;
     char query_args[BUFSIZ];
     memset(query_args, '\0', BUFSIZ);
     snprintf(query_args, BUFSIZ,
              "?limit=1&skip=%i&exclude=%s",
              req->pointer_index,
-             req->excluded_farmer_ids);
+             req->excluded_farmer_ids ? req->excluded_farmer_ids : "");
 
     int path_len = 9 + strlen(req->bucket_id) + 7 +
         strlen(req->file_id) + strlen(query_args);
@@ -124,6 +146,68 @@ static void request_replace_pointer(uv_work_t *work)
 
 }
 
+// Parity shards are only downloaded once they could be needed to recover a
+// data shard, a stream recovers from all of the shards once a data shard
+// is missing
+static bool is_parity_deferred(storj_download_state_t *state)
+{
+    if (state->stream) {
+        return !state->stream_recovering;
+    }
+
+    return !state->fetching_parity;
+}
+
+// Pointers that are ready for work are added to a queue by their position,
+// and the counts of missing and downloaded pointers are kept so that the
+// state doesn't need to be scanned on each pass.
+static void set_pointer_status(storj_download_state_t *state,
+                               storj_pointer_t *pointer,
+                               int status)
+{
+    if (pointer->status == POINTER_MISSING) {
+        state->missing_pointers -= 1;
+        if (!pointer->parity) {
+            state->missing_data_pointers -= 1;
+        }
+    } else if (pointer->status == POINTER_DOWNLOADED) {
+        state->downloaded_pointers -= 1;
+    }
+
+    pointer->status = status;
+
+    int error = 0;
+    uint32_t position = pointer - state->pointers;
+
+    switch (status) {
+        case POINTER_MISSING:
+            state->missing_pointers += 1;
+            if (!pointer->parity) {
+                state->missing_data_pointers += 1;
+            }
+            break;
+        case POINTER_DOWNLOADED:
+            state->downloaded_pointers += 1;
+            break;
+        case POINTER_CREATED:
+            error = index_queue_push(&state->created_pointers, position);
+            break;
+        case POINTER_ERROR_REPORTED:
+            error = index_queue_push(&state->reported_pointers, position);
+            break;
+    }
+
+    if (error) {
+        state->error_status = STORJ_MEMORY_ERROR;
+    }
+
+    // the parity shards are needed once a data shard has failed
+    if (!pointer->parity && !state->fetching_parity &&
+        (status == POINTER_ERROR || status == POINTER_MISSING)) {
+        state->fetching_parity = true;
+    }
+}
+
 static void set_pointer_from_json(storj_download_state_t *state,
                                   storj_pointer_t *p,
                                   struct json_object *json,
@@ -204,32 +288,33 @@ static void set_pointer_from_json(storj_download_state_t *state,
         p->replace_count = 0;
     }
 
+    p->size = size;
+    p->parity = parity;
+    p->downloaded_size = 0;
+    p->index = index;
+    p->farmer_port = port;
+
     // Check to see if we have a token for this shard, otherwise
     // we will immediatly move this shard to POINTER_MISSING
     // so that it can be retried and possibly recovered.
     if (address && token) {
         // reset the status
-        p->status = POINTER_CREATED;
+        set_pointer_status(state, p, POINTER_CREATED);
     } else {
         state->log->warn(state->env->log_options,
                          state->handle,
                          "Missing shard %s at index %i",
                          hash,
                          index);
-        p->status = POINTER_MISSING;
+        set_pointer_status(state, p, POINTER_MISSING);
     }
 
-    p->size = size;
-    p->parity = parity;
-    p->downloaded_size = 0;
-    p->index = index;
-    p->farmer_port = port;
-
     if (is_replaced) {
         free(p->token);
         free(p->shard_hash);
         free(p->farmer_address);
         free(p->farmer_id);
+        free(p->shard_data);
     }
     if (token) {
         p->token = strdup(token);
@@ -279,6 +364,9 @@ static void set_pointer_from_json(storj_download_state_t *state,
     p->report->message = STORJ_REPORT_DOWNLOAD_ERROR;
 
     p->work = NULL;
+    p->shard_data = NULL;
+    p->hedged = false;
+    p->slow = false;
 
     if (!state->shard_size) {
         // TODO make sure all except last shard is the same size
@@ -290,11 +378,131 @@ static void set_pointer_from_json(storj_download_state_t *state,
     };
 }
 
+static bool is_in_range(storj_download_state_t *state, uint32_t index)
+{
+    if (!state->range_length || !state->shard_size) {
+        return true;
+    }
+
+    uint64_t first = state->range_offset / state->shard_size;
+    uint64_t last = (state->range_offset + state->range_length - 1) /
+        state->shard_size;
+
+    return index >= first && index <= last;
+}
+
+static void append_range_pointers(storj_download_state_t *state,
+                                  int prev_total_pointers)
+{
+    uint64_t first = state->range_offset / state->shard_size;
+    uint64_t last = (state->range_offset + state->range_length - 1) /
+        state->shard_size;
+
+    // Shards outside of the range are not downloaded
+    for (int i = prev_total_pointers; i < state->total_pointers; i++) {
+        if (!is_in_range(state, i)) {
+            set_pointer_status(state, &state->pointers[i], POINTER_FINISHED);
+            state->completed_shards += 1;
+        }
+    }
+
+    if (state->total_pointers > last) {
+        state->log->debug(state->env->log_options,
+                          state->handle,
+                          "Finished requesting pointers of range");
+        state->pointers_completed = true;
+        return;
+    }
+
+    // Skip ahead to the first pointer of the range, pointers before it are
+    // only kept so that the position in the array matches the index
+    if (state->total_pointers < first) {
+        state->pointers = realloc(state->pointers,
+                                  first * sizeof(storj_pointer_t));
+        if (!state->pointers) {
+            state->error_status = STORJ_MEMORY_ERROR;
+            return;
+        }
+
+        for (int i = state->total_pointers; i < first; i++) {
+            storj_pointer_t *pointer = &state->pointers[i];
+            memset(pointer, 0, sizeof(storj_pointer_t));
+            pointer->index = i;
+            set_pointer_status(state, pointer, POINTER_FINISHED);
+            state->completed_shards += 1;
+        }
+
+        state->total_pointers = first;
+        state->total_shards = first;
+    }
+
+    if (state->stream_position < first) {
+        state->stream_position = first;
+    }
+}
+
+// The journal of a download is only continued by a download of the same
+// file, and the shards are only used if the hash of the pointer is the same.
+// A journal of a download that stopped while the shards were being
+// recovered is started again, as the file has been changed in place.
+static int open_download_journal(storj_download_state_t *state)
+{
+    const char *format = "download %s %s %d";
+
+    int length = snprintf(NULL, 0, format, state->bucket_id, state->file_id,
+                          state->decrypt_on_receive);
+
+    char *identity = calloc(length + 1, sizeof(char));
+    if (!identity) {
+        return STORJ_MEMORY_ERROR;
+    }
+
+    snprintf(identity, length + 1, format, state->bucket_id, state->file_id,
+             state->decrypt_on_receive);
+
+    int status = journal_open(state->journal_path, identity, &state->journal);
+
+    if (!status && journal_find(state->journal, "recover", 0)) {
+        status = journal_reset(state->journal, identity);
+    }
+
+    free(identity);
+
+    return status;
+}
+
+static void restore_pointer_journal(storj_download_state_t *state,
+                                    storj_pointer_t *pointer)
+{
+    const char *hash = journal_find(state->journal, "pointer",
+                                    pointer->index);
+
+    if (!hash || !pointer->shard_hash || 0 != strcmp(hash, pointer->shard_hash)) {
+        return;
+    }
+
+    set_pointer_status(state, pointer, POINTER_DOWNLOADED);
+    pointer->downloaded_size = pointer->size;
+
+    // the earlier download needed the parity shards
+    if (pointer->parity) {
+        state->fetching_parity = true;
+    }
+}
+
 static void append_pointers_to_state(storj_download_state_t *state,
                                      struct json_object *res)
 {
     int length = json_object_array_length(res);
 
+    if (state->journal_path && state->destination && !state->journal) {
+        int status = open_download_journal(state);
+        if (status) {
+            state->error_status = status;
+            return;
+        }
+    }
+
     if (length == 0) {
         state->log->debug(state->env->log_options,
                           state->handle,
@@ -326,6 +534,7 @@ static void append_pointers_to_state(storj_download_state_t *state,
 
             struct json_object *json = json_object_array_get_idx(res, i);
 
+            memset(&state->pointers[j], 0, sizeof(storj_pointer_t));
             set_pointer_from_json(state, &state->pointers[j], json, false);
 
             // Keep track of the number of data and parity pointers
@@ -333,9 +542,113 @@ static void append_pointers_to_state(storj_download_state_t *state,
             if (pointer->parity) {
                 state->total_parity_pointers += 1;
             }
+
+            // Shards downloaded before the download was continued
+            if (state->journal) {
+                restore_pointer_journal(state, pointer);
+            }
+        }
+
+        if (state->range_length && state->shard_size) {
+            append_range_pointers(state, prev_total_pointers);
+        }
+    }
+
+}
+
+static storj_pointer_page_t *find_pointer_page(storj_download_state_t *state,
+                                               uint32_t skip)
+{
+    uint32_t page_requests = state->env->bridge_options->pointer_page_requests;
+
+    for (int i = 0; i < page_requests; i++) {
+        storj_pointer_page_t *page = &state->pointer_pages[i];
+        if ((page->pending || page->response) && page->skip == skip) {
+            return page;
+        }
+    }
+
+    return NULL;
+}
+
+static storj_pointer_page_t *find_free_pointer_page(storj_download_state_t *state)
+{
+    uint32_t page_requests = state->env->bridge_options->pointer_page_requests;
+
+    for (int i = 0; i < page_requests; i++) {
+        storj_pointer_page_t *page = &state->pointer_pages[i];
+        if (!page->pending && !page->response) {
+            return page;
+        }
+    }
+
+    return NULL;
+}
+
+static void append_pointer_pages(storj_download_state_t *state)
+{
+    uint32_t page_requests = state->env->bridge_options->pointer_page_requests;
+
+    // pages are appended in order, a page that arrives early waits
+    // for the pages before it
+    storj_pointer_page_t *page = find_pointer_page(state, state->total_pointers);
+    while (page && page->response && !state->pointers_completed &&
+           !state->error_status) {
+
+        struct json_object *response = page->response;
+        page->response = NULL;
+
+        append_pointers_to_state(state, response);
+        json_object_put(response);
+
+        if (!state->pointers_completed &&
+            state->total_pointers >= state->pointers_end) {
+            state->log->debug(state->env->log_options,
+                              state->handle,
+                              "Finished requesting pointers");
+            state->pointers_completed = true;
+        }
+
+        page = find_pointer_page(state, state->total_pointers);
+    }
+
+    // drop pages that are no longer needed, such as those skipped over
+    // before the start of a range
+    for (int i = 0; i < page_requests; i++) {
+        page = &state->pointer_pages[i];
+        if (!page->response) {
+            continue;
         }
+        if (state->pointers_completed ||
+            page->skip < state->total_pointers ||
+            (state->pointer_page_size &&
+             (page->skip - state->total_pointers) % state->pointer_page_size)) {
+            json_object_put(page->response);
+            page->response = NULL;
+        }
+    }
+}
+
+static void receive_pointer_page(storj_download_state_t *state,
+                                 storj_pointer_page_t *page,
+                                 struct json_object *response)
+{
+    uint32_t length = json_object_array_length(response);
+
+    if (!state->pointer_page_size) {
+        // the bridge may return fewer pointers than the limit, the
+        // first page has the number of pointers in each of the pages
+        if (length > 0) {
+            state->pointer_page_size = length;
+        }
+    } else if (length < page->limit &&
+               page->skip + length < state->pointers_end) {
+        state->pointers_end = page->skip + length;
     }
 
+    page->response = response;
+
+    append_pointer_pages(state);
 }
 
 static void after_request_pointers(uv_work_t *work, int status)
@@ -344,7 +657,7 @@ static void after_request_pointers(uv_work_t *work, int status)
     storj_download_state_t *state = req->state;
 
     state->pending_work_count--;
-    state->requesting_pointers = false;
+    req->page->pending = false;
 
     if (req->response) {
         state->log->debug(state->env->log_options, state->handle,
@@ -379,7 +692,8 @@ static void after_request_pointers(uv_work_t *work, int status)
     } else if (!json_object_is_type(req->response, json_type_array)) {
         state->error_status = STORJ_BRIDGE_JSON_ERROR;
     } else {
-        append_pointers_to_state(state, req->response);
+        receive_pointer_page(state, req->page, req->response);
+        req->response = NULL;
     }
 
     queue_next_work(state);
@@ -420,10 +734,12 @@ static void after_request_replace_pointer(uv_work_t *work, int status)
     } else if (req->status_code != 200) {
 
         if (req->status_code > 0 && req->status_code < 500) {
-            state->pointers[req->pointer_index].status = POINTER_MISSING;
+            set_pointer_status(state, &state->pointers[req->pointer_index],
+                               POINTER_MISSING);
         } else {
             // Update status so that it will be retried
-            state->pointers[req->pointer_index].status = POINTER_ERROR_REPORTED;
+            set_pointer_status(state, &state->pointers[req->pointer_index],
+                               POINTER_ERROR_REPORTED);
             state->pointer_fail_count += 1;
         }
 
@@ -434,18 +750,27 @@ static void after_request_replace_pointer(uv_work_t *work, int status)
         if (state->pointer_fail_count >= STORJ_MAX_POINTER_TRIES) {
             // Skip retrying mark as missing
             state->pointer_fail_count = 0;
-            state->pointers[req->pointer_index].status = POINTER_MISSING;
+            set_pointer_status(state, &state->pointers[req->pointer_index],
+                               POINTER_MISSING);
         }
 
     } else if (!json_object_is_type(req->response, json_type_array)) {
         state->error_status = STORJ_BRIDGE_JSON_ERROR;
     } else {
         struct json_object *json = json_object_array_get_idx(req->response, 0);
+        storj_pointer_t *pointer = &state->pointers[req->pointer_index];
+
+        set_pointer_from_json(state, pointer, json, true);
 
-        set_pointer_from_json(state,
-                              &state->pointers[req->pointer_index],
-                              json,
-                              true);
+        if (pointer->replace_count >= STORJ_DEFAULT_MIRRORS) {
+            state->log->warn(state->env->log_options,
+                             state->handle,
+                             "Unable to download shard %s at index %i",
+                             pointer->shard_hash,
+                             pointer->index);
+            pointer->replace_count = 0;
+            set_pointer_status(state, pointer, POINTER_MISSING);
+        }
 
         if (state->pointers[req->pointer_index].index != req->pointer_index) {
 
@@ -462,62 +787,47 @@ static void after_request_replace_pointer(uv_work_t *work, int status)
     queue_next_work(state);
 
     json_object_put(req->response);
+    free(req->excluded_farmer_ids);
     free(work->data);
     free(work);
 }
 
-static void queue_request_pointers(storj_download_state_t *state)
+static void queue_replace_pointers(storj_download_state_t *state)
 {
-    if (state->requesting_pointers || state->canceled) {
+    if (state->requesting_pointers) {
         return;
     }
 
     // queue request to replace pointer if any pointers have failure
-    for (int i = 0; i < state->total_pointers; i++) {
+    uint32_t i;
+    while (index_queue_pop(&state->reported_pointers, &i)) {
 
         storj_pointer_t *pointer = &state->pointers[i];
 
-        if (pointer->replace_count >= STORJ_DEFAULT_MIRRORS) {
-            state->log->warn(state->env->log_options,
-                             state->handle,
-                             "Unable to download shard %s at index %i",
-                             pointer->shard_hash,
-                             pointer->index);
-            pointer->replace_count = 0;
-            pointer->status = POINTER_MISSING;
-            return;
-        }
-
         if (pointer->status == POINTER_ERROR_REPORTED) {
 
-            // exclude this farmer id from future requests
+            // exclude the farmers that have recently failed, including
+            // the farmer of this pointer
+            char *excluded_farmer_ids = NULL;
+            int exclude_status =
+                farmer_table_exclude_list(state->env->farmers,
+                                          pointer->report->farmer_id,
+                                          get_time_milliseconds(),
+                                          &excluded_farmer_ids);
+            if (exclude_status) {
+                state->error_status = exclude_status;
+                return;
+            }
+
             state->log->debug(state->env->log_options,
                               state->handle,
-                              "Adding farmer_id %s to excluded list",
-                              pointer->report->farmer_id);
-
-            if (!state->excluded_farmer_ids) {
-                state->excluded_farmer_ids = calloc(42, sizeof(char));
-                if (!state->excluded_farmer_ids) {
-                    state->error_status = STORJ_MEMORY_ERROR;
-                    return;
-                }
-                strcat(state->excluded_farmer_ids, pointer->report->farmer_id);
-            } else {
-                state->excluded_farmer_ids =
-                    realloc(state->excluded_farmer_ids,
-                            strlen(state->excluded_farmer_ids) + 42);
-                if (!state->excluded_farmer_ids) {
-                    state->error_status = STORJ_MEMORY_ERROR;
-                    return;
-                }
-                strcat(state->excluded_farmer_ids, ",");
-                strcat(state->excluded_farmer_ids, pointer->report->farmer_id);
-            }
+                              "Excluded farmers: %s",
+                              excluded_farmer_ids ? excluded_farmer_ids : "");
 
             json_request_replace_pointer_t *req =
                 malloc(sizeof(json_request_replace_pointer_t));
             if (!req) {
+                free(excluded_farmer_ids);
                 state->error_status = STORJ_MEMORY_ERROR;
                 return;
             }
@@ -529,7 +839,7 @@ static void queue_request_pointers(storj_download_state_t *state)
             req->bucket_id = state->bucket_id;
             req->file_id = state->file_id;
             req->state = state;
-            req->excluded_farmer_ids = state->excluded_farmer_ids;
+            req->excluded_farmer_ids = excluded_farmer_ids;
             req->error_status = 0;
             req->response = NULL;
             req->status_code = 0;
@@ -557,7 +867,7 @@ static void queue_request_pointers(storj_download_state_t *state)
                 return;
             }
 
-            pointer->status = POINTER_BEING_REPLACED;
+            set_pointer_status(state, pointer, POINTER_BEING_REPLACED);
 
             // we're done until the next pass
             state->requesting_pointers = true;
@@ -565,12 +875,13 @@ static void queue_request_pointers(storj_download_state_t *state)
         }
 
     }
+}
 
-    // only request the next set of pointers if we're not finished
-    if (state->pointers_completed) {
-        return;
-    }
-
+static void queue_request_pointer_page(storj_download_state_t *state,
+                                       storj_pointer_page_t *page,
+                                       uint32_t skip,
+                                       uint32_t limit)
+{
     json_request_download_t *req = malloc(sizeof(json_request_download_t));
     if (!req) {
         state->error_status = STORJ_MEMORY_ERROR;
@@ -579,7 +890,7 @@ static void queue_request_pointers(storj_download_state_t *state)
 
     char query_args[BUFSIZ];
     memset(query_args, '\0', BUFSIZ);
-    snprintf(query_args, BUFSIZ, "?limit=3&skip=%d", state->total_pointers);
+    snprintf(query_args, BUFSIZ, "?limit=%u&skip=%u", limit, skip);
 
     int path_len = 9 + strlen(state->bucket_id) + 7 +
         strlen(state->file_id) + strlen(query_args);
@@ -601,6 +912,7 @@ static void queue_request_pointers(storj_download_state_t *state)
     req->path = path;
     req->body = NULL;
     req->auth = true;
+    req->page = page;
 
     req->state = state;
 
@@ -613,8 +925,8 @@ static void queue_request_pointers(storj_download_state_t *state)
 
     state->log->info(state->env->log_options,
                      state->handle,
-                     "Requesting next set of pointers, total pointers: %i",
-                     state->total_pointers);
+                     "Requesting next set of pointers, skip: %u, limit: %u",
+                     skip, limit);
 
     state->pending_work_count++;
     int status = uv_queue_work(state->env->loop, (uv_work_t*) work,
@@ -625,34 +937,64 @@ static void queue_request_pointers(storj_download_state_t *state)
         return;
     }
 
-    state->requesting_pointers = true;
+    page->skip = skip;
+    page->limit = limit;
+    page->pending = true;
 }
 
-static void request_shard(uv_work_t *work)
+static void queue_request_pointers(storj_download_state_t *state)
 {
-    shard_request_download_t *req = work->data;
+    if (state->canceled) {
+        return;
+    }
 
-    int status_code;
-    int write_code = 0;
+    queue_replace_pointers(state);
 
-    req->start = get_time_milliseconds();
+    // only request the next set of pointers if we're not finished
+    if (state->pointers_completed || state->error_status) {
+        return;
+    }
+
+    // the first page is requested alone, once the number of pointers in
+    // a page is known the following pages are requested in parallel
+    uint32_t limit = state->env->bridge_options->pointer_page_size;
+    uint32_t end = state->total_pointers + 1;
+    if (state->pointer_page_size) {
+        limit = state->pointer_page_size;
+        end = state->pointers_end;
+    }
+
+    // there is no need for the pointers after a range
+    if (state->range_length && state->shard_size) {
+        uint64_t last = (state->range_offset + state->range_length - 1) /
+            state->shard_size;
+        if (last < end) {
+            end = last + 1;
+        }
+    }
+
+    for (uint32_t skip = state->total_pointers; skip < end; skip += limit) {
+        if (find_pointer_page(state, skip)) {
+            continue;
+        }
+
+        storj_pointer_page_t *page = find_free_pointer_page(state);
+        if (!page) {
+            break;
+        }
+
+        queue_request_pointer_page(state, page, skip, limit);
+        if (state->error_status) {
+            return;
+        }
+    }
+}
 
-    uint64_t file_position = req->pointer_index * req->state->shard_size;
-
-    int error_status = fetch_shard(req->http_options,
-                                   req->farmer_id,
-                                   req->farmer_proto,
-                                   req->farmer_host,
-                                   req->farmer_port,
-                                   req->shard_hash,
-                                   req->shard_total_bytes,
-                                   req->token,
-                                   req->state->destination,
-                                   file_position,
-                                   &status_code,
-                                   &write_code,
-                                   &req->progress_handle,
-                                   req->canceled);
+static void after_fetch_shard(int error_status, int status_code,
+                              int write_code, void *handle)
+{
+    uv_work_t *work = handle;
+    shard_request_download_t *req = work->data;
 
     req->end = get_time_milliseconds();
 
@@ -678,6 +1020,55 @@ static void request_shard(uv_work_t *work)
     } else {
         req->error_status = 0;
     }
+
+    if (req->hedge) {
+        after_hedge_shard(work);
+        return;
+    }
+
+    after_request_shard(work, 0);
+}
+
+static int request_shard(uv_work_t *work)
+{
+    shard_request_download_t *req = work->data;
+
+    req->start = get_time_milliseconds();
+
+    storj_download_state_t *state = req->state;
+    uint64_t file_position = req->pointer_index * state->shard_size;
+
+    uint8_t *decrypt_key = NULL;
+    uint8_t *decrypt_ctr = NULL;
+    uint8_t ctr[AES_BLOCK_SIZE];
+
+    if (req->decrypt_on_receive) {
+        decrypt_key = state->decrypt_key;
+        memcpy(ctr, state->decrypt_ctr, AES_BLOCK_SIZE);
+        increment_ctr_aes_iv(ctr, file_position);
+        decrypt_ctr = ctr;
+    }
+
+    // The shard is received on the event loop and after_fetch_shard is
+    // called once the transfer has finished
+    return fetch_shard(req->state->env->http_multi,
+                       req->farmer_id,
+                       req->farmer_proto,
+                       req->farmer_host,
+                       req->farmer_port,
+                       req->shard_hash,
+                       req->shard_total_bytes,
+                       req->token,
+                       req->state->destination,
+                       file_position,
+                       req->shard_data,
+                       decrypt_key,
+                       decrypt_ctr,
+                       req->hedge ? NULL : &req->progress_handle,
+                       &req->canceled,
+                       req->state->bandwidth_weight,
+                       after_fetch_shard,
+                       work);
 }
 
 static void free_request_shard_work(uv_handle_t *progress_handle)
@@ -713,6 +1104,15 @@ static void report_progress(storj_download_state_t *state)
 
         storj_pointer_t *pointer = &state->pointers[i];
 
+        // parity shards are only downloaded for recovery
+        if (pointer->parity && is_parity_deferred(state)) {
+            continue;
+        }
+
+        if (!is_in_range(state, i)) {
+            continue;
+        }
+
         downloaded_bytes += pointer->downloaded_size;
         total_bytes += pointer->size;
     }
@@ -725,334 +1125,873 @@ static void report_progress(storj_download_state_t *state)
                        state->handle);
 }
 
-static void after_request_shard(uv_work_t *work, int status)
+static void cancel_shard_request(uv_work_t *work)
 {
-    shard_request_download_t *req = work->data;
+    if (!work) {
+        return;
+    }
 
-    req->state->pending_work_count--;
-    req->state->resolving_shards -= 1;
+    shard_request_download_t *req = work->data;
+    req->canceled = true;
 
-    uv_handle_t *progress_handle = (uv_handle_t *) &req->progress_handle;
+    // a transfer that is waiting on a stalled farmer is stopped as well
+    http_multi_cancel_transfers(req->state->env->http_multi);
+}
 
-    // free the download progress
-    free(progress_handle->data);
+// The rates of recently finished shards in bytes per second, for finding
+// shards that are downloading much slower than the others
+static void add_shard_rate(storj_download_state_t *state, uint64_t bytes,
+                           uint64_t start, uint64_t end)
+{
+    if (!state->shard_rates) {
+        state->shard_rates = calloc(STORJ_HEDGE_RATE_SAMPLES,
+                                    sizeof(uint64_t));
+        if (!state->shard_rates) {
+            return;
+        }
+    }
 
-    // assign work so that we can free after progress_handle is closed
-    progress_handle->data = work;
+    uint64_t time = (end > start) ? end - start : 1;
+    uint32_t i = state->total_shard_rates % STORJ_HEDGE_RATE_SAMPLES;
 
-    // update the pointer status
-    storj_pointer_t *pointer = &req->state->pointers[req->pointer_index];
+    state->shard_rates[i] = bytes * 1000 / time;
+    state->total_shard_rates += 1;
+}
 
-    pointer->report->start = req->start;
-    pointer->report->end = req->end;
+static void log_download_concurrency(storj_download_state_t *state)
+{
+    state->log->info(state->env->log_options, state->handle,
+                     "Downloading up to %" PRIu32 " shards at once",
+                     state->download_concurrency.limit);
+}
 
-    if (req->error_status) {
+static void finish_shard_download(storj_download_state_t *state,
+                                  storj_pointer_t *pointer)
+{
+    pointer->report->code = STORJ_REPORT_SUCCESS;
+    pointer->report->message = STORJ_REPORT_SHARD_DOWNLOADED;
+    set_pointer_status(state, pointer, POINTER_DOWNLOADED);
 
-        req->state->log->warn(req->state->env->log_options,
-                              req->state->handle,
-                              "Error downloading shard: %s, reason: %s",
-                              req->shard_hash,
-                              storj_strerror(req->error_status));
+    // Make sure the downloaded size is updated
+    pointer->downloaded_size = pointer->size;
 
-        pointer->status = POINTER_ERROR;
+    if (farmer_table_add_report(state->env->farmers, pointer->report) ||
+        report_queue_add(state->env->reports, pointer->report)) {
+        state->error_status = STORJ_MEMORY_ERROR;
+    }
 
-        switch(req->error_status) {
-            case STORJ_FARMER_INTEGRITY_ERROR:
-                pointer->report->code = STORJ_REPORT_FAILURE;
-                pointer->report->message = STORJ_REPORT_FAILED_INTEGRITY;
-            default:
-                pointer->report->code = STORJ_REPORT_FAILURE;
-                pointer->report->message = STORJ_REPORT_DOWNLOAD_ERROR;
+    if (state->journal) {
+        int journal_status = journal_append(state->journal,
+                                            "pointer",
+                                            pointer->index,
+                                            pointer->shard_hash);
+        if (journal_status) {
+            state->error_status = journal_status;
         }
+    }
 
-    } else {
-
-        req->state->log->info(req->state->env->log_options,
-                              req->state->handle,
-                              "Finished downloading shard: %s",
-                              req->shard_hash);
-
-        pointer->report->code = STORJ_REPORT_SUCCESS;
-        pointer->report->message = STORJ_REPORT_SHARD_DOWNLOADED;
-        pointer->status = POINTER_DOWNLOADED;
+    report_progress(state);
+}
 
-        // Make sure the downloaded size is updated
-        pointer->downloaded_size = pointer->size;
+static void after_write_hedged_shard(uv_fs_t *fs_req);
 
-        report_progress(req->state);
+static int write_hedged_shard(shard_write_hedge_t *req)
+{
+    storj_download_state_t *state = req->state;
 
+    uint64_t len = req->length - req->written;
+    if (len > STORJ_DECRYPT_PROGRESS_SIZE) {
+        len = STORJ_DECRYPT_PROGRESS_SIZE;
     }
 
-    queue_next_work(req->state);
+    uv_buf_t buf = uv_buf_init((char *)req->shard_data + req->written, len);
 
-    // close the async progress handle
-    uv_close(progress_handle, free_request_shard_work);
+    req->req.data = req;
+
+    return uv_fs_write(state->env->loop, &req->req,
+                       fileno(state->destination), &buf, 1,
+                       req->file_position + req->written,
+                       after_write_hedged_shard);
 }
 
-static void progress_request_shard(uv_async_t* async)
+static void after_write_hedged_shard(uv_fs_t *fs_req)
 {
-    shard_download_progress_t *progress = async->data;
+    shard_write_hedge_t *req = fs_req->data;
+    storj_download_state_t *state = req->state;
+    storj_pointer_t *pointer = &state->pointers[req->pointer_index];
+    ssize_t result = fs_req->result;
 
-    storj_download_state_t *state = progress->state;
+    uv_fs_req_cleanup(fs_req);
 
-    state->pointers[progress->pointer_index].downloaded_size = progress->bytes;
+    if (result > 0) {
+        req->written += result;
+        if (req->written < req->length && !write_hedged_shard(req)) {
+            return;
+        }
+    }
 
-    report_progress(state);
+    state->pending_work_count--;
+
+    if (req->written == req->length) {
+        finish_shard_download(state, pointer);
+    } else {
+        state->error_status = STORJ_FILE_WRITE_ERROR;
+    }
+
+    free(req->shard_data);
+    free(req);
+
+    queue_next_work(state);
 }
 
-static void queue_request_shards(storj_download_state_t *state)
+// A hedged shard was received first, streamed shards are kept in memory
+// and are used as they are, otherwise the shard is written to the file
+static void use_hedged_shard(storj_download_state_t *state,
+                             storj_pointer_t *pointer)
 {
-    if (state->canceled) {
+    // the exchange report is of the farmer the shard was received from
+    free(pointer->report->farmer_id);
+    pointer->report->farmer_id = pointer->hedge_farmer_id;
+    pointer->report->start = pointer->hedge_start;
+    pointer->report->end = pointer->hedge_end;
+    pointer->hedge_farmer_id = NULL;
+
+    state->log->info(state->env->log_options,
+                     state->handle,
+                     "Using shard %s received from farmer %s",
+                     pointer->shard_hash,
+                     pointer->report->farmer_id);
+
+    if (state->stream) {
+        free(pointer->shard_data);
+        pointer->shard_data = pointer->hedge_data;
+        pointer->hedge_data = NULL;
+        finish_shard_download(state, pointer);
         return;
     }
 
-    int i = 0;
+    shard_write_hedge_t *req = malloc(sizeof(shard_write_hedge_t));
+    if (!req) {
+        state->error_status = STORJ_MEMORY_ERROR;
+        return;
+    }
 
-    while (state->resolving_shards < state->download_max_concurrency &&
-           i < state->total_pointers) {
+    req->shard_data = pointer->hedge_data;
+    req->length = pointer->size;
+    req->written = 0;
+    req->file_position = pointer->index * state->shard_size;
+    req->pointer_index = pointer->index;
+    req->state = state;
 
-        storj_pointer_t *pointer = &state->pointers[i];
+    pointer->hedge_data = NULL;
 
-        if (pointer->status == POINTER_CREATED) {
-            shard_request_download_t *req = malloc(sizeof(shard_request_download_t));
-            if (!req) {
-                state->error_status = STORJ_MEMORY_ERROR;
-                return;
-            }
+    state->pending_work_count++;
+    if (write_hedged_shard(req)) {
+        state->pending_work_count--;
+        state->error_status = STORJ_FILE_WRITE_ERROR;
+        free(req->shard_data);
+        free(req);
+    }
+}
 
-            req->http_options = state->env->http_options;
-            req->farmer_id = pointer->farmer_id;
-            req->farmer_proto = "http";
-            req->farmer_host = pointer->farmer_address;
-            req->farmer_port = pointer->farmer_port;
-            req->shard_hash = pointer->shard_hash;
-            req->shard_total_bytes = pointer->size;
-            req->byte_position = state->shard_size * i;
-            req->token = pointer->token;
-            req->error_status = 0;
+// The download of a shard finished first, the other one isn't needed
+static void discard_hedged_shard(storj_pointer_t *pointer)
+{
+    free(pointer->hedge_data);
+    pointer->hedge_data = NULL;
+    free(pointer->hedge_farmer_id);
+    pointer->hedge_farmer_id = NULL;
 
-            req->pointer_index = pointer->index;
+    cancel_shard_request(pointer->hedge_work);
+}
 
-            req->state = state;
-            req->canceled = &state->canceled;
+static void after_request_shard(uv_work_t *work, int status)
+{
+    shard_request_download_t *req = work->data;
 
-            uv_work_t *work = malloc(sizeof(uv_work_t));
-            if (!work) {
-                state->error_status = STORJ_MEMORY_ERROR;
-                return;
-            }
+    req->state->pending_work_count--;
+    req->state->resolving_shards -= 1;
 
-            work->data = req;
+    uv_handle_t *progress_handle = (uv_handle_t *) &req->progress_handle;
 
-            state->resolving_shards += 1;
-            pointer->status = POINTER_BEING_DOWNLOADED;
-            pointer->work = work;
+    // free the download progress
+    free(progress_handle->data);
 
-            state->log->info(state->env->log_options,
-                             state->handle,
-                             "Queue request shard: %s",
-                             req->shard_hash);
+    // assign work so that we can free after progress_handle is closed
+    progress_handle->data = work;
 
-            // setup download progress reporting
-            shard_download_progress_t *progress =
-                malloc(sizeof(shard_download_progress_t));
-            if (!progress) {
-                state->error_status = STORJ_MEMORY_ERROR;
-                return;
-            }
+    // update the pointer status
+    storj_pointer_t *pointer = &req->state->pointers[req->pointer_index];
 
-            progress->pointer_index = pointer->index;
-            progress->bytes = 0;
-            progress->state = state;
+    pointer->work = NULL;
 
-            req->progress_handle.data = progress;
+    // this download was canceled once the hedged shard was received
+    if (pointer->hedge_data && req->error_status && !req->state->canceled) {
+        use_hedged_shard(req->state, pointer);
+        goto finish;
+    }
 
-            uv_async_init(state->env->loop, &req->progress_handle,
-                          progress_request_shard);
+    // a hedged download that is still running decides the shard when this
+    // one has failed, otherwise it isn't needed
+    bool hedging = req->error_status && !req->canceled && pointer->hedge_work;
+    if (!hedging) {
+        discard_hedged_shard(pointer);
+    }
 
-            // queue download
-            state->pending_work_count++;
-            int status = uv_queue_work(state->env->loop, (uv_work_t*) work,
-                                       request_shard, after_request_shard);
-            if (status) {
-                state->error_status = STORJ_QUEUE_ERROR;
-                return;
-            }
-        }
+    // the other shards were enough to recover this one
+    if (req->error_status && req->canceled && !req->state->canceled) {
+        req->state->log->info(req->state->env->log_options,
+                              req->state->handle,
+                              "Stopped downloading shard: %s",
+                              req->shard_hash);
 
-        i++;
+        set_pointer_status(req->state, pointer, POINTER_MISSING);
+        goto finish;
     }
-}
 
-static void send_exchange_report(uv_work_t *work)
-{
-    shard_send_report_t *req = work->data;
-    storj_download_state_t *state = req->state;
+    pointer->report->start = req->start;
+    pointer->report->end = req->end;
 
-    struct json_object *body = json_object_new_object();
+    if (req->error_status) {
 
-    json_object_object_add(body, "dataHash",
-                           json_object_new_string(req->report->data_hash));
+        req->state->log->warn(req->state->env->log_options,
+                              req->state->handle,
+                              "Error downloading shard: %s, reason: %s",
+                              req->shard_hash,
+                              storj_strerror(req->error_status));
 
-    json_object_object_add(body, "reporterId",
-                           json_object_new_string(req->report->reporter_id));
+        if (!hedging) {
+            set_pointer_status(req->state, pointer, POINTER_ERROR);
+        }
 
-    json_object_object_add(body, "farmerId",
-                           json_object_new_string(req->report->farmer_id));
+        if (concurrency_add_failure(&req->state->download_concurrency)) {
+            log_download_concurrency(req->state);
+        }
 
-    json_object_object_add(body, "clientId",
-                           json_object_new_string(req->report->client_id));
+        // release the memory until the shard is requested again
+        if (pointer->shard_data) {
+            free(pointer->shard_data);
+            pointer->shard_data = NULL;
+        }
 
-    json_object_object_add(body, "exchangeStart",
-                           json_object_new_int64(req->report->start));
+        switch(req->error_status) {
+            case STORJ_FARMER_INTEGRITY_ERROR:
+                pointer->report->code = STORJ_REPORT_FAILURE;
+                pointer->report->message = STORJ_REPORT_FAILED_INTEGRITY;
+            default:
+                pointer->report->code = STORJ_REPORT_FAILURE;
+                pointer->report->message = STORJ_REPORT_DOWNLOAD_ERROR;
+        }
 
-    json_object_object_add(body, "exchangeEnd",
-                           json_object_new_int64(req->report->end));
+        // the farmer is excluded from the replacement pointers
+        if (farmer_table_add_report(req->state->env->farmers,
+                                    pointer->report) ||
+            report_queue_add(req->state->env->reports, pointer->report)) {
+            req->state->error_status = STORJ_MEMORY_ERROR;
+        }
 
-    json_object_object_add(body, "exchangeResultCode",
-                           json_object_new_int(req->report->code));
+        if (hedging) {
+            req->state->log->info(req->state->env->log_options,
+                                  req->state->handle,
+                                  "Waiting for hedged shard: %s",
+                                  req->shard_hash);
+            goto finish;
+        }
 
-    json_object_object_add(body, "exchangeResultMessage",
-                           json_object_new_string(req->report->message));
+        // the pointer is replaced without waiting for the report to be sent
+        set_pointer_status(req->state, pointer, POINTER_ERROR_REPORTED);
 
-    int status_code = 0;
+    } else {
 
-    // there should be an empty object in response
-    struct json_object *response = NULL;
-    int request_status = fetch_json(req->http_options,
-                                    req->options, "POST",
-                                    "/reports/exchanges", body,
-                                    true, &response, &status_code);
+        req->state->log->info(req->state->env->log_options,
+                              req->state->handle,
+                              "Finished downloading shard: %s",
+                              req->shard_hash);
 
+        add_shard_rate(req->state, req->shard_total_bytes,
+                       req->start, req->end);
 
-    if (request_status) {
-        state->log->warn(state->env->log_options, state->handle,
-                         "Send exchange report error: %i", request_status);
-    }
+        if (concurrency_add_transfer(&req->state->download_concurrency,
+                                     req->shard_total_bytes,
+                                     req->start, req->end)) {
+            log_download_concurrency(req->state);
+        }
 
-    req->status_code = status_code;
+        finish_shard_download(req->state, pointer);
 
-    // free all memory for body and response
-    if (response) {
-        json_object_put(response);
     }
-    json_object_put(body);
+
+finish:
+    queue_next_work(req->state);
+
+    // close the async progress handle
+    uv_close(progress_handle, free_request_shard_work);
 }
 
-static void after_send_exchange_report(uv_work_t *work, int status)
+static void free_hedge_request(shard_request_download_t *req)
 {
-    shard_send_report_t *req = work->data;
+    free(req->farmer_id);
+    free(req->farmer_host);
+    free(req->shard_hash);
+    free(req->token);
+    free(req->shard_data);
+    free(req);
+}
 
-    req->state->pending_work_count--;
+static void after_hedge_shard(uv_work_t *work)
+{
+    shard_request_download_t *req = work->data;
+    storj_download_state_t *state = req->state;
+    storj_pointer_t *pointer = &state->pointers[req->pointer_index];
 
-    // set status so that this pointer can be replaced
-    if (req->report->send_count >= STORJ_MAX_REPORT_TRIES ||
-        req->status_code == 201) {
+    state->pending_work_count--;
+    state->hedging_shards -= 1;
+    pointer->hedge_work = NULL;
 
-        storj_pointer_t *pointer = &req->state->pointers[req->pointer_index];
+    // The hedged shard was received before the first download finished,
+    // which is canceled and then uses the received shard, or the first
+    // download has already failed and the shard is used now
+    if (!req->error_status && !req->canceled &&
+        pointer->status == POINTER_BEING_DOWNLOADED) {
 
-        if (pointer->status == POINTER_ERROR) {
-            pointer->status = POINTER_ERROR_REPORTED;
-        }
-    }
+        state->log->info(state->env->log_options,
+                         state->handle,
+                         "Finished downloading hedged shard: %s",
+                         req->shard_hash);
+
+        add_shard_rate(state, req->shard_total_bytes, req->start, req->end);
+
+        pointer->hedge_data = req->shard_data;
+        req->shard_data = NULL;
+
+        // the report is only changed once the race has been decided
+        pointer->hedge_farmer_id = req->farmer_id;
+        pointer->hedge_start = req->start;
+        pointer->hedge_end = req->end;
+        req->farmer_id = NULL;
 
-    if (req->status_code == 201) {
-        // set the status so that this pointer can be replaced
-        req->report->send_status = 2; // report has been sent
+        if (pointer->work) {
+            cancel_shard_request(pointer->work);
+        } else {
+            use_hedged_shard(state, pointer);
+        }
     } else {
-        req->report->send_status = 0; // reset report back to unsent
-    }
+        if (req->error_status && !req->canceled) {
+            state->log->debug(state->env->log_options,
+                              state->handle,
+                              "Error downloading hedged shard: %s, " \
+                              "reason: %s",
+                              req->shard_hash,
+                              storj_strerror(req->error_status));
+        }
 
-    queue_next_work(req->state);
+        // the first download had failed as well and the pointer is
+        // replaced, unless the other shards are enough to recover it
+        if (!pointer->work && pointer->status == POINTER_BEING_DOWNLOADED) {
+            if (req->canceled && !state->canceled) {
+                set_pointer_status(state, pointer, POINTER_MISSING);
+            } else {
+                set_pointer_status(state, pointer, POINTER_ERROR);
+                set_pointer_status(state, pointer, POINTER_ERROR_REPORTED);
+            }
+        }
+    }
 
-    free(work->data);
+    free_hedge_request(req);
     free(work);
 
+    queue_next_work(state);
 }
 
-static void queue_send_exchange_reports(storj_download_state_t *state)
+// Start the download of a shard from the farmer of a replacement pointer,
+// while the first download continues
+static int start_hedged_shard(storj_download_state_t *state,
+                              storj_pointer_t *pointer,
+                              struct json_object *json)
 {
+    struct json_object *value;
+    const char *token = NULL;
+    const char *hash = NULL;
+    const char *address = NULL;
+    const char *farmer_id = NULL;
+    int port = 0;
 
-    if (state->canceled) {
-        return;
+    if (json_object_object_get_ex(json, "token", &value)) {
+        token = json_object_get_string(value);
+    }
+    if (json_object_object_get_ex(json, "hash", &value)) {
+        hash = json_object_get_string(value);
     }
 
-    for (int i = 0; i < state->total_pointers; i++) {
+    struct json_object *farmer_value;
+    if (json_object_object_get_ex(json, "farmer", &farmer_value) &&
+        json_object_is_type(farmer_value, json_type_object)) {
+        if (json_object_object_get_ex(farmer_value, "address", &value)) {
+            address = json_object_get_string(value);
+        }
+        if (json_object_object_get_ex(farmer_value, "port", &value)) {
+            port = json_object_get_int(value);
+        }
+        if (json_object_object_get_ex(farmer_value, "nodeID", &value)) {
+            farmer_id = json_object_get_string(value);
+        }
+    }
 
-        storj_pointer_t *pointer = &state->pointers[i];
+    // the shard must be the same, from a different farmer
+    if (!token || !hash || !address || !farmer_id ||
+        0 != strcmp(hash, pointer->shard_hash) ||
+        0 == strcmp(farmer_id, pointer->farmer_id)) {
+        return 1;
+    }
 
-        if (pointer->report->send_status < 1 &&
-            pointer->report->send_count < STORJ_MAX_REPORT_TRIES &&
-            pointer->report->start > 0 &&
-            pointer->report->end > 0) {
+    shard_request_download_t *primary = pointer->work->data;
 
-            uv_work_t *work = malloc(sizeof(uv_work_t));
-            if (!work) {
-                state->error_status = STORJ_MEMORY_ERROR;
-                return;
-            }
+    shard_request_download_t *req = calloc(1, sizeof(shard_request_download_t));
+    if (!req) {
+        return 1;
+    }
 
-            shard_send_report_t *req = malloc(sizeof(shard_send_report_t));
-            if (!req) {
-                state->error_status = STORJ_MEMORY_ERROR;
-                return;
-            }
+    req->http_options = state->env->http_options;
+    req->farmer_id = strdup(farmer_id);
+    req->farmer_proto = "http";
+    req->farmer_host = strdup(address);
+    req->farmer_port = port;
+    req->shard_hash = strdup(hash);
+    req->token = strdup(token);
+    req->shard_total_bytes = pointer->size;
+    req->byte_position = primary->byte_position;
+    req->decrypt_on_receive = primary->decrypt_on_receive;
+    req->pointer_index = pointer->index;
+    req->state = state;
+    req->canceled = false;
+    req->hedge = true;
 
-            req->http_options = state->env->http_options;
-            req->options = state->env->bridge_options;
-            req->status_code = 0;
-            req->report = pointer->report;
-            req->report->send_status = 1; // being reported
-            req->report->send_count += 1;
-            req->state = state;
-            req->pointer_index = i;
+    // a streamed shard replaces the buffer of the first download
+    req->shard_data = calloc(state->stream ? state->shard_size : pointer->size,
+                             sizeof(uint8_t));
 
-            work->data = req;
+    uv_work_t *work = malloc(sizeof(uv_work_t));
 
-            state->pending_work_count++;
-            int status = uv_queue_work(state->env->loop, (uv_work_t*) work,
-                                       send_exchange_report,
-                                       after_send_exchange_report);
-            if (status) {
-                state->error_status = STORJ_QUEUE_ERROR;
-                return;
-            }
-        }
+    if (!req->farmer_id || !req->farmer_host || !req->shard_hash ||
+        !req->token || !req->shard_data || !work) {
+        free_hedge_request(req);
+        free(work);
+        return 1;
+    }
+
+    work->data = req;
+
+    state->log->info(state->env->log_options,
+                     state->handle,
+                     "Queue request hedged shard: %s from farmer %s",
+                     req->shard_hash,
+                     req->farmer_id);
+
+    if (request_shard(work)) {
+        free_hedge_request(req);
+        free(work);
+        return 1;
     }
+
+    state->pending_work_count++;
+    pointer->hedge_work = work;
+
+    return 0;
 }
 
-static void determine_decryption_key_v1(storj_download_state_t *state)
+static void after_request_hedge_pointer(uv_work_t *work, int status)
 {
-    uint8_t *index = NULL;
-    char *file_key_as_str = NULL;
+    json_request_replace_pointer_t *req = work->data;
+    storj_download_state_t *state = req->state;
+    storj_pointer_t *pointer = &state->pointers[req->pointer_index];
 
-    file_key_as_str = calloc(DETERMINISTIC_KEY_SIZE + 1, sizeof(char));
-    if (!file_key_as_str) {
-        state->error_status = STORJ_MEMORY_ERROR;
-        goto cleanup;
-    }
+    state->pending_work_count--;
 
-    if (generate_file_key(state->env->encrypt_options->mnemonic,
-                          state->bucket_id,
-                          state->info->index, &file_key_as_str)) {
-        state->error_status = STORJ_MEMORY_ERROR;
-        goto cleanup;
+    // the first download may have finished while waiting on the bridge
+    int hedge_status = 1;
+    if (status == 0 && !req->error_status && req->status_code == 200 &&
+        json_object_is_type(req->response, json_type_array) &&
+        json_object_array_length(req->response) > 0 &&
+        pointer->status == POINTER_BEING_DOWNLOADED && pointer->work &&
+        !state->canceled) {
+        hedge_status = start_hedged_shard(
+            state, pointer, json_object_array_get_idx(req->response, 0));
     }
-    file_key_as_str[DETERMINISTIC_KEY_SIZE] = '\0';
 
-    uint8_t *decrypt_key = str2hex(strlen(file_key_as_str), file_key_as_str);
-    if (!decrypt_key) {
-        state->error_status = STORJ_MEMORY_ERROR;
-        goto cleanup;
+    if (hedge_status) {
+        state->log->debug(state->env->log_options,
+                          state->handle,
+                          "Unable to hedge shard at index %i",
+                          req->pointer_index);
+        state->hedging_shards -= 1;
     }
 
-    state->decrypt_key = decrypt_key;
+    queue_next_work(state);
 
-    index = str2hex(strlen(state->info->index), (char *)state->info->index);
-    if (!index) {
-        state->error_status = STORJ_MEMORY_ERROR;
-        goto cleanup;
-    }
+    json_object_put(req->response);
+    free(req->excluded_farmer_ids);
+    free(req);
+    free(work);
+}
+
+static void queue_request_hedge_pointer(storj_download_state_t *state,
+                                        storj_pointer_t *pointer)
+{
+    // exclude the farmer of the slow download, and those that have failed
+    char *excluded_farmer_ids = NULL;
+    int exclude_status = farmer_table_exclude_list(state->env->farmers,
+                                                   pointer->farmer_id,
+                                                   get_time_milliseconds(),
+                                                   &excluded_farmer_ids);
+    if (exclude_status) {
+        state->error_status = exclude_status;
+        return;
+    }
+
+    json_request_replace_pointer_t *req =
+        malloc(sizeof(json_request_replace_pointer_t));
+    uv_work_t *work = malloc(sizeof(uv_work_t));
+    if (!req || !work) {
+        free(excluded_farmer_ids);
+        free(req);
+        free(work);
+        state->error_status = STORJ_MEMORY_ERROR;
+        return;
+    }
+
+    req->pointer_index = pointer->index;
+    req->http_options = state->env->http_options;
+    req->options = state->env->bridge_options;
+    req->bucket_id = state->bucket_id;
+    req->file_id = state->file_id;
+    req->state = state;
+    req->excluded_farmer_ids = excluded_farmer_ids;
+    req->error_status = 0;
+    req->response = NULL;
+    req->status_code = 0;
+
+    work->data = req;
+
+    state->log->info(state->env->log_options,
+                     state->handle,
+                     "Requesting hedge pointer for slow shard at index: %i",
+                     req->pointer_index);
+
+    state->pending_work_count++;
+    int status = uv_queue_work(state->env->loop, work,
+                               request_replace_pointer,
+                               after_request_hedge_pointer);
+    if (status) {
+        state->error_status = STORJ_QUEUE_ERROR;
+        return;
+    }
+
+    pointer->hedged = true;
+    state->hedging_shards += 1;
+}
+
+static int compare_shard_rates(const void *a, const void *b)
+{
+    uint64_t rate_a = *(const uint64_t *)a;
+    uint64_t rate_b = *(const uint64_t *)b;
+
+    return (rate_a > rate_b) - (rate_a < rate_b);
+}
+
+static uint64_t median_shard_rate(storj_download_state_t *state)
+{
+    uint32_t count = state->total_shard_rates;
+    if (count > STORJ_HEDGE_RATE_SAMPLES) {
+        count = STORJ_HEDGE_RATE_SAMPLES;
+    }
+
+    if (count < STORJ_HEDGE_MIN_SAMPLES) {
+        return 0;
+    }
+
+    uint64_t rates[STORJ_HEDGE_RATE_SAMPLES];
+    memcpy(rates, state->shard_rates, count * sizeof(uint64_t));
+    qsort(rates, count, sizeof(uint64_t), compare_shard_rates);
+
+    return rates[count / 2];
+}
+
+// A shard that has been downloading for a while at a fraction of the median
+// rate is slow. The parity shards are then downloaded so that a slow data
+// shard can be recovered, and the shard is requested from another farmer
+// as well, the first copy received is used. The shards are checked at most
+// once each interval.
+static void check_slow_shards(storj_download_state_t *state)
+{
+    if (state->canceled || state->error_status) {
+        return;
+    }
+
+    uint64_t now = get_time_milliseconds();
+    if (now - state->hedge_checked < STORJ_HEDGE_CHECK_INTERVAL) {
+        return;
+    }
+    state->hedge_checked = now;
+
+    uint64_t median_rate = median_shard_rate(state);
+    if (!median_rate) {
+        return;
+    }
+
+    for (int i = 0; i < state->total_pointers; i++) {
+        storj_pointer_t *pointer = &state->pointers[i];
+
+        if (pointer->status != POINTER_BEING_DOWNLOADED || !pointer->work) {
+            continue;
+        }
+
+        if (!pointer->slow) {
+            shard_request_download_t *req = pointer->work->data;
+            uint64_t elapsed = now - req->start;
+            if (elapsed < STORJ_HEDGE_MIN_TIME) {
+                continue;
+            }
+
+            uint64_t rate = pointer->downloaded_size * 1000 / elapsed;
+            if (rate * STORJ_HEDGE_RATE_RATIO >= median_rate) {
+                continue;
+            }
+
+            pointer->slow = true;
+
+            if (!pointer->parity && !state->fetching_parity) {
+                state->log->info(state->env->log_options,
+                                 state->handle,
+                                 "Slow shard at index %i, downloading " \
+                                 "parity shards", i);
+                state->fetching_parity = true;
+                queue_request_shards(state);
+            }
+        }
+
+        if (pointer->hedged || pointer->hedge_work || !pointer->farmer_id ||
+            state->hedging_shards >= state->hedge_limit) {
+            continue;
+        }
+
+        queue_request_hedge_pointer(state, pointer);
+        if (state->error_status) {
+            return;
+        }
+    }
+}
+
+static void progress_request_shard(uv_async_t* async)
+{
+    shard_download_progress_t *progress = async->data;
+
+    storj_download_state_t *state = progress->state;
+
+    state->pointers[progress->pointer_index].downloaded_size = progress->bytes;
+
+    report_progress(state);
+
+    check_slow_shards(state);
+}
+
+static bool is_deferred(storj_download_state_t *state,
+                        storj_pointer_t *pointer)
+{
+    if (pointer->parity) {
+        return is_parity_deferred(state);
+    }
+
+    if (!state->stream || state->stream_recovering) {
+        return false;
+    }
+
+    // data shards of a stream are only held in memory a few ahead of the
+    // position that has been written
+    return pointer->index >= state->stream_position + STORJ_DOWNLOAD_STREAM_WINDOW;
+}
+
+static void queue_request_shards(storj_download_state_t *state)
+{
+    if (state->canceled) {
+        return;
+    }
+
+    // the floor and ceiling can be set after the state is created
+    if (!state->download_concurrency.limit) {
+        concurrency_init(&state->download_concurrency,
+                         STORJ_DOWNLOAD_CONCURRENCY,
+                         state->download_min_concurrency,
+                         state->download_max_concurrency);
+
+        state->log->info(state->env->log_options, state->handle,
+                         "Downloading %" PRIu32 " shards at once, adapting "
+                         "between %" PRIu32 " and %" PRIu32,
+                         state->download_concurrency.limit,
+                         state->download_concurrency.min,
+                         state->download_concurrency.max);
+    }
+
+    uint32_t i;
+    bool skipped_pointers = false;
+
+    // pointers are taken lowest position first, parity pointers and those
+    // past the stream window are at the end and are left in the queue
+    while (state->resolving_shards < state->download_concurrency.limit &&
+           index_queue_peek(&state->created_pointers, &i)) {
+
+        storj_pointer_t *pointer = &state->pointers[i];
+
+        if (pointer->status != POINTER_CREATED) {
+            index_queue_pop(&state->created_pointers, &i);
+            continue;
+        }
+
+        if (is_deferred(state, pointer)) {
+            break;
+        }
+
+        index_queue_pop(&state->created_pointers, &i);
+
+        // a pointer to a farmer that keeps failing is replaced without
+        // trying it, the replacements are requested excluding the farmer
+        if (pointer->replace_count == 0 &&
+            farmer_table_is_bad(state->env->farmers, pointer->farmer_id,
+                                get_time_milliseconds())) {
+
+            state->log->info(state->env->log_options,
+                             state->handle,
+                             "Skipping farmer %s of shard %s, it has " \
+                             "failed recently",
+                             pointer->farmer_id,
+                             pointer->shard_hash);
+
+            set_pointer_status(state, pointer, POINTER_ERROR_REPORTED);
+            skipped_pointers = true;
+            continue;
+        }
+
+        shard_request_download_t *req = malloc(sizeof(shard_request_download_t));
+        if (!req) {
+            state->error_status = STORJ_MEMORY_ERROR;
+            return;
+        }
+
+        req->http_options = state->env->http_options;
+        req->farmer_id = pointer->farmer_id;
+        req->farmer_proto = "http";
+        req->farmer_host = pointer->farmer_address;
+        req->farmer_port = pointer->farmer_port;
+        req->shard_hash = pointer->shard_hash;
+        req->shard_total_bytes = pointer->size;
+        req->byte_position = state->shard_size * i;
+        req->token = pointer->token;
+        req->error_status = 0;
+        req->shard_data = NULL;
+
+        // data shards written to the file are decrypted as they're received,
+        // parity shards are kept encrypted for recovery
+        req->decrypt_on_receive = state->decrypt_on_receive &&
+            !state->stream && !pointer->parity &&
+            state->decrypt_key && state->decrypt_ctr;
+
+        req->pointer_index = pointer->index;
+
+        req->state = state;
+        req->canceled = false;
+        req->hedge = false;
+
+        uv_work_t *work = malloc(sizeof(uv_work_t));
+        if (!work) {
+            state->error_status = STORJ_MEMORY_ERROR;
+            return;
+        }
+
+        work->data = req;
+
+        // streamed shards are kept in memory until written, sized
+        // for a complete shard in case it's needed for recovery
+        if (state->stream) {
+            pointer->shard_data = calloc(state->shard_size,
+                                         sizeof(uint8_t));
+            if (!pointer->shard_data) {
+                state->error_status = STORJ_MEMORY_ERROR;
+                return;
+            }
+            req->shard_data = pointer->shard_data;
+        }
+
+        state->resolving_shards += 1;
+        set_pointer_status(state, pointer, POINTER_BEING_DOWNLOADED);
+        pointer->work = work;
+
+        state->log->info(state->env->log_options,
+                         state->handle,
+                         "Queue request shard: %s",
+                         req->shard_hash);
+
+        // setup download progress reporting
+        shard_download_progress_t *progress =
+            malloc(sizeof(shard_download_progress_t));
+        if (!progress) {
+            state->error_status = STORJ_MEMORY_ERROR;
+            return;
+        }
+
+        progress->pointer_index = pointer->index;
+        progress->bytes = 0;
+        progress->state = state;
+
+        req->progress_handle.data = progress;
+
+        uv_async_init(state->env->loop, &req->progress_handle,
+                      progress_request_shard);
+
+        // start download
+        state->pending_work_count++;
+        int status = request_shard(work);
+        if (status) {
+            state->error_status = STORJ_QUEUE_ERROR;
+            return;
+        }
+    }
+
+    if (skipped_pointers) {
+        queue_replace_pointers(state);
+    }
+}
+
+static void determine_decryption_key_v1(storj_download_state_t *state)
+{
+    uint8_t *index = NULL;
+    char *file_key_as_str = NULL;
+
+    file_key_as_str = calloc(DETERMINISTIC_KEY_SIZE + 1, sizeof(char));
+    if (!file_key_as_str) {
+        state->error_status = STORJ_MEMORY_ERROR;
+        goto cleanup;
+    }
+
+    if (generate_file_key_cached(state->env->encrypt_options->key_cache,
+                                 state->bucket_id,
+                                 state->info->index, &file_key_as_str)) {
+        state->error_status = STORJ_MEMORY_ERROR;
+        goto cleanup;
+    }
+    file_key_as_str[DETERMINISTIC_KEY_SIZE] = '\0';
+
+    uint8_t *decrypt_key = str2hex(strlen(file_key_as_str), file_key_as_str);
+    if (!decrypt_key) {
+        state->error_status = STORJ_MEMORY_ERROR;
+        goto cleanup;
+    }
+
+    state->decrypt_key = decrypt_key;
+
+    index = str2hex(strlen(state->info->index), (char *)state->info->index);
+    if (!index) {
+        state->error_status = STORJ_MEMORY_ERROR;
+        goto cleanup;
+    }
 
     uint8_t *decrypt_ctr = calloc(AES_BLOCK_SIZE, sizeof(uint8_t));
     if (!decrypt_ctr) {
@@ -1080,9 +2019,9 @@ static void determine_decryption_key_v0(storj_download_state_t *state)
         return;
     }
 
-    if (generate_file_key(state->env->encrypt_options->mnemonic,
-                          state->bucket_id,
-                          state->file_id, &file_key)) {
+    if (generate_file_key_cached(state->env->encrypt_options->key_cache,
+                                 state->bucket_id,
+                                 state->file_id, &file_key)) {
         state->error_status = STORJ_MEMORY_ERROR;
         return;
     }
@@ -1153,7 +2092,8 @@ static void after_request_info(uv_work_t *work, int status)
         if (req->info->erasure) {
             if (strcmp(req->info->erasure, "reedsolomon") == 0) {
                 req->state->rs = true;
-                req->state->truncated = false;
+                // a stream is never written to a file that needs truncating
+                req->state->truncated = req->state->stream;
             } else {
                 req->state->error_status = STORJ_FILE_UNSUPPORTED_ERASURE;
             }
@@ -1419,36 +2359,111 @@ static int prepare_file_hmac(storj_download_state_t *state)
 
 static bool has_missing_shard(storj_download_state_t *state)
 {
-    bool missing = false;
+    return state->missing_pointers > 0;
+}
+
+static bool has_missing_data_shard(storj_download_state_t *state)
+{
+    return state->missing_data_pointers > 0;
+}
+
+// Shards can be recovered once every pointer is either missing or
+// downloaded, or once every data pointer is downloaded when the parity
+// shards haven't been needed
+static bool is_ready_to_recover(storj_download_state_t *state)
+{
+    if (is_parity_deferred(state)) {
+        return state->downloaded_pointers + state->total_parity_pointers ==
+            state->total_pointers;
+    }
+
+    return state->missing_pointers + state->downloaded_pointers ==
+        state->total_pointers;
+}
+
+// Once enough shards have been downloaded to recover the file, the slow
+// data shards are recovered instead of waiting for them, and the parity
+// shards that are still downloading are no longer needed
+static void stop_slow_shards(storj_download_state_t *state)
+{
+    uint32_t data_pointers = state->total_pointers -
+        state->total_parity_pointers;
+
+    if (is_parity_deferred(state) || !state->pointers_completed ||
+        state->downloaded_pointers < data_pointers) {
+        return;
+    }
+
     for (int i = 0; i < state->total_pointers; i++) {
         storj_pointer_t *pointer = &state->pointers[i];
-        if (pointer->status == POINTER_MISSING) {
-            missing = true;
+        if (pointer->status == POINTER_DOWNLOADED ||
+            pointer->status == POINTER_MISSING) {
+            continue;
+        }
+
+        if (pointer->status != POINTER_BEING_DOWNLOADED ||
+            (!pointer->parity && !pointer->slow)) {
+            return;
+        }
+    }
+
+    // a shard whose first download has failed waits on its hedged one
+    for (int i = 0; i < state->total_pointers; i++) {
+        storj_pointer_t *pointer = &state->pointers[i];
+        if (pointer->status == POINTER_BEING_DOWNLOADED) {
+            cancel_shard_request(pointer->work ? pointer->work :
+                                 pointer->hedge_work);
         }
     }
-    return missing;
 }
 
 static bool can_recover_shards(storj_download_state_t *state)
 {
-    if (state->pointers_completed) {
-        uint32_t missing_pointers = 0;
-
-        for (int i = 0; i < state->total_pointers; i++) {
-            storj_pointer_t *pointer = &state->pointers[i];
-            if (pointer->status == POINTER_MISSING) {
-                missing_pointers += 1;
-            }
-        }
+    // only the pointers of a range are known
+    if (state->range_length && has_missing_data_shard(state)) {
+        return false;
+    }
 
-        if (missing_pointers > state->total_parity_pointers) {
-            return false;
-        }
+    if (state->pointers_completed &&
+        state->missing_pointers > state->total_parity_pointers) {
+        return false;
     }
 
     return true;
 }
 
+static void free_recover_request(uv_handle_t *progress_handle)
+{
+    file_request_recover_t *req = progress_handle->data;
+
+    uv_mutex_destroy(&req->progress_lock);
+    free(req);
+}
+
+static void progress_recover_shards(uv_async_t *async)
+{
+    file_request_recover_t *req = async->data;
+    storj_download_state_t *state = req->state;
+
+    uv_mutex_lock(&req->progress_lock);
+    uint64_t decrypted_bytes = req->decrypted_bytes;
+    uv_mutex_unlock(&req->progress_lock);
+
+    // decrypting a small file is quick and isn't reported, the end is
+    // reported once the recovery has finished
+    if (req->data_filesize < STORJ_DECRYPT_PROGRESS_SIZE ||
+        decrypted_bytes >= req->data_filesize) {
+        return;
+    }
+
+    req->reported_progress = true;
+
+    state->progress_cb((double)decrypted_bytes / (double)req->data_filesize,
+                       decrypted_bytes,
+                       req->data_filesize,
+                       state->handle);
+}
+
 static void after_recover_shards(uv_work_t *work, int status)
 {
     file_request_recover_t *req = work->data;
@@ -1465,22 +2480,140 @@ static void after_recover_shards(uv_work_t *work, int status)
     } else {
         // Recovery was successful and the pointers have been finished
         for (int i = 0; i < state->total_pointers; i++) {
-            state->pointers[i].status = POINTER_FINISHED;
+            set_pointer_status(state, &state->pointers[i], POINTER_FINISHED);
             state->completed_shards += 1;
         }
+
+        if (req->reported_progress) {
+            state->progress_cb(1, req->data_filesize, req->data_filesize,
+                               state->handle);
+        }
     }
 
-    queue_next_work(state);
-
-    memset_zero(req->decrypt_key, SHA256_DIGEST_SIZE);
-    free(req->decrypt_key);
+    if (req->decrypt_key) {
+        memset_zero(req->decrypt_key, SHA256_DIGEST_SIZE);
+        free(req->decrypt_key);
+    }
 
-    memset_zero(req->decrypt_ctr, AES_BLOCK_SIZE);
-    free(req->decrypt_ctr);
+    if (req->decrypt_ctr) {
+        memset_zero(req->decrypt_ctr, AES_BLOCK_SIZE);
+        free(req->decrypt_ctr);
+    }
 
     free(req->zilch);
-    free(req);
     free(work);
+
+    // the request is freed once the progress handle is closed
+    uv_close((uv_handle_t *)&req->progress_handle, free_recover_request);
+
+    queue_next_work(state);
+}
+
+static void decrypt_range(void *arg)
+{
+    decrypt_range_job_t *job = arg;
+    file_request_recover_t *req = job->req;
+    struct aes256_ctx ctx;
+    uint8_t ctr[AES_BLOCK_SIZE];
+
+    // CTR mode can start at any block, each range has its own counter
+    aes256_set_encrypt_key(&ctx, req->decrypt_key);
+    memcpy(ctr, req->decrypt_ctr, AES_BLOCK_SIZE);
+    increment_ctr_aes_iv(ctr, job->offset);
+
+    uint64_t position = job->offset;
+    uint64_t end = job->offset + job->length;
+
+    while (position < end) {
+        uint64_t len = STORJ_DECRYPT_CHUNK_SIZE;
+        if (position + len > end) {
+            len = end - position;
+        }
+
+        aes256_ctr_crypt(&ctx, ctr, len,
+                         job->data + position,
+                         job->data + position);
+
+        position += len;
+
+        if (!job->report_progress) {
+            continue;
+        }
+
+        uv_mutex_lock(&req->progress_lock);
+        req->decrypted_bytes += len;
+        uv_mutex_unlock(&req->progress_lock);
+
+        uv_async_send(&req->progress_handle);
+    }
+
+    memset_zero(&ctx, sizeof(struct aes256_ctx));
+    memset_zero(ctr, AES_BLOCK_SIZE);
+}
+
+static void decrypt_ranges(file_request_recover_t *req, uint8_t *data,
+                           uint64_t length, bool report_progress)
+{
+    // Each thread gets a contiguous range of the file, aligned to the
+    // chunk size and not smaller than the minimum range
+    int thread_count = req->decrypt_threads;
+    uint64_t max_threads = length / STORJ_MIN_DECRYPT_RANGE;
+    if ((uint64_t)thread_count > max_threads) {
+        thread_count = max_threads;
+    }
+    if (thread_count < 1) {
+        thread_count = 1;
+    }
+
+    uint64_t range = length / thread_count;
+    range = ((range + STORJ_DECRYPT_CHUNK_SIZE - 1) /
+             STORJ_DECRYPT_CHUNK_SIZE) * STORJ_DECRYPT_CHUNK_SIZE;
+
+    decrypt_range_job_t jobs[thread_count];
+    uv_thread_t threads[thread_count];
+    int started = 0;
+    bool failed = false;
+
+    for (int i = 0; i < thread_count; i++) {
+        jobs[i].data = data;
+        jobs[i].req = req;
+        jobs[i].report_progress = report_progress;
+        jobs[i].offset = i * range;
+        jobs[i].length = 0;
+        if (jobs[i].offset < length) {
+            jobs[i].length = length - jobs[i].offset;
+            if (jobs[i].length > range) {
+                jobs[i].length = range;
+            }
+        }
+    }
+
+    // The first range is decrypted by the calling thread
+    for (int i = 1; i < thread_count; i++) {
+        if (!jobs[i].length) {
+            break;
+        }
+        if (uv_thread_create(&threads[i], decrypt_range, &jobs[i])) {
+            failed = true;
+            break;
+        }
+        started = i;
+    }
+
+    decrypt_range(&jobs[0]);
+
+    for (int i = 1; i <= started; i++) {
+        uv_thread_join(&threads[i]);
+    }
+
+    // Finish any ranges that a thread could not be started for
+    if (failed) {
+        for (int i = started + 1; i < thread_count; i++) {
+            if (jobs[i].length) {
+                decrypt_range(&jobs[i]);
+            }
+        }
+    }
 }
 
 static void recover_shards(uv_work_t *work)
@@ -1494,10 +2627,6 @@ static void recover_shards(uv_work_t *work)
 
     int error = 0;
 
-    struct aes256_ctx ctx;
-    uint64_t bytes_decrypted = 0;
-    size_t len = AES_BLOCK_SIZE * 8;
-
     // Make sure that the file is the correct size before recovering
     // shards in case that the last shard is the one being recovered.
 #ifdef _WIN32
@@ -1529,194 +2658,545 @@ static void recover_shards(uv_work_t *work)
     }
 #endif
 
-    error = map_file(req->fd, req->filesize, &data_map, false);
-    if (error) {
-        req->error_status = STORJ_MAPPING_ERROR;
-        goto finish;
-    }
+    error = map_file(req->fd, req->filesize, &data_map, false);
+    if (error) {
+        req->error_status = STORJ_MAPPING_ERROR;
+        goto finish;
+    }
+
+    if (!req->has_missing) {
+        goto decrypt;
+    }
+
+    // Data shards that were decrypted on receive are encrypted again, the
+    // parity shards are of the encrypted data. The padding of the last data
+    // shard was decrypted as well, so all of the data shards are included.
+    if (req->decrypted_data) {
+        decrypt_ranges(req, data_map, req->data_shards * req->shard_size,
+                       false);
+    }
+
+    fec_init();
+
+    rs = reed_solomon_new(req->data_shards, req->parity_shards);
+    if (!rs) {
+        req->error_status = STORJ_MEMORY_ERROR;
+        goto finish;
+    }
+
+    data_blocks = (uint8_t**)malloc(req->data_shards * sizeof(uint8_t *));
+    if (!data_blocks) {
+        req->error_status = STORJ_MEMORY_ERROR;
+        goto finish;
+    }
+
+    fec_blocks = (uint8_t**)malloc(req->parity_shards * sizeof(uint8_t *));
+    if (!fec_blocks) {
+        req->error_status = STORJ_MEMORY_ERROR;
+        goto finish;
+    }
+
+    for (int i = 0; i < req->data_shards; i++) {
+        data_blocks[i] = data_map + i * req->shard_size;
+    }
+
+    for (int i = 0; i < req->parity_shards; i++) {
+        fec_blocks[i] = data_map + (req->data_shards + i) * req->shard_size;
+    }
+
+    uint32_t total_shards = req->data_shards + req->parity_shards;
+
+    state->log->debug(state->env->log_options, state->handle,
+                      "Recovering shards, data_shards: %i, "            \
+                      "parity_shards: %i, shard_size: %" PRIu64 ", "    \
+                      "file_size: %" PRIu64,
+                      req->data_shards,
+                      req->parity_shards,
+                      req->shard_size,
+                      req->data_filesize);
+
+    error = reed_solomon_reconstruct(rs, data_blocks, fec_blocks,
+                                     req->zilch, total_shards,
+                                     req->shard_size, req->data_filesize);
+
+    if (error) {
+        req->error_status = STORJ_FILE_RECOVER_ERROR;
+        goto finish;
+    }
+
+
+decrypt:
+
+    if (req->decrypt_key && req->decrypt_ctr &&
+        (req->has_missing || !req->decrypted_data)) {
+        decrypt_ranges(req, data_map, req->data_filesize, true);
+    }
+
+finish:
+    if (data_map) {
+        error = unmap_file(data_map, req->filesize);
+        if (error) {
+            req->error_status = STORJ_UNMAPPING_ERROR;
+        }
+    }
+
+    if (data_blocks) {
+        free(data_blocks);
+    }
+
+    if (fec_blocks) {
+        free(fec_blocks);
+    }
+
+    if (rs) {
+        reed_solomon_release(rs);
+    }
+
+#ifdef _WIN32
+
+    HANDLE file = (HANDLE)_get_osfhandle(req->fd);
+    if (file == INVALID_HANDLE_VALUE) {
+        req->error_status = STORJ_FILE_RESIZE_ERROR;
+        return;
+    }
+
+    LARGE_INTEGER size;
+    size.HighPart = (uint32_t)((req->data_filesize & 0xFFFFFFFF00000000LL) >> 32);
+    size.LowPart = (uint32_t)(req->data_filesize & 0xFFFFFFFFLL);
+
+    if (!SetFilePointerEx(file, size, 0, FILE_BEGIN)) {
+        req->error_status = STORJ_FILE_RESIZE_ERROR;
+        return;
+    }
+
+    if (!SetEndOfFile(file)) {
+        req->error_status = STORJ_FILE_RESIZE_ERROR;
+        return;
+    }
+
+#else
+    if (ftruncate(req->fd, req->data_filesize)) {
+        // errno for more details
+        req->error_status = STORJ_FILE_RESIZE_ERROR;
+    }
+#endif
+
+}
+
+static void queue_recover_shards(storj_download_state_t *state)
+{
+    if (!state->recovering_shards && state->pointers_completed) {
+
+        stop_slow_shards(state);
+
+        if (!is_ready_to_recover(state)) {
+            state->log->debug(state->env->log_options,
+                              state->handle,
+                              "Pointers not ready, %i missing and %i "
+                              "downloaded of %i",
+                              state->missing_pointers,
+                              state->downloaded_pointers,
+                              state->total_pointers);
+            return;
+        }
+
+        int total_missing = 0;
+        bool has_missing = false;
+
+        uint8_t *zilch = (uint8_t *)calloc(1, state->total_pointers);
+
+        // the parity shards are only of use to recover a data shard
+        for (int i = 0; i < state->total_pointers; i++) {
+            storj_pointer_t *pointer = &state->pointers[i];
+            if (pointer->status == POINTER_MISSING) {
+                total_missing += 1;
+                if (!pointer->parity) {
+                    has_missing = true;
+                }
+                zilch[i] = 1;
+            }
+        }
+
+        state->log->info(state->env->log_options,
+                         state->handle,
+                         "Queuing recovery of %i of %i shards",
+                         total_missing, state->total_shards);
+
+        bool decrypted_data = state->decrypt_on_receive &&
+            state->decrypt_key && state->decrypt_ctr;
+
+        // the file is changed in place from here, and a download that
+        // stops during the recovery can't continue from the journal
+        if (state->journal && (has_missing || !decrypted_data)) {
+            int journal_status = journal_append(state->journal, "recover", 0,
+                                                "-");
+            if (journal_status) {
+                state->error_status = journal_status;
+                free(zilch);
+                return;
+            }
+        }
+
+        file_request_recover_t *req = malloc(sizeof(file_request_recover_t));
+        if (!req) {
+            state->error_status = STORJ_MEMORY_ERROR;
+            return;
+        }
+
+        uv_work_t *work = malloc(sizeof(uv_work_t));
+        if (!work) {
+            state->error_status = STORJ_MEMORY_ERROR;
+            return;
+        }
+
+        req->fd = fileno(state->destination);
+        req->filesize = state->shard_size * state->total_pointers;
+        req->data_filesize = calculate_data_filesize(state);
+        req->data_shards = state->total_pointers - state->total_parity_pointers;
+        req->parity_shards = state->total_parity_pointers;
+        req->shard_size = state->shard_size;
+        req->zilch = zilch;
+        req->has_missing = has_missing;
+        req->decrypted_data = decrypted_data;
+
+        if (state->decrypt_key && state->decrypt_ctr) {
+            req->decrypt_key = calloc(SHA256_DIGEST_SIZE, sizeof(uint8_t));
+            if (!req->decrypt_key) {
+                state->error_status = STORJ_MEMORY_ERROR;
+                return;
+            }
+            req->decrypt_ctr = calloc(AES_BLOCK_SIZE, sizeof(uint8_t));
+            if (!req->decrypt_ctr) {
+                state->error_status = STORJ_MEMORY_ERROR;
+                return;
+            }
+            memcpy(req->decrypt_key, state->decrypt_key, SHA256_DIGEST_SIZE);
+            memcpy(req->decrypt_ctr, state->decrypt_ctr, AES_BLOCK_SIZE);
+
+            increment_ctr_aes_iv(req->decrypt_ctr, 0);
+        } else {
+            req->decrypt_key = NULL;
+            req->decrypt_ctr = NULL;
+        }
+
+        req->state = state;
+        req->error_status = 0;
+        req->decrypt_threads = state->decrypt_threads;
+        req->decrypted_bytes = 0;
+        req->reported_progress = false;
+
+        if (uv_mutex_init(&req->progress_lock)) {
+            state->error_status = STORJ_MEMORY_ERROR;
+            return;
+        }
+
+        uv_async_init(state->env->loop, &req->progress_handle,
+                      progress_recover_shards);
+        req->progress_handle.data = req;
+
+        work->data = req;
+
+        state->pending_work_count++;
+        int status = uv_queue_work(state->env->loop, (uv_work_t*) work,
+                                   recover_shards, after_recover_shards);
+
+        if (status) {
+            state->error_status = STORJ_QUEUE_ERROR;
+            uv_close((uv_handle_t *)&req->progress_handle,
+                     free_recover_request);
+            return;
+        }
+
+        state->recovering_shards = true;
+    }
+}
+
+static void stream_shard(uv_work_t *work)
+{
+    shard_request_stream_t *req = work->data;
+
+    if (!req->decrypt_key || !req->decrypt_ctr) {
+        return;
+    }
+
+    // CTR mode can start at any block of the shard
+    uint64_t skip = req->offset % AES_BLOCK_SIZE;
+    uint64_t offset = req->offset - skip;
+
+    increment_ctr_aes_iv(req->decrypt_ctr, req->byte_position + offset);
+
+    struct aes256_ctx ctx;
+    aes256_set_encrypt_key(&ctx, req->decrypt_key);
+
+    aes256_ctr_crypt(&ctx, req->decrypt_ctr,
+                     req->length + skip,
+                     req->shard_data + offset,
+                     req->shard_data + offset);
+}
+
+static void after_stream_shard(uv_work_t *work, int status)
+{
+    shard_request_stream_t *req = work->data;
+    storj_download_state_t *state = req->state;
+
+    state->pending_work_count--;
+    state->writing = false;
+
+    storj_pointer_t *pointer = &state->pointers[req->pointer_index];
 
-    if (!req->has_missing) {
-        goto decrypt;
+    if (status != 0) {
+        state->error_status = STORJ_QUEUE_ERROR;
+    } else if (!state->canceled) {
+        if (state->write_cb(req->shard_data + req->offset, req->length,
+                            state->handle)) {
+            state->error_status = STORJ_FILE_WRITE_ERROR;
+        }
     }
 
-    fec_init();
+    free(pointer->shard_data);
+    pointer->shard_data = NULL;
+    set_pointer_status(state, pointer, POINTER_FINISHED);
 
-    rs = reed_solomon_new(req->data_shards, req->parity_shards);
-    if (!rs) {
-        req->error_status = STORJ_MEMORY_ERROR;
-        goto finish;
-    }
+    state->completed_shards += 1;
+    state->stream_position += 1;
 
-    data_blocks = (uint8_t**)malloc(req->data_shards * sizeof(uint8_t *));
-    if (!data_blocks) {
-        req->error_status = STORJ_MEMORY_ERROR;
-        goto finish;
-    }
+    queue_next_work(state);
 
-    fec_blocks = (uint8_t**)malloc(req->parity_shards * sizeof(uint8_t *));
-    if (!fec_blocks) {
-        req->error_status = STORJ_MEMORY_ERROR;
-        goto finish;
+    if (req->decrypt_key) {
+        memset_zero(req->decrypt_key, SHA256_DIGEST_SIZE);
+        free(req->decrypt_key);
     }
 
-    for (int i = 0; i < req->data_shards; i++) {
-        data_blocks[i] = data_map + i * req->shard_size;
+    if (req->decrypt_ctr) {
+        memset_zero(req->decrypt_ctr, AES_BLOCK_SIZE);
+        free(req->decrypt_ctr);
     }
 
-    for (int i = 0; i < req->parity_shards; i++) {
-        fec_blocks[i] = data_map + (req->data_shards + i) * req->shard_size;
-    }
+    free(req);
+    free(work);
+}
 
-    uint32_t total_shards = req->data_shards + req->parity_shards;
+static void stream_recover_shards(uv_work_t *work)
+{
+    stream_request_recover_t *req = work->data;
+    storj_download_state_t *state = req->state;
+
+    fec_init();
+
+    reed_solomon *rs = reed_solomon_new(req->data_shards, req->parity_shards);
+    if (!rs) {
+        req->error_status = STORJ_MEMORY_ERROR;
+        return;
+    }
 
     state->log->debug(state->env->log_options, state->handle,
-                      "Recovering shards, data_shards: %i, "            \
-                      "parity_shards: %i, shard_size: %" PRIu64 ", "    \
-                      "file_size: %" PRIu64,
+                      "Recovering stream shards, data_shards: %i, "     \
+                      "parity_shards: %i, shard_size: %" PRIu64,
                       req->data_shards,
                       req->parity_shards,
-                      req->shard_size,
-                      req->data_filesize);
-
-    error = reed_solomon_reconstruct(rs, data_blocks, fec_blocks,
-                                     req->zilch, total_shards,
-                                     req->shard_size, req->data_filesize);
+                      req->shard_size);
 
+    int error = reed_solomon_reconstruct(rs, req->data_blocks,
+                                         req->fec_blocks, req->zilch,
+                                         req->data_shards + req->parity_shards,
+                                         req->shard_size,
+                                         req->data_filesize);
     if (error) {
         req->error_status = STORJ_FILE_RECOVER_ERROR;
-        goto finish;
     }
 
+    reed_solomon_release(rs);
+}
 
-decrypt:
+static void after_stream_recover_shards(uv_work_t *work, int status)
+{
+    stream_request_recover_t *req = work->data;
+    storj_download_state_t *state = req->state;
 
-    aes256_set_encrypt_key(&ctx, req->decrypt_key);
+    state->pending_work_count--;
+    state->recovering_shards = false;
+    state->stream_recovering = false;
+
+    if (status != 0) {
+        state->error_status = STORJ_QUEUE_ERROR;
+    } else if (req->error_status) {
+        state->error_status = req->error_status;
+    } else {
+        // Data shards that have not been written are now complete, and
+        // all other shards are no longer needed
+        for (int i = 0; i < state->total_pointers; i++) {
+            storj_pointer_t *pointer = &state->pointers[i];
 
-    while (bytes_decrypted < req->data_filesize) {
+            if (!pointer->parity && i >= state->stream_position) {
+                set_pointer_status(state, pointer, POINTER_DOWNLOADED);
+                continue;
+            }
 
-        if (bytes_decrypted + len > req->data_filesize) {
-            len = req->data_filesize - bytes_decrypted;
+            free(pointer->shard_data);
+            pointer->shard_data = NULL;
+            set_pointer_status(state, pointer, POINTER_FINISHED);
+            state->completed_shards += 1;
         }
+    }
 
-        ctr_crypt(&ctx, (nettle_cipher_func *)aes256_encrypt,
-                  AES_BLOCK_SIZE, req->decrypt_ctr,
-                  len,
-                  (uint8_t *)data_map + bytes_decrypted,
-                  (uint8_t *)data_map + bytes_decrypted);
+    queue_next_work(state);
 
-        bytes_decrypted += len;
-    }
+    free(req->data_blocks);
+    free(req->fec_blocks);
+    free(req->zilch);
+    free(req);
+    free(work);
+}
 
-finish:
-    if (data_map) {
-        error = unmap_file(data_map, req->filesize);
-        if (error) {
-            req->error_status = STORJ_UNMAPPING_ERROR;
-        }
+static void queue_stream_recover_shards(storj_download_state_t *state)
+{
+    if (state->recovering_shards || !state->pointers_completed ||
+        !is_ready_to_recover(state)) {
+        return;
     }
 
-    if (data_blocks) {
-        free(data_blocks);
-    }
+    uint32_t data_shards = state->total_pointers - state->total_parity_pointers;
+    uint32_t parity_shards = state->total_parity_pointers;
 
-    if (fec_blocks) {
-        free(fec_blocks);
+    stream_request_recover_t *req = malloc(sizeof(stream_request_recover_t));
+    if (!req) {
+        state->error_status = STORJ_MEMORY_ERROR;
+        return;
     }
 
-    if (rs) {
-        reed_solomon_release(rs);
+    req->data_blocks = malloc(data_shards * sizeof(uint8_t *));
+    req->fec_blocks = malloc(parity_shards * sizeof(uint8_t *));
+    req->zilch = calloc(1, state->total_pointers);
+    if (!req->data_blocks || !req->fec_blocks || !req->zilch) {
+        state->error_status = STORJ_MEMORY_ERROR;
+        return;
     }
 
-#ifdef _WIN32
+    int total_missing = 0;
 
-    HANDLE file = (HANDLE)_get_osfhandle(req->fd);
-    if (file == INVALID_HANDLE_VALUE) {
-        req->error_status = STORJ_FILE_RESIZE_ERROR;
-        return;
-    }
+    for (int i = 0; i < state->total_pointers; i++) {
+        storj_pointer_t *pointer = &state->pointers[i];
 
-    LARGE_INTEGER size;
-    size.HighPart = (uint32_t)((req->data_filesize & 0xFFFFFFFF00000000LL) >> 32);
-    size.LowPart = (uint32_t)(req->data_filesize & 0xFFFFFFFFLL);
+        if (pointer->status == POINTER_MISSING) {
+            pointer->shard_data = calloc(state->shard_size, sizeof(uint8_t));
+            if (!pointer->shard_data) {
+                state->error_status = STORJ_MEMORY_ERROR;
+                return;
+            }
+            req->zilch[i] = 1;
+            total_missing += 1;
+        }
 
-    if (!SetFilePointerEx(file, size, 0, FILE_BEGIN)) {
-        req->error_status = STORJ_FILE_RESIZE_ERROR;
-        return;
+        if (i < data_shards) {
+            req->data_blocks[i] = pointer->shard_data;
+        } else {
+            req->fec_blocks[i - data_shards] = pointer->shard_data;
+        }
     }
 
-    if (!SetEndOfFile(file)) {
-        req->error_status = STORJ_FILE_RESIZE_ERROR;
+    state->log->info(state->env->log_options,
+                     state->handle,
+                     "Queuing recovery of %i of %i stream shards",
+                     total_missing, state->total_shards);
+
+    req->data_filesize = calculate_data_filesize(state);
+    req->data_shards = data_shards;
+    req->parity_shards = parity_shards;
+    req->shard_size = state->shard_size;
+    req->state = state;
+    req->error_status = 0;
+
+    uv_work_t *work = malloc(sizeof(uv_work_t));
+    if (!work) {
+        state->error_status = STORJ_MEMORY_ERROR;
         return;
     }
+    work->data = req;
 
-#else
-    if (ftruncate(req->fd, req->data_filesize)) {
-        // errno for more details
-        req->error_status = STORJ_FILE_RESIZE_ERROR;
+    state->pending_work_count++;
+    int status = uv_queue_work(state->env->loop, (uv_work_t*) work,
+                               stream_recover_shards,
+                               after_stream_recover_shards);
+    if (status) {
+        state->error_status = STORJ_QUEUE_ERROR;
+        return;
     }
-#endif
 
+    state->recovering_shards = true;
 }
 
-static void queue_recover_shards(storj_download_state_t *state)
+static void queue_stream_shards(storj_download_state_t *state)
 {
-    if (!state->recovering_shards && state->pointers_completed) {
-
-        int total_missing = 0;
-        bool has_missing = false;
-        bool is_ready = true;
+    if (state->writing || state->recovering_shards || state->canceled) {
+        return;
+    }
 
-        uint8_t *zilch = (uint8_t *)calloc(1, state->total_pointers);
+    if (state->stream_recovering) {
+        queue_stream_recover_shards(state);
+        return;
+    }
 
+    if (has_missing_data_shard(state)) {
+        // Shards that have already been written are needed again along
+        // with the parity shards to recover the missing data shard
         for (int i = 0; i < state->total_pointers; i++) {
             storj_pointer_t *pointer = &state->pointers[i];
-            if (pointer->status == POINTER_MISSING) {
-                total_missing += 1;
-                has_missing = true;
-                zilch[i] = 1;
-            }
-
-            if (pointer->status != POINTER_MISSING &&
-                pointer->status != POINTER_DOWNLOADED) {
-                is_ready = false;
-                state->log->debug(state->env->log_options,
-                                  state->handle,
-                                  "Pointer %i not ready with status: %i",
-                                  i, pointer->status);
-
+            if (pointer->status == POINTER_FINISHED) {
+                set_pointer_status(state, pointer, POINTER_CREATED);
+                state->completed_shards -= 1;
             }
         }
 
-        if (!is_ready) {
-            free(zilch);
-            return;
-        }
-
         state->log->info(state->env->log_options,
                          state->handle,
-                         "Queuing recovery of %i of %i shards",
-                         total_missing, state->total_shards);
+                         "Missing data shard, downloading all shards " \
+                         "for recovery");
 
-        file_request_recover_t *req = malloc(sizeof(file_request_recover_t));
-        if (!req) {
-            state->error_status = STORJ_MEMORY_ERROR;
+        state->stream_recovering = true;
+        queue_request_shards(state);
+        return;
+    }
+
+    // Skip shards that are not part of a range
+    while (state->stream_position < state->total_pointers &&
+           state->pointers[state->stream_position].status == POINTER_FINISHED) {
+        state->stream_position += 1;
+    }
+
+    if (state->stream_position < state->total_pointers &&
+        !state->pointers[state->stream_position].parity) {
+
+        storj_pointer_t *pointer = &state->pointers[state->stream_position];
+        if (pointer->status != POINTER_DOWNLOADED) {
             return;
         }
 
-        uv_work_t *work = malloc(sizeof(uv_work_t));
-        if (!work) {
+        // Only the part of the shard within a range is written
+        uint64_t shard_position = state->stream_position * state->shard_size;
+        uint64_t start = 0;
+        uint64_t end = pointer->size;
+        if (state->range_length) {
+            uint64_t range_end = state->range_offset + state->range_length;
+            if (state->range_offset > shard_position) {
+                start = state->range_offset - shard_position;
+            }
+            if (range_end < shard_position + end) {
+                end = range_end - shard_position;
+            }
+        }
+
+        shard_request_stream_t *req = malloc(sizeof(shard_request_stream_t));
+        if (!req) {
             state->error_status = STORJ_MEMORY_ERROR;
             return;
         }
 
-        req->fd = fileno(state->destination);
-        req->filesize = state->shard_size * state->total_pointers;
-        req->data_filesize = calculate_data_filesize(state);
-        req->data_shards = state->total_pointers - state->total_parity_pointers;
-        req->parity_shards = state->total_parity_pointers;
-        req->shard_size = state->shard_size;
-        req->zilch = zilch;
-        req->has_missing = has_missing;
+        req->shard_data = pointer->shard_data;
+        req->offset = start;
+        req->length = end - start;
+        req->pointer_index = state->stream_position;
+        req->byte_position = shard_position;
+        req->state = state;
 
         if (state->decrypt_key && state->decrypt_ctr) {
             req->decrypt_key = calloc(SHA256_DIGEST_SIZE, sizeof(uint8_t));
@@ -1731,28 +3211,40 @@ static void queue_recover_shards(storj_download_state_t *state)
             }
             memcpy(req->decrypt_key, state->decrypt_key, SHA256_DIGEST_SIZE);
             memcpy(req->decrypt_ctr, state->decrypt_ctr, AES_BLOCK_SIZE);
-
-            increment_ctr_aes_iv(req->decrypt_ctr, 0);
         } else {
             req->decrypt_key = NULL;
             req->decrypt_ctr = NULL;
         }
 
-        req->state = state;
-        req->error_status = 0;
-
+        uv_work_t *work = malloc(sizeof(uv_work_t));
+        if (!work) {
+            state->error_status = STORJ_MEMORY_ERROR;
+            return;
+        }
         work->data = req;
 
         state->pending_work_count++;
         int status = uv_queue_work(state->env->loop, (uv_work_t*) work,
-                                   recover_shards, after_recover_shards);
-
+                                   stream_shard, after_stream_shard);
         if (status) {
             state->error_status = STORJ_QUEUE_ERROR;
             return;
         }
 
-        state->recovering_shards = true;
+        state->writing = true;
+        return;
+    }
+
+    // All of the data has been written and the parity shards
+    // are not needed
+    if (state->pointers_completed) {
+        for (int i = state->stream_position; i < state->total_pointers; i++) {
+            storj_pointer_t *pointer = &state->pointers[i];
+            if (pointer->status != POINTER_FINISHED) {
+                set_pointer_status(state, pointer, POINTER_FINISHED);
+                state->completed_shards += 1;
+            }
+        }
     }
 }
 
@@ -1780,20 +3272,29 @@ static void queue_next_work(storj_download_state_t *state)
 
         if (!state->finished && state->pending_work_count == 0) {
 
-            // calculate the hmac of all shard hashes
-            if (prepare_file_hmac(state)) {
-                state->error_status = STORJ_FILE_GENERATE_HMAC_ERROR;
-            }
+            if (state->range_length) {
+                // the hmac is of all shard hashes, and only the
+                // pointers of the range have been requested
+                state->log->debug(state->env->log_options,
+                                  state->handle,
+                                  "Unable to verify decryption integrity" \
+                                  " of a range.");
+            } else {
+                // calculate the hmac of all shard hashes
+                if (prepare_file_hmac(state)) {
+                    state->error_status = STORJ_FILE_GENERATE_HMAC_ERROR;
+                }
 
-            if (state->info && state->info->hmac) {
-                if (0 != strcmp(state->info->hmac, state->hmac)) {
-                    state->error_status = STORJ_FILE_DECRYPTION_ERROR;
+                if (state->info && state->info->hmac) {
+                    if (0 != strcmp(state->info->hmac, state->hmac)) {
+                        state->error_status = STORJ_FILE_DECRYPTION_ERROR;
+                    }
+                } else {
+                    state->log->warn(state->env->log_options,
+                                     state->handle,
+                                     "Unable to verify decryption integrity" \
+                                     ", missing hmac from file info.");
                 }
-            } else {
-                state->log->warn(state->env->log_options,
-                                 state->handle,
-                                 "Unable to verify decryption integrity" \
-                                 ", missing hmac from file info.");
             }
 
             state->finished = true;
@@ -1814,10 +3315,15 @@ static void queue_next_work(storj_download_state_t *state)
 
     if (state->info) {
         queue_request_shards(state);
+        check_slow_shards(state);
 
         if (state->rs) {
             if (can_recover_shards(state)) {
-                queue_recover_shards(state);
+                if (state->stream) {
+                    queue_stream_shards(state);
+                } else {
+                    queue_recover_shards(state);
+                }
             } else {
                 state->error_status = STORJ_FILE_SHARD_MISSING_ERROR;
                 queue_next_work(state);
@@ -1825,7 +3331,11 @@ static void queue_next_work(storj_download_state_t *state)
             }
         } else {
             if (!has_missing_shard(state)) {
-                queue_recover_shards(state);
+                if (state->stream) {
+                    queue_stream_shards(state);
+                } else {
+                    queue_recover_shards(state);
+                }
             } else {
                 state->error_status = STORJ_FILE_SHARD_MISSING_ERROR;
                 queue_next_work(state);
@@ -1834,8 +3344,6 @@ static void queue_next_work(storj_download_state_t *state)
         }
     }
 
-    queue_send_exchange_reports(state);
-
 finish_up:
 
     state->log->debug(state->env->log_options, state->handle,
@@ -1852,26 +3360,27 @@ STORJ_API int storj_bridge_resolve_file_cancel(storj_download_state_t *state)
     state->canceled = true;
     state->error_status = STORJ_TRANSFER_CANCELED;
 
-    // loop over all pointers, and cancel any that are queued to be downloaded
-    // any downloads that are in-progress will monitor the state->canceled
+    // any downloads that are in-progress will monitor their canceled
     // status and exit when set to true
     for (int i = 0; i < state->total_pointers; i++) {
         storj_pointer_t *pointer = &state->pointers[i];
-        if (pointer->status == POINTER_BEING_DOWNLOADED) {
-            uv_cancel((uv_req_t *)pointer->work);
-        }
+        cancel_shard_request(pointer->work);
+        cancel_shard_request(pointer->hedge_work);
     }
 
     return 0;
 }
 
-STORJ_API storj_download_state_t *storj_bridge_resolve_file(storj_env_t *env,
-                                                            const char *bucket_id,
-                                                            const char *file_id,
-                                                            FILE *destination,
-                                                            void *handle,
-                                                            storj_progress_cb progress_cb,
-                                                            storj_finished_download_cb finished_cb)
+static storj_download_state_t *resolve_file(storj_env_t *env,
+                                            const char *bucket_id,
+                                            const char *file_id,
+                                            FILE *destination,
+                                            storj_write_cb write_cb,
+                                            uint64_t range_offset,
+                                            uint64_t range_length,
+                                            void *handle,
+                                            storj_progress_cb progress_cb,
+                                            storj_finished_download_cb finished_cb)
 {
     storj_download_state_t *state = malloc(sizeof(storj_download_state_t));
     if (!state) {
@@ -1887,13 +3396,32 @@ STORJ_API storj_download_state_t *storj_bridge_resolve_file(storj_env_t *env,
     state->file_id = file_id;
     state->bucket_id = bucket_id;
     state->destination = destination;
+    state->write_cb = write_cb;
+    state->stream = (write_cb != NULL);
+    state->stream_position = 0;
+    state->stream_recovering = false;
+    state->range_offset = range_offset;
+    state->range_length = range_length;
     state->progress_cb = progress_cb;
     state->finished_cb = finished_cb;
     state->finished = false;
     state->total_shards = 0;
-    state->download_max_concurrency = STORJ_DOWNLOAD_CONCURRENCY;
+    state->download_min_concurrency = STORJ_DOWNLOAD_MIN_CONCURRENCY;
+    state->download_max_concurrency = STORJ_DOWNLOAD_MAX_CONCURRENCY;
+    state->download_concurrency.limit = 0;
+    state->bandwidth_weight = 1;
+    state->decrypt_threads = default_thread_count();
+    state->decrypt_on_receive = true;
+    state->journal_path = NULL;
+    state->journal = NULL;
     state->completed_shards = 0;
     state->resolving_shards = 0;
+    state->fetching_parity = false;
+    state->hedge_limit = STORJ_HEDGE_LIMIT;
+    state->hedging_shards = 0;
+    state->hedge_checked = 0;
+    state->shard_rates = NULL;
+    state->total_shard_rates = 0;
     state->total_pointers = 0;
     state->total_parity_pointers = 0;
     state->rs = false;
@@ -1903,10 +3431,16 @@ STORJ_API storj_download_state_t *storj_bridge_resolve_file(storj_env_t *env,
     state->pointers_completed = false;
     state->pointer_fail_count = 0;
     state->requesting_pointers = false;
+    state->pointer_page_size = 0;
+    state->pointers_end = UINT32_MAX;
+    state->missing_pointers = 0;
+    state->missing_data_pointers = 0;
+    state->downloaded_pointers = 0;
+    state->created_pointers = (storj_index_queue_t){NULL, 0, 0};
+    state->reported_pointers = (storj_index_queue_t){NULL, 0, 0};
     state->error_status = STORJ_TRANSFER_OK;
     state->writing = false;
     state->shard_size = 0;
-    state->excluded_farmer_ids = NULL;
     state->hmac = NULL;
     state->pending_work_count = 0;
     state->canceled = false;
@@ -1915,8 +3449,61 @@ STORJ_API storj_download_state_t *storj_bridge_resolve_file(storj_env_t *env,
     state->decrypt_key = NULL;
     state->decrypt_ctr = NULL;
 
+    state->pointer_pages = calloc(env->bridge_options->pointer_page_requests,
+                                  sizeof(storj_pointer_page_t));
+    if (!state->pointer_pages) {
+        free(state);
+        return NULL;
+    }
+
     // start download
     queue_next_work(state);
 
     return state;
 }
+
+STORJ_API storj_download_state_t *storj_bridge_resolve_file(storj_env_t *env,
+                                                            const char *bucket_id,
+                                                            const char *file_id,
+                                                            FILE *destination,
+                                                            void *handle,
+                                                            storj_progress_cb progress_cb,
+                                                            storj_finished_download_cb finished_cb)
+{
+    return resolve_file(env, bucket_id, file_id, destination, NULL, 0, 0,
+                        handle, progress_cb, finished_cb);
+}
+
+STORJ_API storj_download_state_t *storj_bridge_resolve_file_stream(storj_env_t *env,
+                                                                   const char *bucket_id,
+                                                                   const char *file_id,
+                                                                   void *handle,
+                                                                   storj_write_cb write_cb,
+                                                                   storj_progress_cb progress_cb,
+                                                                   storj_finished_download_cb finished_cb)
+{
+    if (!write_cb) {
+        return NULL;
+    }
+
+    return resolve_file(env, bucket_id, file_id, NULL, write_cb, 0, 0,
+                        handle, progress_cb, finished_cb);
+}
+
+STORJ_API storj_download_state_t *storj_bridge_resolve_file_range(storj_env_t *env,
+                                                                  const char *bucket_id,
+                                                                  const char *file_id,
+                                                                  uint64_t offset,
+                                                                  uint64_t length,
+                                                                  void *handle,
+                                                                  storj_write_cb write_cb,
+                                                                  storj_progress_cb progress_cb,
+                                                                  storj_finished_download_cb finished_cb)
+{
+    if (!write_cb || !length) {
+        return NULL;
+    }
+
+    return resolve_file(env, bucket_id, file_id, NULL, write_cb, offset,
+                        length, handle, progress_cb, finished_cb);
+}
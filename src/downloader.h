@@ -12,14 +12,28 @@
 #include "utils.h"
 #include "crypto.h"
 #include "rs.h"
+#include "journal.h"
+#include "farmers.h"
+#include "reports.h"
 
 #define STORJ_DOWNLOAD_CONCURRENCY 24
+#define STORJ_DOWNLOAD_MIN_CONCURRENCY 4
+#define STORJ_DOWNLOAD_MAX_CONCURRENCY 128
 #define STORJ_DOWNLOAD_WRITESYNC_CONCURRENCY 4
+#define STORJ_DOWNLOAD_STREAM_WINDOW 4
+#define STORJ_DECRYPT_CHUNK_SIZE 1048576 // 1Mb
+#define STORJ_MIN_DECRYPT_RANGE 16777216 // 16Mb
+#define STORJ_DECRYPT_PROGRESS_SIZE 67108864 // 64Mb
 #define STORJ_DEFAULT_MIRRORS 5
-#define STORJ_MAX_REPORT_TRIES 2
 #define STORJ_MAX_TOKEN_TRIES 6
 #define STORJ_MAX_POINTER_TRIES 6
 #define STORJ_MAX_INFO_TRIES 6
+#define STORJ_HEDGE_LIMIT 4
+#define STORJ_HEDGE_MIN_TIME 2000 // 2 seconds
+#define STORJ_HEDGE_CHECK_INTERVAL 250
+#define STORJ_HEDGE_RATE_RATIO 2
+#define STORJ_HEDGE_RATE_SAMPLES 32
+#define STORJ_HEDGE_MIN_SAMPLES 3
 
 /** @brief Enumerable that defines that status of a pointer
  *
@@ -64,11 +78,58 @@ typedef struct {
     uint8_t *decrypt_ctr;
     uint8_t *zilch;
     bool has_missing;
+    // data shards were decrypted as they were received
+    bool decrypted_data;
+    int decrypt_threads;
+    // bytes decrypted so far, updated by the decrypting threads
+    uint64_t decrypted_bytes;
+    uv_mutex_t progress_lock;
+    uv_async_t progress_handle;
+    bool reported_progress;
     /* state should not be modified in worker threads */
     storj_download_state_t *state;
     int error_status;
 } file_request_recover_t;
 
+/** @brief A range of the file decrypted by one thread after recovery */
+typedef struct {
+    uint8_t *data;
+    uint64_t offset;
+    uint64_t length;
+    bool report_progress;
+    file_request_recover_t *req;
+} decrypt_range_job_t;
+
+/** @brief A structure for decrypting a shard of a streamed download
+ * before it is given to the write callback.
+ */
+typedef struct {
+    uint8_t *shard_data;
+    uint64_t offset;
+    uint64_t length;
+    uint32_t pointer_index;
+    uint64_t byte_position;
+    uint8_t *decrypt_key;
+    uint8_t *decrypt_ctr;
+    /* state should not be modified in worker threads */
+    storj_download_state_t *state;
+} shard_request_stream_t;
+
+/** @brief A structure for repairing shards of a streamed download in memory
+ */
+typedef struct {
+    uint8_t **data_blocks;
+    uint8_t **fec_blocks;
+    uint64_t data_filesize;
+    uint32_t data_shards;
+    uint32_t parity_shards;
+    uint64_t shard_size;
+    uint8_t *zilch;
+    /* state should not be modified in worker threads */
+    storj_download_state_t *state;
+    int error_status;
+} stream_request_recover_t;
+
 /** @brief A structure for sharing data with worker threads for downloading
  * shards from farmers.
  */
@@ -86,24 +147,28 @@ typedef struct {
     uint64_t shard_total_bytes;
     uv_async_t progress_handle;
     uint64_t byte_position;
+    uint8_t *shard_data;
+    bool decrypt_on_receive;
     /* state should not be modified in worker threads */
     storj_download_state_t *state;
     int error_status;
-    bool *canceled;
+    bool canceled;
+    // a second download of a slow shard, from another farmer
+    bool hedge;
 } shard_request_download_t;
 
-/** @brief A structure for sharing data with worker threads for sending
- * exchange reports to the bridge.
+/** @brief A structure for writing a hedged shard that was received into
+ * memory to the file.
  */
 typedef struct {
+    uv_fs_t req;
+    uint8_t *shard_data;
+    uint64_t length;
+    uint64_t written;
+    uint64_t file_position;
     uint32_t pointer_index;
-    storj_http_options_t *http_options;
-    storj_bridge_options_t *options;
-    int status_code;
-    storj_exchange_report_t *report;
-    /* state should not be modified in worker threads */
     storj_download_state_t *state;
-} shard_send_report_t;
+} shard_write_hedge_t;
 
 typedef struct {
     storj_http_options_t *http_options;
@@ -145,6 +210,7 @@ typedef struct {
     bool auth;
     struct json_object *body;
     struct json_object *response;
+    storj_pointer_page_t *page;
     /* state should not be modified in worker threads */
     storj_download_state_t *state;
     int status_code;
@@ -159,5 +225,8 @@ typedef struct {
  * This method should only be called with in the main loop thread.
  */
 static void queue_next_work(storj_download_state_t *state);
+static void after_request_shard(uv_work_t *work, int status);
+static void after_hedge_shard(uv_work_t *work);
+static void queue_request_shards(storj_download_state_t *state);
 
 #endif /* STORJ_DOWNLOADER_H */
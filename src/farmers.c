@@ -0,0 +1,217 @@
+#include "farmers.h"
+
+storj_farmer_table_t *farmer_table_new()
+{
+    return calloc(1, sizeof(storj_farmer_table_t));
+}
+
+storj_farmer_stats_t *farmer_table_find(storj_farmer_table_t *table,
+                                        const char *node_id)
+{
+    if (!node_id) {
+        return NULL;
+    }
+
+    for (uint32_t i = 0; i < table->length; i++) {
+        if (0 == strcmp(table->farmers[i].node_id, node_id)) {
+            return &table->farmers[i];
+        }
+    }
+
+    return NULL;
+}
+
+static storj_farmer_stats_t *add_farmer(storj_farmer_table_t *table,
+                                        const char *node_id)
+{
+    if (table->length == table->size) {
+        uint32_t size = (table->size > 0) ? table->size * 2 : 16;
+        storj_farmer_stats_t *farmers =
+            realloc(table->farmers, size * sizeof(storj_farmer_stats_t));
+        if (!farmers) {
+            return NULL;
+        }
+        table->farmers = farmers;
+        table->size = size;
+    }
+
+    storj_farmer_stats_t *farmer = &table->farmers[table->length];
+    memset(farmer, 0, sizeof(storj_farmer_stats_t));
+
+    farmer->node_id = strdup(node_id);
+    if (!farmer->node_id) {
+        return NULL;
+    }
+
+    table->length += 1;
+
+    return farmer;
+}
+
+static uint32_t moving_average(uint32_t average, uint32_t sample)
+{
+    return average - average / STORJ_FARMER_EWMA_WEIGHT +
+        sample / STORJ_FARMER_EWMA_WEIGHT;
+}
+
+int farmer_table_add_report(storj_farmer_table_t *table,
+                            storj_exchange_report_t *report)
+{
+    if (!report->farmer_id) {
+        return 0;
+    }
+
+    storj_farmer_stats_t *farmer = farmer_table_find(table, report->farmer_id);
+    if (!farmer) {
+        farmer = add_farmer(table, report->farmer_id);
+        if (!farmer) {
+            return STORJ_MEMORY_ERROR;
+        }
+    }
+
+    bool success = (report->code == STORJ_REPORT_SUCCESS);
+
+    if (success) {
+        farmer->failures = 0;
+    } else {
+        farmer->failures += 1;
+        farmer->last_failure = (report->end > 0) ?
+            report->end : get_time_milliseconds();
+    }
+
+    uint32_t error = success ? 0 : 1000;
+    farmer->error_rate = (farmer->transfers > 0) ?
+        moving_average(farmer->error_rate, error) : error;
+    farmer->transfers += 1;
+
+    return 0;
+}
+
+static bool is_excluded(storj_farmer_stats_t *farmer, uint64_t now)
+{
+    if (farmer->failures == 0) {
+        return false;
+    }
+
+    uint32_t doublings = farmer->failures - 1;
+    if (doublings > STORJ_FARMER_MAX_EXCLUDE_DOUBLINGS) {
+        doublings = STORJ_FARMER_MAX_EXCLUDE_DOUBLINGS;
+    }
+
+    return now < farmer->last_failure +
+        ((uint64_t)STORJ_FARMER_EXCLUDE_TIME << doublings);
+}
+
+bool farmer_table_is_bad(storj_farmer_table_t *table, const char *node_id,
+                         uint64_t now)
+{
+    storj_farmer_stats_t *farmer = farmer_table_find(table, node_id);
+    if (!farmer) {
+        return false;
+    }
+
+    return farmer->failures >= STORJ_FARMER_BAD_FAILURES &&
+        is_excluded(farmer, now);
+}
+
+static int compare_error_rates(const void *a, const void *b)
+{
+    const storj_farmer_stats_t *farmer_a = *(storj_farmer_stats_t **)a;
+    const storj_farmer_stats_t *farmer_b = *(storj_farmer_stats_t **)b;
+
+    if (farmer_a->error_rate != farmer_b->error_rate) {
+        return (farmer_a->error_rate > farmer_b->error_rate) ? -1 : 1;
+    }
+
+    if (farmer_a->last_failure != farmer_b->last_failure) {
+        return (farmer_a->last_failure > farmer_b->last_failure) ? -1 : 1;
+    }
+
+    return 0;
+}
+
+int farmer_table_exclude_list(storj_farmer_table_t *table,
+                              const char *node_id, uint64_t now,
+                              char **list)
+{
+    *list = NULL;
+
+    storj_farmer_stats_t **excluded = NULL;
+    uint32_t total_excluded = 0;
+
+    if (table->length > 0) {
+        excluded = malloc(table->length * sizeof(storj_farmer_stats_t *));
+        if (!excluded) {
+            return STORJ_MEMORY_ERROR;
+        }
+    }
+
+    for (uint32_t i = 0; i < table->length; i++) {
+        if (is_excluded(&table->farmers[i], now)) {
+            excluded[total_excluded] = &table->farmers[i];
+            total_excluded += 1;
+        }
+    }
+
+    if (total_excluded > 1) {
+        qsort(excluded, total_excluded, sizeof(storj_farmer_stats_t *),
+              compare_error_rates);
+    }
+
+    if (total_excluded > STORJ_FARMER_EXCLUDE_LIMIT) {
+        total_excluded = STORJ_FARMER_EXCLUDE_LIMIT;
+    }
+
+    size_t length = (node_id) ? strlen(node_id) + 1 : 0;
+    for (uint32_t i = 0; i < total_excluded; i++) {
+        length += strlen(excluded[i]->node_id) + 1;
+    }
+
+    if (length == 0) {
+        free(excluded);
+        return 0;
+    }
+
+    char *ids = calloc(length, sizeof(char));
+    if (!ids) {
+        free(excluded);
+        return STORJ_MEMORY_ERROR;
+    }
+
+    for (uint32_t i = 0; i < total_excluded; i++) {
+        if (node_id && 0 == strcmp(excluded[i]->node_id, node_id)) {
+            continue;
+        }
+        if (ids[0]) {
+            strcat(ids, ",");
+        }
+        strcat(ids, excluded[i]->node_id);
+    }
+
+    if (node_id) {
+        if (ids[0]) {
+            strcat(ids, ",");
+        }
+        strcat(ids, node_id);
+    }
+
+    free(excluded);
+
+    *list = ids;
+
+    return 0;
+}
+
+void farmer_table_destroy(storj_farmer_table_t *table)
+{
+    if (!table) {
+        return;
+    }
+
+    for (uint32_t i = 0; i < table->length; i++) {
+        free(table->farmers[i].node_id);
+    }
+
+    free(table->farmers);
+    free(table);
+}
@@ -0,0 +1,109 @@
+/**
+ * @file farmers.h
+ * @brief Storj farmer scoreboard.
+ *
+ * The outcomes of the shard transfers of an environment are kept for each
+ * farmer, so that farmers that have recently failed are excluded from the
+ * pointers requested by later transfers as well.
+ */
+#ifndef STORJ_FARMERS_H
+#define STORJ_FARMERS_H
+
+#include "storj.h"
+#include "utils.h"
+
+#define STORJ_FARMER_EWMA_WEIGHT 4
+#define STORJ_FARMER_EXCLUDE_TIME 60000 // 1 minute
+#define STORJ_FARMER_MAX_EXCLUDE_DOUBLINGS 5
+#define STORJ_FARMER_BAD_FAILURES 3
+#define STORJ_FARMER_EXCLUDE_LIMIT 64
+
+/** @brief The transfer outcomes of a farmer
+ *
+ * The error rate is a moving average of the failed transfers per thousand
+ * transfers.
+ */
+typedef struct {
+    char *node_id;
+    uint32_t error_rate;
+    uint32_t failures;
+    uint64_t last_failure;
+    uint32_t transfers;
+} storj_farmer_stats_t;
+
+/** @brief The farmers of an environment
+ *
+ * A farmer is excluded for a minute after a failed transfer, doubled for
+ * each failure since its last successful transfer, and is known to be bad
+ * while excluded after several failures in a row. The table is only used
+ * from the event loop thread.
+ */
+typedef struct storj_farmer_table {
+    storj_farmer_stats_t *farmers;
+    uint32_t length;
+    uint32_t size;
+} storj_farmer_table_t;
+
+/**
+ * @brief Create an empty farmer table
+ *
+ * @return A null value on error, otherwise the table.
+ */
+storj_farmer_table_t *farmer_table_new();
+
+/**
+ * @brief Find the outcomes of a farmer
+ *
+ * @param[in] table The farmer table
+ * @param[in] node_id The node id of the farmer
+ * @return The outcomes or NULL if the farmer isn't in the table.
+ */
+storj_farmer_stats_t *farmer_table_find(storj_farmer_table_t *table,
+                                        const char *node_id);
+
+/**
+ * @brief Add the outcome of an exchange report to its farmer
+ *
+ * @param[in] table The farmer table
+ * @param[in] report The exchange report of a finished transfer
+ * @return A non-zero error value on failure and 0 on success.
+ */
+int farmer_table_add_report(storj_farmer_table_t *table,
+                            storj_exchange_report_t *report);
+
+/**
+ * @brief Check if a farmer has failed several times in a row recently
+ *
+ * @param[in] table The farmer table
+ * @param[in] node_id The node id of the farmer
+ * @param[in] now The current time in milliseconds
+ * @return True if transfers with the farmer should not be tried
+ */
+bool farmer_table_is_bad(storj_farmer_table_t *table, const char *node_id,
+                         uint64_t now);
+
+/**
+ * @brief Get the farmers to exclude from requested pointers
+ *
+ * The list is ordered by error rate, highest first, and is limited to
+ * STORJ_FARMER_EXCLUDE_LIMIT farmers.
+ *
+ * @param[in] table The farmer table
+ * @param[in] node_id A farmer to also exclude, or NULL
+ * @param[in] now The current time in milliseconds
+ * @param[out] list A comma separated list of node ids that must be freed,
+ * or NULL if there are no farmers to exclude
+ * @return A non-zero error value on failure and 0 on success.
+ */
+int farmer_table_exclude_list(storj_farmer_table_t *table,
+                              const char *node_id, uint64_t now,
+                              char **list);
+
+/**
+ * @brief Free a farmer table
+ *
+ * @param[in] table The farmer table
+ */
+void farmer_table_destroy(storj_farmer_table_t *table);
+
+#endif /* STORJ_FARMERS_H */
@@ -1,4 +1,893 @@
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
 #include "http.h"
+#include <fcntl.h>
+
+static void http_share_lock(CURL *handle, curl_lock_data data,
+                            curl_lock_access access, void *userptr)
+{
+    storj_http_pool_t *pool = userptr;
+    uv_mutex_lock(&pool->share_locks[data]);
+}
+
+static void http_share_unlock(CURL *handle, curl_lock_data data,
+                              void *userptr)
+{
+    storj_http_pool_t *pool = userptr;
+    uv_mutex_unlock(&pool->share_locks[data]);
+}
+
+static char *http_pool_key(const char *proto, const char *host, int port)
+{
+    int key_len = strlen(proto) + 3 + strlen(host) + 1 + 10;
+    char *key = calloc(key_len + 1, sizeof(char));
+    if (!key) {
+        return NULL;
+    }
+
+    snprintf(key, key_len, "%s://%s:%i", proto, host, port);
+
+    return key;
+}
+
+storj_http_pool_t *http_pool_new(uint32_t max_idle)
+{
+    storj_http_pool_t *pool = malloc(sizeof(storj_http_pool_t));
+    if (!pool) {
+        return NULL;
+    }
+
+    pool->idle = calloc(max_idle + 1, sizeof(http_pool_handle_t));
+    if (!pool->idle) {
+        free(pool);
+        return NULL;
+    }
+    pool->idle_count = 0;
+    pool->max_idle = max_idle;
+
+    uv_mutex_init(&pool->lock);
+    for (int i = 0; i < CURL_LOCK_DATA_LAST; i++) {
+        uv_mutex_init(&pool->share_locks[i]);
+    }
+
+    // Share the dns cache and tls sessions between all of the handles, a
+    // missing share only disables the caching. Connections are kept by the
+    // pooled handles instead, curl can't share a connection cache between
+    // handles that run on different threads at the same time.
+    pool->share = curl_share_init();
+    if (pool->share) {
+        curl_share_setopt(pool->share, CURLSHOPT_LOCKFUNC, http_share_lock);
+        curl_share_setopt(pool->share, CURLSHOPT_UNLOCKFUNC,
+                          http_share_unlock);
+        curl_share_setopt(pool->share, CURLSHOPT_USERDATA, pool);
+        curl_share_setopt(pool->share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+        curl_share_setopt(pool->share, CURLSHOPT_SHARE,
+                          CURL_LOCK_DATA_SSL_SESSION);
+    }
+
+    return pool;
+}
+
+void http_pool_destroy(storj_http_pool_t *pool)
+{
+    if (!pool) {
+        return;
+    }
+
+    for (int i = 0; i < pool->idle_count; i++) {
+        curl_easy_cleanup(pool->idle[i].curl);
+        free(pool->idle[i].key);
+    }
+    free(pool->idle);
+
+    // The share can only be cleaned up once no handle is using it
+    if (pool->share) {
+        curl_share_cleanup(pool->share);
+    }
+
+    uv_mutex_destroy(&pool->lock);
+    for (int i = 0; i < CURL_LOCK_DATA_LAST; i++) {
+        uv_mutex_destroy(&pool->share_locks[i]);
+    }
+
+    free(pool);
+}
+
+CURL *http_pool_acquire(storj_http_options_t *http_options,
+                        const char *proto,
+                        const char *host,
+                        int port)
+{
+    storj_http_pool_t *pool = http_options->pool;
+    if (!pool) {
+        return curl_easy_init();
+    }
+
+    char *key = http_pool_key(proto, host, port);
+    if (!key) {
+        return NULL;
+    }
+
+    CURL *curl = NULL;
+
+    uv_mutex_lock(&pool->lock);
+
+    // Take the most recently used handle for the host
+    for (int i = pool->idle_count - 1; i >= 0; i--) {
+        if (0 == strcmp(pool->idle[i].key, key)) {
+            curl = pool->idle[i].curl;
+            free(pool->idle[i].key);
+            memmove(&pool->idle[i], &pool->idle[i + 1],
+                    (pool->idle_count - i - 1) * sizeof(http_pool_handle_t));
+            pool->idle_count -= 1;
+            break;
+        }
+    }
+
+    uv_mutex_unlock(&pool->lock);
+
+    free(key);
+
+    if (!curl) {
+        curl = curl_easy_init();
+        if (!curl) {
+            return NULL;
+        }
+    }
+
+    if (pool->share) {
+        curl_easy_setopt(curl, CURLOPT_SHARE, pool->share);
+    }
+
+    // Keep idle connections from being dropped between requests
+    curl_easy_setopt(curl, CURLOPT_TCP_KEEPALIVE, 1L);
+
+    return curl;
+}
+
+void http_pool_release(storj_http_options_t *http_options,
+                       CURL *curl,
+                       const char *proto,
+                       const char *host,
+                       int port)
+{
+    storj_http_pool_t *pool = http_options->pool;
+    if (!pool || pool->max_idle == 0) {
+        curl_easy_cleanup(curl);
+        return;
+    }
+
+    char *key = http_pool_key(proto, host, port);
+    if (!key) {
+        curl_easy_cleanup(curl);
+        return;
+    }
+
+    // Clear the options of the finished request, open connections and
+    // caches are kept by the handle
+    curl_easy_reset(curl);
+
+    CURL *evicted = NULL;
+    char *evicted_key = NULL;
+
+    uv_mutex_lock(&pool->lock);
+
+    // Close the least recently used handle when the pool is full
+    if (pool->idle_count >= pool->max_idle) {
+        evicted = pool->idle[0].curl;
+        evicted_key = pool->idle[0].key;
+        memmove(&pool->idle[0], &pool->idle[1],
+                (pool->idle_count - 1) * sizeof(http_pool_handle_t));
+        pool->idle_count -= 1;
+    }
+
+    pool->idle[pool->idle_count].curl = curl;
+    pool->idle[pool->idle_count].key = key;
+    pool->idle_count += 1;
+
+    uv_mutex_unlock(&pool->lock);
+
+    if (evicted) {
+        curl_easy_cleanup(evicted);
+        free(evicted_key);
+    }
+}
+
+static void free_http_socket(uv_handle_t *poll_handle)
+{
+    free(poll_handle->data);
+}
+
+static void free_http_timer(uv_handle_t *timer)
+{
+    free(timer);
+}
+
+static uint8_t *transfer_buffer_acquire(storj_http_multi_t *multi)
+{
+    if (multi->transfer_buffer_count > 0) {
+        multi->transfer_buffer_count--;
+        return multi->transfer_buffers[multi->transfer_buffer_count];
+    }
+
+    size_t size = multi->http_options->transfer_buffer_size;
+    uint8_t *buffer = NULL;
+
+#ifdef HAVE_ALIGNED_ALLOC
+    buffer = aligned_alloc(TRANSFER_BUFFER_ALIGNMENT, size);
+#elif HAVE_POSIX_MEMALIGN
+    if (posix_memalign((void *)&buffer, TRANSFER_BUFFER_ALIGNMENT, size)) {
+        return NULL;
+    }
+#else
+    buffer = malloc(size);
+#endif
+
+    return buffer;
+}
+
+static void transfer_buffer_release(storj_http_multi_t *multi,
+                                   uint8_t *buffer)
+{
+    if (multi->transfer_buffer_count <
+        multi->http_options->max_idle_connections * 2) {
+        multi->transfer_buffers[multi->transfer_buffer_count] = buffer;
+        multi->transfer_buffer_count++;
+    } else {
+        free(buffer);
+    }
+}
+
+static void shard_transfer_free(shard_transfer_t *transfer)
+{
+    if (transfer->curl) {
+        http_pool_release(transfer->multi->http_options, transfer->curl,
+                          transfer->proto, transfer->host, transfer->port);
+    }
+    if (transfer->headers) {
+        curl_slist_free_all(transfer->headers);
+    }
+    if (transfer->send_body) {
+        shard_body_send_t *body = transfer->send_body;
+        // clear any unencrypted data before the buffers are reused
+        size_t buffer_size = transfer->multi->http_options->transfer_buffer_size;
+        if (body->buffer) {
+            if (body->ctx) {
+                memset_zero(body->buffer, buffer_size);
+            }
+            transfer_buffer_release(transfer->multi, body->buffer);
+        }
+        if (body->read_buffer) {
+            if (body->ctx) {
+                memset_zero(body->read_buffer, buffer_size);
+            }
+            transfer_buffer_release(transfer->multi, body->read_buffer);
+        }
+        free(body);
+    }
+    if (transfer->receive_body) {
+        shard_body_receive_t *body = transfer->receive_body;
+        // shards in memory are received directly into the shard data
+        if (body->buffer && !body->shard_data) {
+            transfer_buffer_release(transfer->multi, body->buffer);
+        }
+        if (body->write_buffer) {
+            transfer_buffer_release(transfer->multi, body->write_buffer);
+        }
+        if (body->direct_fd >= 0) {
+            close(body->direct_fd);
+        }
+        free(transfer->receive_body->sha256_ctx);
+        if (transfer->receive_body->decrypt_ctx) {
+            memset_zero(transfer->receive_body->decrypt_ctx,
+                        sizeof(struct aes256_ctx));
+            free(transfer->receive_body->decrypt_ctx);
+        }
+        free(transfer->receive_body);
+    }
+    free(transfer->url);
+    free(transfer->proto);
+    free(transfer->host);
+    free(transfer);
+}
+
+static bool shard_transfer_io_pending(shard_transfer_t *transfer)
+{
+    return (transfer->send_body && transfer->send_body->reading) ||
+        (transfer->receive_body && transfer->receive_body->writing);
+}
+
+static void shard_transfer_done(shard_transfer_t *transfer, CURLcode result)
+{
+    transfer->completed = true;
+    transfer->result = result;
+
+    // Buffers can't be released while the file is being read or written,
+    // the transfer is finished once the last of it has completed
+    if (shard_transfer_io_pending(transfer)) {
+        return;
+    }
+
+    transfer->finish(transfer, result);
+
+    // Give the connection back before the next transfer is queued
+    http_pool_release(transfer->multi->http_options, transfer->curl,
+                      transfer->proto, transfer->host, transfer->port);
+    transfer->curl = NULL;
+
+    transfer->cb(transfer->error_status,
+                 transfer->status_code,
+                 transfer->io_code,
+                 transfer->handle);
+
+    shard_transfer_free(transfer);
+}
+
+static void shard_transfer_remove(shard_transfer_t *transfer,
+                                  CURLcode result)
+{
+    storj_http_multi_t *multi = transfer->multi;
+
+    curl_multi_remove_handle(multi->multi, transfer->curl);
+
+    if (transfer->prev) {
+        transfer->prev->next = transfer->next;
+    } else {
+        multi->transfers = transfer->next;
+    }
+    if (transfer->next) {
+        transfer->next->prev = transfer->prev;
+    }
+
+    multi->running -= 1;
+    if (multi->running == 0) {
+        // Let the loop exit once there are no more transfers
+        uv_unref((uv_handle_t *)multi->timer);
+    }
+
+    shard_transfer_done(transfer, result);
+}
+
+static void http_multi_check_info(storj_http_multi_t *multi)
+{
+    CURLMsg *msg = NULL;
+    int pending = 0;
+
+    while ((msg = curl_multi_info_read(multi->multi, &pending))) {
+        if (msg->msg != CURLMSG_DONE) {
+            continue;
+        }
+
+        CURL *curl = msg->easy_handle;
+        CURLcode result = msg->data.result;
+
+        shard_transfer_t *transfer = NULL;
+        curl_easy_getinfo(curl, CURLINFO_PRIVATE, (char **)&transfer);
+
+        shard_transfer_remove(transfer, result);
+    }
+}
+
+/* Continue a transfer that was paused to wait on the file */
+static void shard_transfer_resume(shard_transfer_t *transfer, bool failed)
+{
+    // An error returned by a callback while resuming isn't reported by
+    // the multi handle, so a failed transfer is removed instead
+    if (failed || *transfer->canceled ||
+        curl_easy_pause(transfer->curl, CURLPAUSE_CONT) != CURLE_OK) {
+        shard_transfer_remove(transfer, CURLE_ABORTED_BY_CALLBACK);
+    }
+}
+
+static void http_multi_poll(uv_poll_t *poll_handle, int status, int events)
+{
+    http_socket_t *socket = poll_handle->data;
+    storj_http_multi_t *multi = socket->multi;
+
+    int flags = 0;
+    if (status < 0) {
+        flags = CURL_CSELECT_ERR;
+    }
+    if (events & UV_READABLE) {
+        flags |= CURL_CSELECT_IN;
+    }
+    if (events & UV_WRITABLE) {
+        flags |= CURL_CSELECT_OUT;
+    }
+
+    int running = 0;
+    curl_multi_socket_action(multi->multi, socket->sockfd, flags, &running);
+
+    http_multi_check_info(multi);
+}
+
+static void http_multi_timeout(uv_timer_t *timer)
+{
+    storj_http_multi_t *multi = timer->data;
+
+    int running = 0;
+    curl_multi_socket_action(multi->multi, CURL_SOCKET_TIMEOUT, 0, &running);
+
+    http_multi_check_info(multi);
+}
+
+static shard_transfer_t *find_canceled_transfer(storj_http_multi_t *multi)
+{
+    for (shard_transfer_t *transfer = multi->transfers; transfer;
+         transfer = transfer->next) {
+        if (*transfer->canceled) {
+            return transfer;
+        }
+    }
+
+    return NULL;
+}
+
+static void http_multi_cancel(uv_timer_t *timer)
+{
+    storj_http_multi_t *multi = timer->data;
+
+    // The callback of a removed transfer may cancel other transfers, the
+    // list is searched again after each one
+    shard_transfer_t *transfer = NULL;
+    while ((transfer = find_canceled_transfer(multi))) {
+        shard_transfer_remove(transfer, CURLE_ABORTED_BY_CALLBACK);
+    }
+}
+
+void http_multi_cancel_transfers(storj_http_multi_t *multi)
+{
+    uv_timer_start(multi->cancel_timer, http_multi_cancel, 0, 0);
+}
+
+static uint64_t http_multi_rate_limit(storj_http_multi_t *multi, bool upload)
+{
+    uv_mutex_lock(&multi->rate_lock);
+    uint64_t rate = (upload) ? multi->http_options->upload_rate_limit :
+        multi->http_options->download_rate_limit;
+    uv_mutex_unlock(&multi->rate_lock);
+
+    return rate;
+}
+
+void http_multi_set_rate_limits(storj_http_multi_t *multi,
+                                uint64_t upload_rate_limit,
+                                uint64_t download_rate_limit)
+{
+    uv_mutex_lock(&multi->rate_lock);
+    multi->http_options->upload_rate_limit = upload_rate_limit;
+    multi->http_options->download_rate_limit = download_rate_limit;
+    uv_mutex_unlock(&multi->rate_lock);
+}
+
+static uint64_t shard_transfer_rate_limit(shard_transfer_t *transfer)
+{
+    return http_multi_rate_limit(transfer->multi, transfer->send_body != NULL);
+}
+
+static uint64_t *shard_transfer_tokens(shard_transfer_t *transfer)
+{
+    if (transfer->send_body) {
+        return &transfer->multi->upload_tokens;
+    }
+
+    return &transfer->multi->download_tokens;
+}
+
+static void refill_tokens(uint64_t *tokens, uint64_t rate, uint64_t elapsed)
+{
+    uint64_t burst = rate * SHARD_BANDWIDTH_BURST / 1000;
+
+    *tokens += rate * elapsed / 1000;
+    if (*tokens > burst) {
+        *tokens = burst;
+    }
+}
+
+static void http_multi_refill(storj_http_multi_t *multi)
+{
+    uint64_t now = uv_now(multi->loop);
+    if (now == multi->bandwidth_time) {
+        return;
+    }
+
+    uint64_t elapsed = now - multi->bandwidth_time;
+    multi->bandwidth_time = now;
+
+    refill_tokens(&multi->upload_tokens,
+                  http_multi_rate_limit(multi, true), elapsed);
+    refill_tokens(&multi->download_tokens,
+                  http_multi_rate_limit(multi, false), elapsed);
+}
+
+// Give each paused transfer of a direction its share of the bucket, the
+// transfers that have been given bandwidth are resumed
+static void share_bandwidth(storj_http_multi_t *multi, bool upload)
+{
+    uint64_t rate = http_multi_rate_limit(multi, upload);
+    uint64_t *tokens = (upload) ? &multi->upload_tokens :
+        &multi->download_tokens;
+
+    uint64_t total_weight = 0;
+    for (shard_transfer_t *transfer = multi->transfers; transfer;
+         transfer = transfer->next) {
+        if (transfer->throttled && (transfer->send_body != NULL) == upload) {
+            total_weight += transfer->weight;
+        }
+    }
+
+    if (total_weight == 0) {
+        return;
+    }
+
+    uint64_t available = *tokens;
+
+    for (shard_transfer_t *transfer = multi->transfers; transfer;
+         transfer = transfer->next) {
+        if (!transfer->throttled || (transfer->send_body != NULL) != upload) {
+            continue;
+        }
+
+        // the limit has been removed
+        if (rate == 0) {
+            transfer->allowance = 0;
+            transfer->throttle_resume = true;
+            continue;
+        }
+
+        uint64_t share = available * transfer->weight / total_weight;
+        *tokens -= share;
+        transfer->allowance += share;
+
+        if (transfer->allowance > 0) {
+            transfer->throttle_resume = true;
+        }
+    }
+}
+
+static shard_transfer_t *find_resumed_transfer(storj_http_multi_t *multi)
+{
+    for (shard_transfer_t *transfer = multi->transfers; transfer;
+         transfer = transfer->next) {
+        if (transfer->throttle_resume) {
+            return transfer;
+        }
+    }
+
+    return NULL;
+}
+
+static void http_multi_bandwidth(uv_timer_t *timer)
+{
+    storj_http_multi_t *multi = timer->data;
+
+    http_multi_refill(multi);
+
+    share_bandwidth(multi, true);
+    share_bandwidth(multi, false);
+
+    // A resumed transfer may finish and its callback start or cancel other
+    // transfers, the list is searched again after each one
+    shard_transfer_t *transfer = NULL;
+    while ((transfer = find_resumed_transfer(multi))) {
+        transfer->throttle_resume = false;
+        transfer->throttled = false;
+        shard_transfer_resume(transfer, false);
+    }
+
+    for (transfer = multi->transfers; transfer; transfer = transfer->next) {
+        if (transfer->throttled) {
+            return;
+        }
+    }
+
+    uv_timer_stop(multi->bandwidth_timer);
+}
+
+/* Take bandwidth for data of a transfer, returns the bytes allowed which
+ * are whole units unless less than a unit is given, or 0 if the transfer
+ * has to be paused until the timer gives it a share of the bucket. */
+static size_t shard_transfer_take(shard_transfer_t *transfer, size_t length,
+                                  size_t unit)
+{
+    if (shard_transfer_rate_limit(transfer) == 0) {
+        return length;
+    }
+
+    storj_http_multi_t *multi = transfer->multi;
+
+    http_multi_refill(multi);
+
+    // Bandwidth that isn't used by the other transfers is taken as needed
+    uint64_t *tokens = shard_transfer_tokens(transfer);
+    if (transfer->allowance < (int64_t)length && *tokens > 0) {
+        uint64_t needed = length - transfer->allowance;
+        uint64_t taken = (*tokens < needed) ? *tokens : needed;
+        *tokens -= taken;
+        transfer->allowance += taken;
+    }
+
+    if (transfer->allowance <= 0) {
+        transfer->throttled = true;
+        if (!uv_is_active((uv_handle_t *)multi->bandwidth_timer)) {
+            uv_timer_start(multi->bandwidth_timer, http_multi_bandwidth,
+                           SHARD_BANDWIDTH_INTERVAL, SHARD_BANDWIDTH_INTERVAL);
+        }
+        return 0;
+    }
+
+    size_t allowed = length;
+    if ((uint64_t)transfer->allowance < length) {
+        allowed = transfer->allowance / unit * unit;
+        // a whole unit is taken from a smaller allowance, the transfer
+        // then waits for longer until its next share
+        if (allowed == 0) {
+            allowed = (unit < length) ? unit : length;
+        }
+    }
+
+    transfer->allowance -= allowed;
+
+    return allowed;
+}
+
+// A rate limited transfer is slowed down on purpose, only a transfer that
+// has stalled is aborted
+static long shard_low_speed_limit(storj_http_options_t *http_options,
+                                  uint64_t rate_limit)
+{
+    return (rate_limit > 0) ? 1L : http_options->low_speed_limit;
+}
+
+static int http_multi_start_timeout(CURLM *curl_multi, long timeout_ms,
+                                    void *userp)
+{
+    storj_http_multi_t *multi = userp;
+
+    if (timeout_ms < 0) {
+        uv_timer_stop(multi->timer);
+    } else {
+        // curl can not be called back from within this function, an
+        // immediate timeout is run on the next iteration of the loop
+        if (timeout_ms == 0) {
+            timeout_ms = 1;
+        }
+        uv_timer_start(multi->timer, http_multi_timeout, timeout_ms, 0);
+    }
+
+    return 0;
+}
+
+static int http_multi_handle_socket(CURL *curl, curl_socket_t sockfd,
+                                    int action, void *userp, void *socketp)
+{
+    storj_http_multi_t *multi = userp;
+    http_socket_t *socket = socketp;
+
+    if (action == CURL_POLL_REMOVE) {
+        if (socket) {
+            uv_poll_stop(&socket->poll_handle);
+            curl_multi_assign(multi->multi, sockfd, NULL);
+            uv_close((uv_handle_t *)&socket->poll_handle, free_http_socket);
+        }
+        return 0;
+    }
+
+    if (!socket) {
+        socket = malloc(sizeof(http_socket_t));
+        if (!socket) {
+            return -1;
+        }
+
+        socket->sockfd = sockfd;
+        socket->multi = multi;
+        socket->poll_handle.data = socket;
+
+        if (uv_poll_init_socket(multi->loop, &socket->poll_handle, sockfd)) {
+            free(socket);
+            return -1;
+        }
+
+        curl_multi_assign(multi->multi, sockfd, socket);
+    }
+
+    int events = 0;
+    if (action != CURL_POLL_IN) {
+        events |= UV_WRITABLE;
+    }
+    if (action != CURL_POLL_OUT) {
+        events |= UV_READABLE;
+    }
+
+    uv_poll_start(&socket->poll_handle, events, http_multi_poll);
+
+    return 0;
+}
+
+storj_http_multi_t *http_multi_new(uv_loop_t *loop,
+                                   storj_http_options_t *http_options)
+{
+    storj_http_multi_t *multi = malloc(sizeof(storj_http_multi_t));
+    if (!multi) {
+        return NULL;
+    }
+
+    multi->loop = loop;
+    multi->http_options = http_options;
+    multi->running = 0;
+    multi->transfers = NULL;
+    multi->transfer_buffer_count = 0;
+
+    multi->transfer_buffers = calloc(http_options->max_idle_connections * 2,
+                                     sizeof(uint8_t *));
+    if (!multi->transfer_buffers) {
+        free(multi);
+        return NULL;
+    }
+
+    multi->timer = malloc(sizeof(uv_timer_t));
+    multi->cancel_timer = malloc(sizeof(uv_timer_t));
+    multi->bandwidth_timer = malloc(sizeof(uv_timer_t));
+    if (!multi->timer || !multi->cancel_timer || !multi->bandwidth_timer) {
+        free(multi->transfer_buffers);
+        free(multi->timer);
+        free(multi->cancel_timer);
+        free(multi->bandwidth_timer);
+        free(multi);
+        return NULL;
+    }
+
+    multi->multi = curl_multi_init();
+    if (!multi->multi) {
+        free(multi->transfer_buffers);
+        free(multi->timer);
+        free(multi->cancel_timer);
+        free(multi->bandwidth_timer);
+        free(multi);
+        return NULL;
+    }
+
+    uv_timer_init(loop, multi->timer);
+    multi->timer->data = multi;
+
+    uv_timer_init(loop, multi->cancel_timer);
+    multi->cancel_timer->data = multi;
+
+    uv_timer_init(loop, multi->bandwidth_timer);
+    multi->bandwidth_timer->data = multi;
+
+    multi->upload_tokens = 0;
+    multi->download_tokens = 0;
+    multi->bandwidth_time = uv_now(loop);
+    uv_mutex_init(&multi->rate_lock);
+
+    // The timers only keep the loop alive while there are transfers
+    uv_unref((uv_handle_t *)multi->timer);
+    uv_unref((uv_handle_t *)multi->bandwidth_timer);
+
+    curl_multi_setopt(multi->multi, CURLMOPT_SOCKETFUNCTION,
+                      http_multi_handle_socket);
+    curl_multi_setopt(multi->multi, CURLMOPT_SOCKETDATA, multi);
+    curl_multi_setopt(multi->multi, CURLMOPT_TIMERFUNCTION,
+                      http_multi_start_timeout);
+    curl_multi_setopt(multi->multi, CURLMOPT_TIMERDATA, multi);
+
+    return multi;
+}
+
+void http_multi_destroy(storj_http_multi_t *multi)
+{
+    if (!multi) {
+        return;
+    }
+
+    curl_multi_cleanup(multi->multi);
+
+    uv_timer_stop(multi->timer);
+    uv_close((uv_handle_t *)multi->timer, free_http_timer);
+
+    uv_timer_stop(multi->cancel_timer);
+    uv_close((uv_handle_t *)multi->cancel_timer, free_http_timer);
+
+    uv_timer_stop(multi->bandwidth_timer);
+    uv_close((uv_handle_t *)multi->bandwidth_timer, free_http_timer);
+
+    for (uint32_t i = 0; i < multi->transfer_buffer_count; i++) {
+        free(multi->transfer_buffers[i]);
+    }
+    free(multi->transfer_buffers);
+
+    uv_mutex_destroy(&multi->rate_lock);
+
+    free(multi);
+}
+
+static int shard_transfer_progress(void *userp,
+                                   curl_off_t dltotal, curl_off_t dlnow,
+                                   curl_off_t ultotal, curl_off_t ulnow)
+{
+    shard_transfer_t *transfer = userp;
+
+    // abort transfers that are waiting on the farmer when canceled
+    if (*transfer->canceled) {
+        return 1;
+    }
+
+    return 0;
+}
+
+static shard_transfer_t *shard_transfer_new(storj_http_multi_t *multi,
+                                            char *proto,
+                                            char *host,
+                                            int port,
+                                            uv_async_t *progress_handle,
+                                            bool *canceled,
+                                            uint32_t weight,
+                                            shard_transfer_cb cb,
+                                            void *handle)
+{
+    shard_transfer_t *transfer = calloc(1, sizeof(shard_transfer_t));
+    if (!transfer) {
+        return NULL;
+    }
+
+    transfer->proto = strdup(proto);
+    transfer->host = strdup(host);
+    if (!transfer->proto || !transfer->host) {
+        free(transfer->proto);
+        free(transfer->host);
+        free(transfer);
+        return NULL;
+    }
+
+    transfer->curl = http_pool_acquire(multi->http_options, proto, host, port);
+    if (!transfer->curl) {
+        free(transfer->proto);
+        free(transfer->host);
+        free(transfer);
+        return NULL;
+    }
+
+    transfer->multi = multi;
+    transfer->port = port;
+    transfer->progress_handle = progress_handle;
+    transfer->canceled = canceled;
+    transfer->weight = (weight > 0) ? weight : 1;
+    transfer->cb = cb;
+    transfer->handle = handle;
+
+    return transfer;
+}
+
+static int shard_transfer_start(shard_transfer_t *transfer)
+{
+    CURL *curl = transfer->curl;
+    storj_http_multi_t *multi = transfer->multi;
+
+    curl_easy_setopt(curl, CURLOPT_PRIVATE, transfer);
+    curl_easy_setopt(curl, CURLOPT_NOPROGRESS, 0L);
+    curl_easy_setopt(curl, CURLOPT_XFERINFOFUNCTION, shard_transfer_progress);
+    curl_easy_setopt(curl, CURLOPT_XFERINFODATA, transfer);
+
+    if (curl_multi_add_handle(multi->multi, curl) != CURLM_OK) {
+        return 1;
+    }
+
+    transfer->prev = NULL;
+    transfer->next = multi->transfers;
+    if (multi->transfers) {
+        multi->transfers->prev = transfer;
+    }
+    multi->transfers = transfer;
+
+    if (multi->running == 0) {
+        uv_ref((uv_handle_t *)multi->timer);
+    }
+    multi->running += 1;
+
+    return 0;
+}
 
 static size_t body_ignore_receive(void *buffer, size_t size, size_t nmemb,
                                   void *userp)
@@ -7,54 +896,165 @@ static size_t body_ignore_receive(void *buffer, size_t size, size_t nmemb,
     return buflen;
 }
 
+static void after_shard_read(uv_fs_t *req);
+
+static void start_shard_read(shard_body_send_t *body)
+{
+    uv_buf_t buf = uv_buf_init((char *)body->read_buffer + body->read_done,
+                               body->read_length - body->read_done);
+
+    body->read_req.data = body;
+    body->reading = true;
+
+    int error = uv_fs_read(body->transfer->multi->loop, &body->read_req,
+                           fileno(body->fd), &buf, 1,
+                           body->read_position + body->read_done,
+                           after_shard_read);
+    if (error) {
+        body->error_code = -error;
+        body->reading = false;
+    }
+}
+
+static void read_shard_ahead(shard_body_send_t *body)
+{
+    if (body->read_remain == 0) {
+        return;
+    }
+
+    if (!body->read_buffer) {
+        body->read_buffer = transfer_buffer_acquire(body->transfer->multi);
+        if (!body->read_buffer) {
+            body->error_code = ENOMEM;
+            return;
+        }
+    }
+
+    body->read_length = body->transfer->multi->http_options->transfer_buffer_size;
+    if (body->read_length > body->read_remain) {
+        body->read_length = body->read_remain;
+    }
+    body->read_remain -= body->read_length;
+    body->read_done = 0;
+
+    start_shard_read(body);
+}
+
+static void after_shard_read(uv_fs_t *req)
+{
+    shard_body_send_t *body = req->data;
+    shard_transfer_t *transfer = body->transfer;
+    ssize_t result = req->result;
+
+    uv_fs_req_cleanup(req);
+
+    if (result < 0) {
+        body->error_code = -result;
+    } else if (result == 0) {
+        // the file is shorter than the shard
+        body->error_code = EIO;
+    } else {
+        body->read_done += result;
+        if (body->read_done < body->read_length) {
+            start_shard_read(body);
+            if (body->reading) {
+                return;
+            }
+        } else {
+            body->read_position += body->read_length;
+            body->read_ready = true;
+        }
+    }
+
+    body->reading = false;
+
+    if (transfer->completed) {
+        shard_transfer_done(transfer, transfer->result);
+        return;
+    }
+
+    if (body->paused) {
+        body->paused = false;
+        shard_transfer_resume(transfer, body->error_code != 0);
+    }
+}
+
+static void next_shard_buffer(shard_body_send_t *body)
+{
+    if (body->reading || !body->read_ready) {
+        return;
+    }
+
+    uint8_t *buffer = body->buffer;
+    body->buffer = body->read_buffer;
+    body->buffer_length = body->read_length;
+    body->buffer_position = 0;
+    body->read_buffer = buffer;
+    body->read_ready = false;
+
+    // Read the next part of the shard while this one is sent
+    read_shard_ahead(body);
+}
+
 static size_t body_shard_send(void *buffer, size_t size, size_t nmemb,
                               void *userp)
 {
     shard_body_send_t *body = userp;
 
-    if (*body->canceled) {
+    if (*body->canceled || body->error_code) {
         return CURL_READFUNC_ABORT;
     }
 
-    size_t read_bytes = 0;
-    size_t buflen = size * nmemb / AES_BLOCK_SIZE * AES_BLOCK_SIZE;
-    uint8_t clr_txt[buflen];
-    memset_zero(clr_txt, buflen);
-
-    if (buflen > 0) {
-        if (body->remain < buflen) {
-            buflen = body->remain;
-        }
+    if (body->remain == 0) {
+        return 0;
+    }
 
-        // Read shard data from file
-        read_bytes = pread(fileno(body->fd), clr_txt, buflen, body->offset + body->total_sent);
-        if (read_bytes == -1) {
-            body->error_code = errno;
+    // Wait for the next part of the shard once the buffer has been sent
+    if (body->buffer_position == body->buffer_length) {
+        next_shard_buffer(body);
+        if (body->error_code) {
             return CURL_READFUNC_ABORT;
         }
-
-        if (body->ctx != NULL) {
-            ctr_crypt(body->ctx->ctx, (nettle_cipher_func *)aes256_encrypt,
-                      AES_BLOCK_SIZE, body->ctx->encryption_ctr, read_bytes,
-                      (uint8_t *)buffer, (uint8_t *)clr_txt);
-        } else {
-            memcpy(buffer, clr_txt, read_bytes);
+        if (body->buffer_position == body->buffer_length) {
+            body->paused = true;
+            return CURL_READFUNC_PAUSE;
         }
+    }
 
-        if (ferror(body->fd)) {
-            return CURL_READFUNC_ABORT;
-        }
+    // Data is encrypted in whole blocks until the end of the shard, shards
+    // that are already encrypted are copied as they are
+    size_t buflen = size * nmemb;
+    if (body->ctx != NULL) {
+        buflen = buflen / AES_BLOCK_SIZE * AES_BLOCK_SIZE;
+    }
+    if (buflen > body->buffer_length - body->buffer_position) {
+        buflen = body->buffer_length - body->buffer_position;
+    }
 
-        body->total_sent += read_bytes;
-        body->bytes_since_progress += read_bytes;
+    if (buflen > 0) {
+        buflen = shard_transfer_take(body->transfer, buflen,
+                                     (body->ctx) ? AES_BLOCK_SIZE : 1);
+        if (buflen == 0) {
+            return CURL_READFUNC_PAUSE;
+        }
+    }
 
-        body->remain -= read_bytes;
+    uint8_t *data = body->buffer + body->buffer_position;
 
-        memset_zero(clr_txt, buflen);
+    if (body->ctx != NULL) {
+        aes256_ctr_crypt(body->ctx->ctx, body->ctx->encryption_ctr, buflen,
+                         (uint8_t *)buffer, data);
+    } else {
+        memcpy(buffer, data, buflen);
     }
 
+    body->buffer_position += buflen;
+    body->total_sent += buflen;
+    body->bytes_since_progress += buflen;
+    body->remain -= buflen;
+
     // give progress updates at set interval
-    if (body->progress_handle && read_bytes > 0 &&
+    if (body->progress_handle && buflen > 0 &&
         (body->bytes_since_progress > SHARD_PROGRESS_INTERVAL ||
          body->remain == 0)) {
 
@@ -65,10 +1065,40 @@ static size_t body_shard_send(void *buffer, size_t size, size_t nmemb,
         body->bytes_since_progress = 0;
     }
 
-    return read_bytes;
+    return buflen;
+}
+
+static void finish_put_shard(shard_transfer_t *transfer, CURLcode req)
+{
+    shard_body_send_t *shard_body = transfer->send_body;
+
+    if (shard_body) {
+        transfer->io_code = shard_body->error_code;
+    }
+
+    if (*transfer->canceled) {
+        transfer->error_status = 1;
+        return;
+    }
+
+    if (req != CURLE_OK) {
+        transfer->error_status = req;
+        return;
+    }
+
+    // set the status code
+
+    long int _status_code;
+    curl_easy_getinfo(transfer->curl, CURLINFO_RESPONSE_CODE, &_status_code);
+    transfer->status_code = (int)_status_code;
+
+    // check that total bytes have been sent
+    if (!shard_body || shard_body->total_sent != shard_body->length) {
+        transfer->error_status = 1;
+    }
 }
 
-int put_shard(storj_http_options_t *http_options,
+int put_shard(storj_http_multi_t *multi,
               char *farmer_id,
               char *proto,
               char *host,
@@ -79,35 +1109,43 @@ int put_shard(storj_http_options_t *http_options,
               uint64_t file_position,
               storj_encryption_ctx_t *ctx,
               char *token,
-              int *status_code,
-              int *read_code,
               uv_async_t *progress_handle,
-              bool *canceled)
+              bool *canceled,
+              uint32_t weight,
+              shard_transfer_cb cb,
+              void *handle)
 {
-    int return_code = 0;
+    storj_http_options_t *http_options = multi->http_options;
 
-    CURL *curl = curl_easy_init();
-    if (!curl) {
+    shard_transfer_t *transfer = shard_transfer_new(multi, proto, host, port,
+                                                    progress_handle, canceled,
+                                                    weight, cb, handle);
+    if (!transfer) {
         return 1;
     }
 
+    transfer->finish = finish_put_shard;
+
+    CURL *curl = transfer->curl;
+
     char query_args[80];
     snprintf(query_args, 80, "?token=%s", token);
 
     int url_len = strlen(proto) + 3 + strlen(host) + 1 + 10 + 8
         + strlen(shard_hash) + strlen(query_args);
-    char *url = calloc(url_len + 1, sizeof(char));
-    if (!url) {
-        return 1;
+    transfer->url = calloc(url_len + 1, sizeof(char));
+    if (!transfer->url) {
+        goto error;
     }
 
-    snprintf(url, url_len, "%s://%s:%i/shards/%s%s", proto, host, port,
-             shard_hash, query_args);
+    snprintf(transfer->url, url_len, "%s://%s:%i/shards/%s%s", proto, host,
+             port, shard_hash, query_args);
 
-    curl_easy_setopt(curl, CURLOPT_URL, url);
+    curl_easy_setopt(curl, CURLOPT_URL, transfer->url);
 
+    uint64_t rate_limit = http_multi_rate_limit(multi, true);
     curl_easy_setopt(curl, CURLOPT_LOW_SPEED_LIMIT,
-                     http_options->low_speed_limit);
+                     shard_low_speed_limit(http_options, rate_limit));
 
     curl_easy_setopt(curl, CURLOPT_LOW_SPEED_TIME,
                      http_options->low_speed_time);
@@ -126,28 +1164,26 @@ int put_shard(storj_http_options_t *http_options,
 
     curl_easy_setopt(curl, CURLOPT_POST, 1);
 
-    struct curl_slist *header_list = NULL;
-    header_list = curl_slist_append(header_list, "Content-Type: application/octet-stream");
+    transfer->headers = curl_slist_append(transfer->headers,
+                                          "Content-Type: application/octet-stream");
 
-    char *header = calloc(17 + 40 + 1, sizeof(char));
-    if (!header) {
-        return 1;
-    }
+    char header[17 + 40 + 1];
+    memset(header, '\0', sizeof(header));
     strcat(header, "x-storj-node-id: ");
     strncat(header, farmer_id, 40);
-    header_list = curl_slist_append(header_list, header);
-    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, header_list);
-
-    shard_body_send_t *shard_body = NULL;
-
+    transfer->headers = curl_slist_append(transfer->headers, header);
+    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, transfer->headers);
 
     if (original_file && shard_total_bytes) {
 
-        shard_body = malloc(sizeof(shard_body_send_t));
+        shard_body_send_t *shard_body = calloc(1, sizeof(shard_body_send_t));
         if (!shard_body) {
-            return 1;
+            goto error;
         }
 
+        shard_body->transfer = transfer;
+        shard_body->read_position = file_position;
+        shard_body->read_remain = shard_total_bytes;
         shard_body->fd = original_file;
         shard_body->offset = file_position;
         shard_body->ctx = ctx;
@@ -159,54 +1195,142 @@ int put_shard(storj_http_options_t *http_options,
         shard_body->canceled = canceled;
         shard_body->error_code = 0;
 
+        transfer->send_body = shard_body;
+
         curl_easy_setopt(curl, CURLOPT_READFUNCTION, body_shard_send);
         curl_easy_setopt(curl, CURLOPT_READDATA, (void *)shard_body);
         curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE_LARGE, (uint64_t)shard_total_bytes);
+
+#if LIBCURL_VERSION_NUM >= 0x073e00
+        // Fill curl's buffer with as much of the shard as possible at once
+        long upload_buffer_size = http_options->transfer_buffer_size;
+        if (upload_buffer_size > SHARD_UPLOAD_BUFFER_MAX) {
+            upload_buffer_size = SHARD_UPLOAD_BUFFER_MAX;
+        }
+        curl_easy_setopt(curl, CURLOPT_UPLOAD_BUFFERSIZE, upload_buffer_size);
+#endif
+    }
+
+    // Ignore any data sent back, we only need to know the status code
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, body_ignore_receive);
+
+    if (shard_transfer_start(transfer)) {
+        goto error;
+    }
+
+    // The first part of the shard is read while connecting
+    if (transfer->send_body) {
+        read_shard_ahead(transfer->send_body);
+    }
+
+    return 0;
+
+error:
+    shard_transfer_free(transfer);
+    return 1;
+}
+
+static void after_shard_write(uv_fs_t *req);
+
+static void start_shard_write(shard_body_receive_t *body)
+{
+    uint8_t *data = body->write_buffer + body->write_done;
+    size_t len = body->write_length - body->write_done;
+    uv_file fd = fileno(body->destination);
+
+    // direct io is used for whole pages, and any end of the shard that
+    // isn't a whole page goes through the page cache
+    body->write_direct = false;
+    if (body->direct_fd >= 0 && len >= TRANSFER_BUFFER_ALIGNMENT) {
+        len = (len / TRANSFER_BUFFER_ALIGNMENT) * TRANSFER_BUFFER_ALIGNMENT;
+        fd = body->direct_fd;
+        body->write_direct = true;
+    }
+
+    uv_buf_t buf = uv_buf_init((char *)data, len);
+
+    body->write_req.data = body;
+    body->writing = true;
+
+    int error = uv_fs_write(body->transfer->multi->loop, &body->write_req,
+                            fd, &buf, 1,
+                            body->write_position + body->write_done,
+                            after_shard_write);
+    if (error) {
+        body->error_code = -error;
+        body->writing = false;
     }
+}
 
-    // Ignore any data sent back, we only need to know the status code
-    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, body_ignore_receive);
+static bool shard_buffer_ready(shard_body_receive_t *body)
+{
+    return body->buffer && body->buffer_position > 0 &&
+        (body->buffer_position == body->buffer_size ||
+         body->length == body->shard_total_bytes);
+}
 
-    int req = curl_easy_perform(curl);
+static void queue_shard_write(shard_body_receive_t *body)
+{
+    uint8_t *buffer = body->write_buffer;
 
-    curl_slist_free_all(header_list);
-    free(header);
+    body->write_buffer = body->buffer;
+    body->write_length = body->buffer_position;
+    body->write_done = 0;
+    body->write_position = body->file_position;
+    body->file_position += body->buffer_position;
 
-    if (*canceled) {
-        return_code = 1;
-        goto clean_up;
-    }
+    // the other buffer is acquired once more data is received
+    body->buffer = buffer;
+    body->buffer_position = 0;
+    body->hashed_position = 0;
 
-    if (req != CURLE_OK) {
-        return_code = req;
-        goto clean_up;
-    }
+    start_shard_write(body);
+}
 
-    // set the status code
-    if (shard_body && shard_total_bytes) {
-        *read_code = shard_body->error_code;
+static void after_shard_write(uv_fs_t *req)
+{
+    shard_body_receive_t *body = req->data;
+    shard_transfer_t *transfer = body->transfer;
+    ssize_t result = req->result;
+
+    uv_fs_req_cleanup(req);
+
+    if (result == UV_EINVAL && body->write_direct) {
+        // not supported for this file, continue without direct io
+        close(body->direct_fd);
+        body->direct_fd = -1;
+        start_shard_write(body);
+        if (body->writing) {
+            return;
+        }
+    } else if (result < 0) {
+        body->error_code = -result;
+    } else {
+        body->write_done += result;
+        if (body->write_done < body->write_length) {
+            start_shard_write(body);
+            if (body->writing) {
+                return;
+            }
+        }
     }
 
-    long int _status_code;
-    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &_status_code);
-    *status_code = (int)_status_code;
+    body->writing = false;
 
-    // check that total bytes have been sent
-    if (shard_body->total_sent != shard_total_bytes) {
-        return_code = 1;
-        goto clean_up;
+    // The next buffer may have been received while writing
+    if (!body->error_code && shard_buffer_ready(body)) {
+        queue_shard_write(body);
     }
 
-clean_up:
-
-    // clean up memory
-    if (shard_body) {
-        free(shard_body);
+    if (transfer->completed) {
+        shard_transfer_done(transfer, transfer->result);
+        return;
     }
-    free(url);
-    curl_easy_cleanup(curl);
 
-    return return_code;
+    if (body->paused) {
+        body->paused = false;
+        shard_transfer_resume(transfer, body->error_code != 0);
+    }
 }
 
 static size_t body_shard_receive(void *buffer, size_t size, size_t nmemb,
@@ -215,66 +1339,88 @@ static size_t body_shard_receive(void *buffer, size_t size, size_t nmemb,
     size_t buflen = size * nmemb;
     shard_body_receive_t *body = (shard_body_receive_t *)userp;
 
-    if (*body->canceled) {
+    if (*body->canceled || body->error_code) {
         return CURL_READFUNC_ABORT;
     }
 
-    if (body->length + body->tail_position + buflen > body->shard_total_bytes) {
+    if (body->length + buflen > body->shard_total_bytes) {
         return CURL_READFUNC_ABORT;
     }
 
-    // Resize the buffer if necessary
-    if (body->tail_position + buflen > body->tail_length) {
-        body->tail_length = (body->tail_position + buflen) * 2;
-        body->tail = realloc(body->tail, body->tail_length);
-
-        if (!body->tail) {
-            return CURL_READFUNC_ABORT;
-        }
+    // Wait for the file to be written when there isn't a buffer to receive
+    // into, curl passes the same data again once the transfer is resumed
+    if (body->writing &&
+        body->buffer_position + buflen > body->buffer_size) {
+        body->paused = true;
+        return CURL_WRITEFUNC_PAUSE;
     }
 
-    // Copy buffer to tail
-    memcpy(body->tail + body->tail_position, buffer, buflen);
-
-    size_t writelen = body->tail_position + buflen;
-    if (body->length + writelen != body->shard_total_bytes) {
-        writelen = (writelen / AES_BLOCK_SIZE) * AES_BLOCK_SIZE;
+    // Data that is passed again after a pause has not been counted yet
+    if (buflen > 0 && !shard_transfer_take(body->transfer, buflen, buflen)) {
+        return CURL_WRITEFUNC_PAUSE;
     }
 
-    // Update the hash
-    sha256_update(body->sha256_ctx, writelen, (uint8_t *)body->tail);
+    uint8_t *received = buffer;
+    size_t remain = buflen;
 
-    // Write directly to the file at the correct position
-    if (writelen == pwrite(fileno(body->destination),
-                           body->tail,
-                           writelen,
-                           body->file_position)) {
+    while (remain > 0) {
+        if (!body->buffer) {
+            body->buffer = transfer_buffer_acquire(body->transfer->multi);
+            if (!body->buffer) {
+                body->error_code = ENOMEM;
+                return CURL_READFUNC_ABORT;
+            }
+        }
 
-        if (writelen == -1) {
-            body->error_code = errno;
-            return CURL_READFUNC_ABORT;
+        size_t len = body->buffer_size - body->buffer_position;
+        if (len > remain) {
+            len = remain;
         }
 
-        body->file_position += writelen;
-    } else {
-        // TODO handle error
-        return CURL_READFUNC_ABORT;
-    }
+        memcpy(body->buffer + body->buffer_position, received, len);
+        body->buffer_position += len;
+        body->length += len;
+        received += len;
+        remain -= len;
+
+        // Hash and decrypt whole blocks while they are in the cache, the
+        // last block of the shard may be partial
+        size_t end = body->buffer_position;
+        if (body->length != body->shard_total_bytes) {
+            end = (end / AES_BLOCK_SIZE) * AES_BLOCK_SIZE;
+        }
 
-    body->length += writelen;
-    body->bytes_since_progress += writelen;
+        if (end > body->hashed_position) {
+            uint8_t *data = body->buffer + body->hashed_position;
+            size_t data_len = end - body->hashed_position;
 
-    // Move any remaining data to the beginning and mark position
-    size_t tailing_size = body->tail_position + buflen - writelen;
-    if (tailing_size > 0) {
-        uint8_t tmp[tailing_size];
-        memcpy(&tmp, body->tail + writelen, tailing_size);
-        memcpy(body->tail, &tmp, tailing_size);
-        body->tail_position = tailing_size;
-    } else {
-        body->tail_position = 0;
+            sha256_update(body->sha256_ctx, data_len, data);
+
+            // Decrypt after hashing, the shard hash is of the encrypted data
+            if (body->decrypt_ctx) {
+                aes256_ctr_crypt(body->decrypt_ctx, body->decrypt_ctr,
+                                 data_len, data, data);
+            }
+
+            body->hashed_position = end;
+        }
+
+        if (body->shard_data) {
+            continue;
+        }
+
+        // Write the buffer once it's full or the shard has been received,
+        // or once the previous write has finished
+        if (!body->writing && shard_buffer_ready(body)) {
+            queue_shard_write(body);
+            if (body->error_code) {
+                return CURL_READFUNC_ABORT;
+            }
+        }
     }
 
+    body->bytes_since_progress += buflen;
+
     // Give progress updates at set interval
     if (body->progress_handle &&
         body->bytes_since_progress > SHARD_PROGRESS_INTERVAL) {
@@ -287,8 +1433,62 @@ static size_t body_shard_receive(void *buffer, size_t size, size_t nmemb,
     return buflen;
 }
 
+static void finish_fetch_shard(shard_transfer_t *transfer, CURLcode req)
+{
+    shard_body_receive_t *body = transfer->receive_body;
+
+    transfer->io_code = body->error_code;
+
+    if (req != CURLE_OK || body->error_code) {
+        // TODO include the actual http error code
+        transfer->error_status = STORJ_FARMER_REQUEST_ERROR;
+    }
+
+    // set the status code
+    long int _status_code;
+    curl_easy_getinfo(transfer->curl, CURLINFO_RESPONSE_CODE, &_status_code);
+    transfer->status_code = (int)_status_code;
+
+    if (transfer->error_status) {
+        return;
+    }
+
+    if (body->length != transfer->shard_total_bytes) {
+        transfer->error_status = STORJ_FARMER_INTEGRITY_ERROR;
+        return;
+    }
+
+    uint8_t hash_sha256[SHA256_DIGEST_SIZE];
+    sha256_digest(body->sha256_ctx, SHA256_DIGEST_SIZE, hash_sha256);
+
+    struct ripemd160_ctx rctx;
+    ripemd160_init(&rctx);
+    ripemd160_update(&rctx, SHA256_DIGEST_SIZE, hash_sha256);
+
+    uint8_t hash_rmd160[RIPEMD160_DIGEST_SIZE];
+    ripemd160_digest(&rctx, RIPEMD160_DIGEST_SIZE, hash_rmd160);
+
+    char hash[RIPEMD160_DIGEST_SIZE * 2 + 1];
+    memset(hash, '\0', sizeof(hash));
+    for (unsigned i = 0; i < RIPEMD160_DIGEST_SIZE; i++) {
+        sprintf(&hash[i*2], "%02x", hash_rmd160[i]);
+    }
+
+    if (strcmp(transfer->shard_hash, hash) != 0) {
+        transfer->error_status = STORJ_FARMER_INTEGRITY_ERROR;
+        return;
+    }
+
+    // final progress update
+    if (transfer->progress_handle) {
+        shard_download_progress_t *progress = transfer->progress_handle->data;
+        progress->bytes = transfer->shard_total_bytes;
+        uv_async_send(transfer->progress_handle);
+    }
+}
+
 /* shard_data must be allocated for shard_total_bytes */
-int fetch_shard(storj_http_options_t *http_options,
+int fetch_shard(storj_http_multi_t *multi,
                 char *farmer_id,
                 char *proto,
                 char *host,
@@ -298,16 +1498,30 @@ int fetch_shard(storj_http_options_t *http_options,
                 char *token,
                 FILE *destination,
                 uint64_t file_position,
-                int *status_code,
-                int *write_code,
+                uint8_t *shard_data,
+                const uint8_t *decrypt_key,
+                const uint8_t *decrypt_ctr,
                 uv_async_t *progress_handle,
-                bool *canceled)
+                bool *canceled,
+                uint32_t weight,
+                shard_transfer_cb cb,
+                void *handle)
 {
-    CURL *curl = curl_easy_init();
-    if (!curl) {
+    storj_http_options_t *http_options = multi->http_options;
+
+    shard_transfer_t *transfer = shard_transfer_new(multi, proto, host, port,
+                                                    progress_handle, canceled,
+                                                    weight, cb, handle);
+    if (!transfer) {
         return 1;
     }
 
+    transfer->finish = finish_fetch_shard;
+    transfer->shard_hash = shard_hash;
+    transfer->shard_total_bytes = shard_total_bytes;
+
+    CURL *curl = transfer->curl;
+
     if (http_options->user_agent) {
         curl_easy_setopt(curl, CURLOPT_USERAGENT, http_options->user_agent);
     }
@@ -324,44 +1538,40 @@ int fetch_shard(storj_http_options_t *http_options,
     snprintf(query_args, 80, "?token=%s", token);
     int url_len = strlen(proto) + 3 + strlen(host) + 1 + 10
         + 8 + strlen(shard_hash) + strlen(query_args);
-    char *url = calloc(url_len + 1, sizeof(char));
-    if (!url) {
-        return 1;
+    transfer->url = calloc(url_len + 1, sizeof(char));
+    if (!transfer->url) {
+        goto error;
     }
-    snprintf(url, url_len, "%s://%s:%i/shards/%s%s", proto, host, port,
-             shard_hash, query_args);
+    snprintf(transfer->url, url_len, "%s://%s:%i/shards/%s%s", proto, host,
+             port, shard_hash, query_args);
 
-    curl_easy_setopt(curl, CURLOPT_URL, url);
+    curl_easy_setopt(curl, CURLOPT_URL, transfer->url);
     curl_easy_setopt(curl, CURLOPT_HTTPGET, 1);
 
+    uint64_t rate_limit = http_multi_rate_limit(multi, false);
     curl_easy_setopt(curl, CURLOPT_LOW_SPEED_LIMIT,
-                     http_options->low_speed_limit);
+                     shard_low_speed_limit(http_options, rate_limit));
 
     curl_easy_setopt(curl, CURLOPT_LOW_SPEED_TIME,
                      http_options->low_speed_time);
 
     // Set the node id header
-    struct curl_slist *node_chunk = NULL;
-    char *header = calloc(17 + 40 + 1, sizeof(char));
-    if (!header) {
-        return 1;
-    }
+    char header[17 + 40 + 1];
+    memset(header, '\0', sizeof(header));
     strcat(header, "x-storj-node-id: ");
     strncat(header, farmer_id, 40);
-    node_chunk = curl_slist_append(node_chunk, header);
-    free(header);
-    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, node_chunk);
+    transfer->headers = curl_slist_append(transfer->headers, header);
+    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, transfer->headers);
 
     // Set the body handler
     curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, body_shard_receive);
-    shard_body_receive_t *body = malloc(sizeof(shard_body_receive_t));
+    shard_body_receive_t *body = calloc(1, sizeof(shard_body_receive_t));
     if (!body) {
-        return 1;
+        goto error;
     }
+    transfer->receive_body = body;
 
-    body->tail = malloc(BUFSIZ);
-    body->tail_length = BUFSIZ;
-    body->tail_position = 0;
+    body->direct_fd = -1;
     body->length = 0;
     body->progress_handle = progress_handle;
     body->shard_total_bytes = shard_total_bytes;
@@ -370,100 +1580,61 @@ int fetch_shard(storj_http_options_t *http_options,
     body->sha256_ctx = malloc(sizeof(struct sha256_ctx));
     body->error_code = 0;
     if (!body->sha256_ctx) {
-        return 1;
+        goto error;
     }
     sha256_init(body->sha256_ctx);
 
-    body->destination = destination;
-    body->file_position = file_position;
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, (void *)body);
-
-    int req = curl_easy_perform(curl);
-
-    curl_slist_free_all(node_chunk);
-    free(body->tail);
-
-    // set the status code
-    if (body) {
-        *write_code = body->error_code;
-    }
-
-
-    int error_code = 0;
-    if (req != CURLE_OK) {
-        // TODO include the actual http error code
-        error_code = STORJ_FARMER_REQUEST_ERROR;
-    }
-
-    // set the status code
-    long int _status_code;
-    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &_status_code);
-    *status_code = (int)_status_code;
-
-    curl_easy_cleanup(curl);
-
-    free(url);
-
-    if (error_code) {
-        free(body->sha256_ctx);
-        free(body);
-        return error_code;
-    }
-
-    if (body->length != shard_total_bytes) {
-        free(body->sha256_ctx);
-        free(body);
-        return STORJ_FARMER_INTEGRITY_ERROR;
-    }
-
-    uint8_t *hash_sha256 = calloc(SHA256_DIGEST_SIZE, sizeof(uint8_t));
-    if (!hash_sha256) {
-        return 1;
+    if (decrypt_key && decrypt_ctr) {
+        body->decrypt_ctx = malloc(sizeof(struct aes256_ctx));
+        if (!body->decrypt_ctx) {
+            goto error;
+        }
+        aes256_set_encrypt_key(body->decrypt_ctx, decrypt_key);
+        memcpy(body->decrypt_ctr, decrypt_ctr, AES_BLOCK_SIZE);
     }
-    sha256_digest(body->sha256_ctx, SHA256_DIGEST_SIZE, hash_sha256);
-
-    struct ripemd160_ctx rctx;
-    ripemd160_init(&rctx);
-    ripemd160_update(&rctx, SHA256_DIGEST_SIZE, hash_sha256);
-
-    free(hash_sha256);
 
-    uint8_t *hash_rmd160 = calloc(RIPEMD160_DIGEST_SIZE + 1, sizeof(uint8_t));
-    if (!hash_rmd160) {
-        return 1;
-    }
-    ripemd160_digest(&rctx, RIPEMD160_DIGEST_SIZE, hash_rmd160);
+    body->destination = destination;
+    body->file_position = file_position;
+    body->shard_data = shard_data;
+    body->buffer_position = 0;
+    body->hashed_position = 0;
 
-    char *hash = calloc(RIPEMD160_DIGEST_SIZE * 2 + 1, sizeof(char));
-    if (!hash) {
-        return 1;
-    }
-    for (unsigned i = 0; i < RIPEMD160_DIGEST_SIZE; i++) {
-        sprintf(&hash[i*2], "%02x", hash_rmd160[i]);
-    }
+    body->transfer = transfer;
 
-    free(body->sha256_ctx);
-    free(body);
-    free(hash_rmd160);
+    if (shard_data) {
+        body->buffer = shard_data;
+        body->buffer_size = shard_total_bytes;
+    } else {
+        body->buffer = transfer_buffer_acquire(multi);
+        body->buffer_size = http_options->transfer_buffer_size;
+        if (!body->buffer) {
+            goto error;
+        }
 
-    if (strcmp(shard_hash, hash) != 0) {
-        error_code = STORJ_FARMER_INTEGRITY_ERROR;
+#if defined(__linux__) && defined(O_DIRECT)
+        // A second descriptor of the file is opened for direct io, writes
+        // to it need to be aligned to the page size
+        if (http_options->direct_io &&
+            file_position % TRANSFER_BUFFER_ALIGNMENT == 0) {
+            char fd_path[32];
+            snprintf(fd_path, sizeof(fd_path), "/proc/self/fd/%i",
+                     fileno(destination));
+            body->direct_fd = open(fd_path, O_WRONLY | O_DIRECT);
+        }
+#endif
     }
 
-    free(hash);
-
-    if (error_code) {
-        return error_code;
-    }
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, (void *)body);
 
-    // final progress update
-    if (progress_handle) {
-        shard_download_progress_t *progress = progress_handle->data;
-        progress->bytes = shard_total_bytes;
-        uv_async_send(progress_handle);
+    if (shard_transfer_start(transfer)) {
+        goto error;
     }
 
     return 0;
+
+error:
+    shard_transfer_free(transfer);
+    return 1;
 }
 
 static size_t body_json_send(void *buffer, size_t size, size_t nmemb,
@@ -505,30 +1676,148 @@ static size_t body_json_receive(void *buffer, size_t size, size_t nmemb,
     return buflen;
 }
 
-int fetch_json(storj_http_options_t *http_options,
-               storj_bridge_options_t *options,
-               char *method,
-               char *path,
-               struct json_object *request_body,
-               bool auth,
-               struct json_object **response,
-               int *status_code)
+static int json_stream_append(json_stream_t *stream, char c)
+{
+    if (stream->length + 1 >= stream->size) {
+        size_t size = stream->size ? stream->size * 2 : BUFSIZ;
+        char *data = realloc(stream->data, size);
+        if (!data) {
+            return 1;
+        }
+        stream->data = data;
+        stream->size = size;
+    }
+
+    stream->data[stream->length] = c;
+    stream->length += 1;
+
+    return 0;
+}
+
+static int json_stream_flush(json_stream_t *stream)
 {
-    CURL *curl = curl_easy_init();
+    if (stream->length == 0) {
+        return 0;
+    }
+
+    stream->data[stream->length] = '\0';
+    stream->length = 0;
+
+    struct json_object *value = json_tokener_parse(stream->data);
+    if (!value) {
+        stream->error_code = 1;
+        return 1;
+    }
+
+    if (stream->cb(value, stream->handle)) {
+        stream->stopped = true;
+        return 1;
+    }
+
+    return 0;
+}
+
+static size_t body_json_stream_receive(void *buffer, size_t size,
+                                       size_t nmemb, void *userp)
+{
+    size_t buflen = size * nmemb;
+    json_stream_t *stream = (json_stream_t *)userp;
+    const char *data = (const char *)buffer;
+
+    for (size_t i = 0; i < buflen; i++) {
+        char c = data[i];
+        bool space = (c == ' ' || c == '\t' || c == '\n' || c == '\r');
+
+        if (!stream->started) {
+            if (space) {
+                continue;
+            }
+            stream->started = true;
+            if (c == '[') {
+                stream->is_array = true;
+                stream->depth = 1;
+                *stream->response = json_object_new_array();
+                continue;
+            }
+        }
+
+        // elements of the top level array end at a comma or the closing
+        // bracket, anything else is part of the element
+        if (stream->is_array && !stream->in_string) {
+            if (stream->depth == 0) {
+                continue;
+            }
+            if (stream->depth == 1) {
+                if (c == ',' || c == ']') {
+                    if (json_stream_flush(stream)) {
+                        return 0;
+                    }
+                    if (c == ']') {
+                        stream->depth = 0;
+                    }
+                    continue;
+                }
+                if (space && stream->length == 0) {
+                    continue;
+                }
+            }
+        }
+
+        if (json_stream_append(stream, c)) {
+            stream->error_code = 1;
+            return 0;
+        }
+
+        if (stream->in_string) {
+            if (stream->escaped) {
+                stream->escaped = false;
+            } else if (c == '\\') {
+                stream->escaped = true;
+            } else if (c == '"') {
+                stream->in_string = false;
+            }
+        } else if (c == '"') {
+            stream->in_string = true;
+        } else if (c == '{' || c == '[') {
+            stream->depth += 1;
+        } else if (c == '}' || c == ']') {
+            stream->depth -= 1;
+        }
+    }
+
+    return buflen;
+}
+
+static int fetch_request(storj_http_options_t *http_options,
+                         storj_bridge_options_t *options,
+                         char *method,
+                         char *path,
+                         struct json_object *request_body,
+                         bool auth,
+                         size_t (*write_cb)(void *, size_t, size_t, void *),
+                         void *write_data,
+                         int *status_code)
+{
+    CURL *curl = http_pool_acquire(http_options, options->proto,
+                                   options->host, options->port);
     if (!curl) {
         return 1;
     }
 
     // curl_easy_setopt(curl, CURLOPT_VERBOSE, 1L);
 
+    int ret = 0;
     char *user_pass = NULL;
+    struct curl_slist *header_list = NULL;
+    http_body_send_t *post_body = NULL;
 
     // Set the url
     int url_len = strlen(options->proto) + 3 + strlen(options->host) +
         1 + 10 + strlen(path);
     char *url = calloc(url_len + 1, sizeof(char));
     if (!url) {
-        return 1;
+        ret = 1;
+        goto cleanup;
     }
 
     snprintf(url, url_len, "%s://%s:%i%s", options->proto, options->host,
@@ -550,7 +1839,8 @@ int fetch_json(storj_http_options_t *http_options,
     } else if (0 == strcmp(method, "DELETE")) {
         curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, "DELETE");
     } else {
-        return 1;
+        ret = 1;
+        goto cleanup;
     }
 
     // Set the proxy
@@ -567,26 +1857,20 @@ int fetch_json(storj_http_options_t *http_options,
     curl_easy_setopt(curl, CURLOPT_TIMEOUT, http_options->timeout);
 
     // Setup the body handler
-    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, body_json_receive);
-    http_body_receive_t *body = malloc(sizeof(http_body_receive_t));
-    if (!body) {
-        return 1;
-    }
-    body->data = NULL;
-    body->length = 0;
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, (void *)body);
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, write_cb);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, write_data);
 
     // Include authentication headers if info is provided
     if (auth && options->user && options->pass) {
 
         // Hash password
         uint8_t *pass_hash = calloc(SHA256_DIGEST_SIZE, sizeof(uint8_t));
-        if (!pass_hash) {
-            return 1;
-        }
         char *pass = calloc(SHA256_DIGEST_SIZE * 2 + 1, sizeof(char));
-        if (!pass) {
-            return 1;
+        if (!pass_hash || !pass) {
+            free(pass_hash);
+            free(pass);
+            ret = 1;
+            goto cleanup;
         }
         struct sha256_ctx ctx;
         sha256_init(&ctx);
@@ -601,7 +1885,9 @@ int fetch_json(storj_http_options_t *http_options,
         int user_pass_len = strlen(options->user) + 1 + strlen(pass);
         user_pass = calloc(user_pass_len + 1, sizeof(char));
         if (!user_pass) {
-            return 1;
+            free(pass);
+            ret = 1;
+            goto cleanup;
         }
         strcat(user_pass, options->user);
         strcat(user_pass, ":");
@@ -613,10 +1899,7 @@ int fetch_json(storj_http_options_t *http_options,
 
     }
 
-    struct curl_slist *header_list = NULL;
-
     // Include body if request body json is provided
-    http_body_send_t *post_body = NULL;
     const char *req_buf = NULL;
     if (request_body) {
         req_buf = json_object_to_json_string(request_body);
@@ -628,7 +1911,8 @@ int fetch_json(storj_http_options_t *http_options,
 
         post_body = malloc(sizeof(http_body_send_t));
         if (!post_body) {
-            return 1;
+            ret = 1;
+            goto cleanup;
         }
         post_body->pnt = (char *)req_buf;
         post_body->remain = strlen(req_buf);
@@ -642,47 +1926,114 @@ int fetch_json(storj_http_options_t *http_options,
         curl_easy_setopt(curl, CURLOPT_HTTPHEADER, header_list);
     }
 
-    int ret = 0;
     int req = curl_easy_perform(curl);
 
+    // set the status code, also when the body handler stopped the request
+    long int _status_code = 0;
+    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &_status_code);
+    *status_code = (int)_status_code;
+
+    if (req != CURLE_OK) {
+        ret = req;
+    }
+
+cleanup:
     free(url);
 
     if (header_list) {
         curl_slist_free_all(header_list);
     }
 
-    if (post_body) {
-        free(post_body);
-    }
+    free(post_body);
+    free(user_pass);
 
-    if (user_pass) {
-        free(user_pass);
-    }
+    // the handle is given back to the pool after any error
+    http_pool_release(http_options, curl, options->proto, options->host,
+                      options->port);
+
+    return ret;
+}
 
+int fetch_json(storj_http_options_t *http_options,
+               storj_bridge_options_t *options,
+               char *method,
+               char *path,
+               struct json_object *request_body,
+               bool auth,
+               struct json_object **response,
+               int *status_code)
+{
     *response = NULL;
 
-    if (req != CURLE_OK) {
-        ret = req;
-        goto cleanup;
+    http_body_receive_t *body = malloc(sizeof(http_body_receive_t));
+    if (!body) {
+        return 1;
     }
+    body->data = NULL;
+    body->length = 0;
 
-    // set the status code
-    long int _status_code;
-    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &_status_code);
-    *status_code = (int)_status_code;
+    int ret = fetch_request(http_options, options, method, path,
+                            request_body, auth, body_json_receive, body,
+                            status_code);
 
-    if (body->data && body->length > 0) {
+    if (!ret && body->data && body->length > 0) {
         *response = json_tokener_parse((char *)body->data);
     }
 
-cleanup:
-    curl_easy_cleanup(curl);
     if (body->data) {
         free(body->data);
     }
-    if (body) {
-        free(body);
+    free(body);
+
+    return ret;
+}
+
+int fetch_json_stream(storj_http_options_t *http_options,
+                      storj_bridge_options_t *options,
+                      char *method,
+                      char *path,
+                      struct json_object *request_body,
+                      bool auth,
+                      json_stream_cb cb,
+                      void *handle,
+                      struct json_object **response,
+                      int *status_code)
+{
+    *response = NULL;
+
+    json_stream_t stream = {
+        .cb = cb,
+        .handle = handle,
+        .response = response,
+        .data = NULL,
+        .length = 0,
+        .size = 0,
+        .depth = 0,
+        .started = false,
+        .is_array = false,
+        .in_string = false,
+        .escaped = false,
+        .stopped = false,
+        .error_code = 0
+    };
+
+    int ret = fetch_request(http_options, options, method, path,
+                            request_body, auth, body_json_stream_receive,
+                            &stream, status_code);
+
+    if (stream.stopped) {
+        // the callback has all it needs, the rest of the body is dropped
+        ret = 0;
+    } else if (stream.error_code) {
+        ret = stream.error_code;
+    } else if (!ret && stream.is_array && stream.depth != 0) {
+        ret = 1;
+    } else if (!ret && !stream.is_array && stream.length > 0) {
+        stream.data[stream.length] = '\0';
+        *response = json_tokener_parse(stream.data);
     }
 
+    free(stream.data);
+
     return ret;
 }
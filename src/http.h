@@ -21,6 +21,18 @@
 
 #define SHARD_PROGRESS_INTERVAL BUFSIZ * 8
 
+// alignment of transfer buffers and of direct io writes
+#define TRANSFER_BUFFER_ALIGNMENT 4096
+
+// the largest upload buffer curl allows
+#define SHARD_UPLOAD_BUFFER_MAX 2097152L
+
+// milliseconds between sharing out bandwidth to rate limited transfers
+#define SHARD_BANDWIDTH_INTERVAL 20
+
+// milliseconds of bandwidth that can be saved up while transfers are idle
+#define SHARD_BANDWIDTH_BURST 100
+
 /** @brief A structure for sharing download progress state between threads.
  *
  * This structure is used to send async updates from a worker thread
@@ -47,6 +59,12 @@ typedef struct {
     void *state;
 } shard_upload_progress_t;
 
+/** @brief The body of a shard being uploaded
+ *
+ * The next part of the shard is read from the file into the read buffer
+ * by the event loop while the buffer is being sent, the transfer is paused
+ * if the read hasn't finished once the buffer has been sent.
+ */
 typedef struct {
     FILE *fd;
     storj_encryption_ctx_t *ctx;
@@ -58,12 +76,43 @@ typedef struct {
     uv_async_t *progress_handle;
     int error_code;
     bool *canceled;
+    struct shard_transfer *transfer;
+    uint8_t *buffer;
+    size_t buffer_length;
+    size_t buffer_position;
+    uint8_t *read_buffer;
+    size_t read_length;
+    size_t read_done;
+    uint64_t read_position;
+    uint64_t read_remain;
+    uv_fs_t read_req;
+    bool reading;
+    bool read_ready;
+    bool paused;
 } shard_body_send_t;
 
+/** @brief The body of a shard being downloaded
+ *
+ * Data is received into the buffer, and hashed and decrypted while it's
+ * still in the cache. Shards in memory are received directly into the
+ * shard data, otherwise the buffer is written to the file by the event
+ * loop once full, while the next is received. The transfer is paused if
+ * the next buffer is full before the write has finished.
+ */
 typedef struct {
-    uint8_t *tail;
-    size_t tail_position;
-    size_t tail_length;
+    struct shard_transfer *transfer;
+    uint8_t *buffer;
+    size_t buffer_size;
+    size_t buffer_position;
+    size_t hashed_position;
+    uint8_t *write_buffer;
+    size_t write_length;
+    size_t write_done;
+    uint64_t write_position;
+    uv_fs_t write_req;
+    bool write_direct;
+    bool writing;
+    bool paused;
     uint8_t *data;
     size_t length;
     size_t bytes_since_progress;
@@ -71,8 +120,12 @@ typedef struct {
     uv_async_t *progress_handle;
     bool *canceled;
     struct sha256_ctx *sha256_ctx;
+    struct aes256_ctx *decrypt_ctx;
+    uint8_t decrypt_ctr[AES_BLOCK_SIZE];
     FILE *destination;
+    int direct_fd;
     uint64_t file_position;
+    uint8_t *shard_data;
     int error_code;
 } shard_body_receive_t;
 
@@ -86,24 +139,271 @@ typedef struct {
     uint64_t remain;
 } http_body_send_t;
 
+/** @brief A callback for each value parsed from a streamed JSON array.
+ *
+ * The callback takes ownership of the value, and returning non-zero stops
+ * the request without reading the rest of the response.
+ */
+typedef int (*json_stream_cb)(struct json_object *value, void *handle);
+
+/** @brief The state of parsing a JSON response as it is received.
+ *
+ * Only the value currently being received is buffered, the depth and
+ * string state are tracked to find where each element of the top level
+ * array ends.
+ */
+typedef struct {
+    json_stream_cb cb;
+    void *handle;
+    struct json_object **response;
+    char *data;
+    size_t length;
+    size_t size;
+    int depth;
+    bool started;
+    bool is_array;
+    bool in_string;
+    bool escaped;
+    bool stopped;
+    int error_code;
+} json_stream_t;
+
+/** @brief An idle easy handle kept open for reuse.
+ *
+ * The key is the "proto://host:port" the handle last connected to, so
+ * that a handle is handed back out for the same host and can reuse its
+ * open connection.
+ */
+typedef struct {
+    CURL *curl;
+    char *key;
+} http_pool_handle_t;
+
+/** @brief A pool of reusable curl easy handles for an environment.
+ *
+ * Handles are shared between worker threads, and all of the handles share
+ * a DNS cache and TLS session cache through the share handle. Each idle
+ * handle keeps its own open connection to its host.
+ */
+typedef struct storj_http_pool {
+    CURLSH *share;
+    uv_mutex_t share_locks[CURL_LOCK_DATA_LAST];
+    uv_mutex_t lock;
+    http_pool_handle_t *idle;
+    uint32_t idle_count;
+    uint32_t max_idle;
+} storj_http_pool_t;
+
+/**
+ * @brief Create a pool of reusable curl handles
+ *
+ * @param[in] max_idle The maximum number of idle handles to keep open
+ * @return A pointer to the pool or NULL on error
+ */
+storj_http_pool_t *http_pool_new(uint32_t max_idle);
+
+/**
+ * @brief Close all idle handles and free the pool
+ *
+ * @param[in] pool The pool to destroy
+ */
+void http_pool_destroy(storj_http_pool_t *pool);
+
+/**
+ * @brief Get an easy handle for a host, reusing an idle one if available
+ *
+ * @param[in] http_options The HTTP options including the pool
+ * @param[in] proto The protocol "http" or "https"
+ * @param[in] host The host address
+ * @param[in] port The port
+ * @return A curl easy handle or NULL on error
+ */
+CURL *http_pool_acquire(storj_http_options_t *http_options,
+                        const char *proto,
+                        const char *host,
+                        int port);
+
+/**
+ * @brief Return an easy handle to the pool once a request has finished
+ *
+ * The handle options are reset, open connections are kept for the next
+ * request to the same host. When the pool is full the handle is closed.
+ *
+ * @param[in] http_options The HTTP options including the pool
+ * @param[in] curl The easy handle
+ * @param[in] proto The protocol "http" or "https"
+ * @param[in] host The host address
+ * @param[in] port The port
+ */
+void http_pool_release(storj_http_options_t *http_options,
+                       CURL *curl,
+                       const char *proto,
+                       const char *host,
+                       int port);
+
+/** @brief A function signature called on the event loop once a shard
+ * transfer has finished.
+ *
+ * The error status is non-zero if the transfer failed, and the io code has
+ * the errno of any error reading or writing the shard data.
+ */
+typedef void (*shard_transfer_cb)(int error_status,
+                                  int status_code,
+                                  int io_code,
+                                  void *handle);
+
+/** @brief Event loop driven transfers for an environment.
+ *
+ * Shard transfers are added to a curl multi handle, with the sockets
+ * watched by the event loop, so that any number of transfers can run
+ * without taking a thread each.
+ *
+ * The rate limits of the http options are token buckets shared by all
+ * transfers, refilled as time passes. A transfer that has used up its
+ * allowance while the bucket is empty is paused, and the bandwidth timer
+ * shares the bucket between the paused transfers by their weights.
+ */
+typedef struct storj_http_multi {
+    CURLM *multi;
+    uv_loop_t *loop;
+    uv_timer_t *timer;
+    uv_timer_t *cancel_timer;
+    uv_timer_t *bandwidth_timer;
+    storj_http_options_t *http_options;
+    uint32_t running;
+    // the transfers that have been added to the multi handle
+    struct shard_transfer *transfers;
+    // buffers kept for the next transfers, two for each idle connection
+    uint8_t **transfer_buffers;
+    uint32_t transfer_buffer_count;
+    // bytes that can be transferred without waiting for the timer
+    uint64_t upload_tokens;
+    uint64_t download_tokens;
+    uint64_t bandwidth_time;
+    // guards the rate limits of the http options, they can be changed from
+    // any thread
+    uv_mutex_t rate_lock;
+} storj_http_multi_t;
+
+/** @brief A socket of the multi handle watched by the event loop
+ */
+typedef struct {
+    curl_socket_t sockfd;
+    uv_poll_t poll_handle;
+    storj_http_multi_t *multi;
+} http_socket_t;
+
+typedef struct shard_transfer shard_transfer_t;
+
+/** @brief A shard transfer running on the multi handle
+ */
+struct shard_transfer {
+    storj_http_multi_t *multi;
+    CURL *curl;
+    char *url;
+    char *proto;
+    char *host;
+    int port;
+    struct curl_slist *headers;
+    shard_body_send_t *send_body;
+    shard_body_receive_t *receive_body;
+    char *shard_hash;
+    uint64_t shard_total_bytes;
+    uv_async_t *progress_handle;
+    bool *canceled;
+    // the share of the rate limit, and the bytes it's allowed to transfer
+    uint32_t weight;
+    int64_t allowance;
+    // paused until it's given bandwidth by the timer
+    bool throttled;
+    bool throttle_resume;
+    void (*finish)(shard_transfer_t *transfer, CURLcode result);
+    // the transfer has finished and is waiting for file reads or writes
+    bool completed;
+    CURLcode result;
+    int error_status;
+    int status_code;
+    int io_code;
+    shard_transfer_cb cb;
+    void *handle;
+    shard_transfer_t *prev;
+    shard_transfer_t *next;
+};
+
+/**
+ * @brief Create the multi handle for running transfers on an event loop
+ *
+ * @param[in] loop The event loop
+ * @param[in] http_options The HTTP options including the pool
+ * @return A pointer to the multi or NULL on error
+ */
+storj_http_multi_t *http_multi_new(uv_loop_t *loop,
+                                   storj_http_options_t *http_options);
+
+/**
+ * @brief Clean up the multi handle once all transfers have finished
+ *
+ * @param[in] multi The multi to destroy
+ */
+void http_multi_destroy(storj_http_multi_t *multi);
+
+/**
+ * @brief Change the rate limits of the transfers of a multi handle
+ *
+ * The limits are read by the transfers on the loop thread and can be
+ * changed from any thread.
+ *
+ * @param[in] multi The multi of the transfers
+ * @param[in] upload_rate_limit The upload limit in bytes per second, or 0
+ * @param[in] download_rate_limit The download limit in bytes per second,
+ * or 0
+ */
+void http_multi_set_rate_limits(storj_http_multi_t *multi,
+                                uint64_t upload_rate_limit,
+                                uint64_t download_rate_limit);
+
+/**
+ * @brief Stop the transfers that have been canceled
+ *
+ * A canceled transfer otherwise only stops once curl calls back for it,
+ * which may not happen while it's waiting on a farmer that has stalled.
+ * The transfers are removed on the next iteration of the loop, and their
+ * callbacks are called with an error.
+ *
+ * @param[in] multi The multi handle of the transfers
+ */
+void http_multi_cancel_transfers(storj_http_multi_t *multi);
+
 /**
  * @brief Send a shard to a farmer via an HTTP request
  *
- * @param[in] http_options The HTTP options including proxy
+ * The transfer runs on the event loop of the multi, and must be started
+ * from the event loop thread. The callback is called once it has finished.
+ *
+ * The shard is read from the file one buffer at a time while the previous
+ * buffer is sent. When an encryption context is given the data is
+ * encrypted as it's sent, and the plain data is cleared from the buffers
+ * once the transfer has finished.
+ *
+ * @param[in] multi The multi handle to run the transfer on
  * @param[in] farmer_id The farmer id
  * @param[in] proto The protocol "http" or "https"
  * @param[in] host The farmer host address
  * @param[in] port The farmer port
  * @param[in] shard_hash The hash of the shard to send
  * @param[in] shard_total_bytes The total bytes of the shard
- * @param[in] shard_data The actual bytes
+ * @param[in] original_file The file to read the shard from
+ * @param[in] file_position The position of the shard in the file
+ * @param[in] ctx The encryption context or NULL if already encrypted
  * @param[in] token The farmer token for uploading
- * @param[in] status_code The HTTP response status code
  * @param[in] progress_handle The async handle for progress updates
  * @param[in] canceled Pointer for canceling uploads
- * @return A non-zero error value on failure and 0 on success.
+ * @param[in] weight The share of the upload rate limit for the transfer
+ * @param[in] cb The callback when the transfer has finished
+ * @param[in] handle A pointer passed to the callback
+ * @return A non-zero error value if the transfer could not be started
  */
-int put_shard(storj_http_options_t *http_options,
+int put_shard(storj_http_multi_t *multi,
               char *farmer_id,
               char *proto,
               char *host,
@@ -114,29 +414,43 @@ int put_shard(storj_http_options_t *http_options,
               uint64_t file_position,
               storj_encryption_ctx_t *ctx,
               char *token,
-              int *status_code,
-              int *read_code,
               uv_async_t *progress_handle,
-              bool *canceled);
+              bool *canceled,
+              uint32_t weight,
+              shard_transfer_cb cb,
+              void *handle);
 
 /**
  * @brief Make a HTTP request for a shard
  *
- * @param[in] http_options The HTTP options including proxy
+ * The transfer runs on the event loop of the multi, and must be started
+ * from the event loop thread. The callback is called once it has finished.
+ *
+ * When a decryption key is given the shard is hashed as it's received and
+ * then decrypted before it's written, the hash is checked against the
+ * encrypted data.
+ *
+ * @param[in] multi The multi handle to run the transfer on
  * @param[in] farmer_id The farmer id
  * @param[in] proto The protocol "http" or "https"
  * @param[in] host The farmer host address
  * @param[in] port The farmer port
  * @param[in] shard_hash The hash of the shard to fetch
  * @param[in] shard_total_bytes The total bytes of the shard
- * @param[in] shard_data The actual bytes
  * @param[in] token The farmer token for downloading
- * @param[in] status_code The HTTP response status code
+ * @param[in] destination The file to write the shard to
+ * @param[in] file_position The position of the shard in the file
+ * @param[in] shard_data Memory to write the shard to instead of the file
+ * @param[in] decrypt_key The key to decrypt the shard with, or NULL
+ * @param[in] decrypt_ctr The counter at the start of the shard, or NULL
  * @param[in] progress_handle The async handle for progress updates
  * @param[in] canceled Pointer for canceling downloads
- * @return A non-zero error value on failure and 0 on success.
+ * @param[in] weight The share of the download rate limit for the transfer
+ * @param[in] cb The callback when the transfer has finished
+ * @param[in] handle A pointer passed to the callback
+ * @return A non-zero error value if the transfer could not be started
  */
-int fetch_shard(storj_http_options_t *http_options,
+int fetch_shard(storj_http_multi_t *multi,
                 char *farmer_id,
                 char *proto,
                 char *host,
@@ -146,10 +460,14 @@ int fetch_shard(storj_http_options_t *http_options,
                 char *token,
                 FILE *destination,
                 uint64_t file_position,
-                int *status_code,
-                int *write_code,
+                uint8_t *shard_data,
+                const uint8_t *decrypt_key,
+                const uint8_t *decrypt_ctr,
                 uv_async_t *progress_handle,
-                bool *canceled);
+                bool *canceled,
+                uint32_t weight,
+                shard_transfer_cb cb,
+                void *handle);
 
 /**
  * @brief Make a JSON HTTP request
@@ -171,5 +489,34 @@ int fetch_json(storj_http_options_t *http_options,
                struct json_object **response,
                int *status_code);
 
+/**
+ * @brief Make a JSON HTTP request and parse the response as it is received
+ *
+ * When the response is an array, response is set to an empty array as soon
+ * as it begins, and each element is passed to the callback once it has been
+ * received. Any other response is parsed into response when complete.
+ *
+ * @param[in] options The storj bridge options
+ * @param[in] method The HTTP method
+ * @param[in] path The path of the resource
+ * @param[in] request_body A json object of the request body
+ * @param[in] auth Boolean to include authentication
+ * @param[in] cb The callback for each element of an array response
+ * @param[in] handle A pointer that will be available in the callback
+ * @param[out] response The response array or the complete response
+ * @param[out] status_code The resulting status code from the request
+ * @return A non-zero error value on failure and 0 on success.
+ */
+int fetch_json_stream(storj_http_options_t *http_options,
+                      storj_bridge_options_t *options,
+                      char *method,
+                      char *path,
+                      struct json_object *request_body,
+                      bool auth,
+                      json_stream_cb cb,
+                      void *handle,
+                      struct json_object **response,
+                      int *status_code);
+
 
 #endif /* STORJ_HTTP_H */
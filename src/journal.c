@@ -0,0 +1,257 @@
+#include "journal.h"
+
+static int truncate_journal(storj_journal_t *journal, long length)
+{
+    if (fflush(journal->fd)) {
+        return STORJ_FILE_JOURNAL_ERROR;
+    }
+
+#ifdef _WIN32
+    if (_chsize_s(fileno(journal->fd), length)) {
+        return STORJ_FILE_JOURNAL_ERROR;
+    }
+#else
+    if (ftruncate(fileno(journal->fd), length)) {
+        return STORJ_FILE_JOURNAL_ERROR;
+    }
+#endif
+
+    if (fseek(journal->fd, length, SEEK_SET)) {
+        return STORJ_FILE_JOURNAL_ERROR;
+    }
+
+    return 0;
+}
+
+static void free_records(storj_journal_t *journal)
+{
+    for (int i = 0; i < journal->length; i++) {
+        free(journal->records[i].name);
+        free(journal->records[i].value);
+    }
+
+    free(journal->records);
+    journal->records = NULL;
+    journal->length = 0;
+    journal->size = 0;
+}
+
+static int add_record(storj_journal_t *journal, const char *name,
+                      uint32_t index, const char *value)
+{
+    if (journal->length == journal->size) {
+        uint32_t size = (journal->size > 0) ? journal->size * 2 : 16;
+        storj_journal_record_t *records =
+            realloc(journal->records, size * sizeof(storj_journal_record_t));
+        if (!records) {
+            return STORJ_MEMORY_ERROR;
+        }
+        journal->records = records;
+        journal->size = size;
+    }
+
+    storj_journal_record_t *record = &journal->records[journal->length];
+
+    record->name = strdup(name);
+    record->value = strdup(value);
+    if (!record->name || !record->value) {
+        free(record->name);
+        free(record->value);
+        return STORJ_MEMORY_ERROR;
+    }
+    record->index = index;
+
+    journal->length += 1;
+
+    return 0;
+}
+
+// Read a complete line, without the line break. A line without a line
+// break was being written when the transfer stopped.
+static bool read_line(FILE *fd, char *line)
+{
+    if (!fgets(line, STORJ_JOURNAL_LINE_SIZE, fd)) {
+        return false;
+    }
+
+    size_t length = strlen(line);
+    if (length == 0 || line[length - 1] != '\n') {
+        return false;
+    }
+
+    line[length - 1] = '\0';
+
+    return true;
+}
+
+// Split a line of "<name> <index> <value>" in place
+static bool parse_record(char *line, char **name, uint32_t *index,
+                         char **value)
+{
+    char *index_str = strchr(line, ' ');
+    if (!index_str) {
+        return false;
+    }
+    *index_str = '\0';
+    index_str += 1;
+
+    char *value_str = strchr(index_str, ' ');
+    if (!value_str) {
+        return false;
+    }
+    *value_str = '\0';
+    value_str += 1;
+
+    char *end = NULL;
+    unsigned long parsed_index = strtoul(index_str, &end, 10);
+    if (end == index_str || *end != '\0' || parsed_index > UINT32_MAX) {
+        return false;
+    }
+
+    *name = line;
+    *index = parsed_index;
+    *value = value_str;
+
+    return true;
+}
+
+int journal_open(const char *path, const char *identity,
+                 storj_journal_t **journal)
+{
+    int status = 0;
+    char *line = NULL;
+
+    storj_journal_t *j = calloc(1, sizeof(storj_journal_t));
+    if (!j) {
+        return STORJ_MEMORY_ERROR;
+    }
+
+    j->path = strdup(path);
+    if (!j->path) {
+        status = STORJ_MEMORY_ERROR;
+        goto cleanup;
+    }
+
+    j->fd = fopen(path, "r+b");
+    if (!j->fd) {
+        j->fd = fopen(path, "w+b");
+    }
+    if (!j->fd) {
+        status = STORJ_FILE_JOURNAL_ERROR;
+        goto cleanup;
+    }
+
+    line = malloc(STORJ_JOURNAL_LINE_SIZE);
+    if (!line) {
+        status = STORJ_MEMORY_ERROR;
+        goto cleanup;
+    }
+
+    if (!read_line(j->fd, line) || 0 != strcmp(line, identity)) {
+        status = journal_reset(j, identity);
+        goto cleanup;
+    }
+
+    long valid_length = ftell(j->fd);
+
+    while (read_line(j->fd, line)) {
+        char *name = NULL;
+        char *value = NULL;
+        uint32_t index = 0;
+
+        if (!parse_record(line, &name, &index, &value)) {
+            break;
+        }
+
+        status = add_record(j, name, index, value);
+        if (status) {
+            goto cleanup;
+        }
+
+        valid_length = ftell(j->fd);
+    }
+
+    // records are appended after the last complete line
+    status = truncate_journal(j, valid_length);
+
+cleanup:
+    free(line);
+
+    if (status) {
+        journal_close(j, false);
+        return status;
+    }
+
+    *journal = j;
+
+    return 0;
+}
+
+const char *journal_find(storj_journal_t *journal, const char *name,
+                         uint32_t index)
+{
+    // a later record replaces an earlier one
+    for (int i = (int)journal->length - 1; i >= 0; i--) {
+        storj_journal_record_t *record = &journal->records[i];
+        if (record->index == index && 0 == strcmp(record->name, name)) {
+            return record->value;
+        }
+    }
+
+    return NULL;
+}
+
+int journal_append(storj_journal_t *journal, const char *name,
+                   uint32_t index, const char *value)
+{
+    if (strchr(name, ' ') || strchr(name, '\n') || strchr(value, '\n')) {
+        return STORJ_FILE_JOURNAL_ERROR;
+    }
+
+    int status = add_record(journal, name, index, value);
+    if (status) {
+        return status;
+    }
+
+    if (fprintf(journal->fd, "%s %" PRIu32 " %s\n", name, index, value) < 0 ||
+        fflush(journal->fd)) {
+        return STORJ_FILE_JOURNAL_ERROR;
+    }
+
+    return 0;
+}
+
+int journal_reset(storj_journal_t *journal, const char *identity)
+{
+    free_records(journal);
+
+    int status = truncate_journal(journal, 0);
+    if (status) {
+        return status;
+    }
+
+    if (fprintf(journal->fd, "%s\n", identity) < 0 || fflush(journal->fd)) {
+        return STORJ_FILE_JOURNAL_ERROR;
+    }
+
+    return 0;
+}
+
+void journal_close(storj_journal_t *journal, bool remove)
+{
+    if (!journal) {
+        return;
+    }
+
+    if (journal->fd) {
+        fclose(journal->fd);
+    }
+
+    if (remove && journal->path) {
+        unlink(journal->path);
+    }
+
+    free_records(journal);
+    free(journal->path);
+    free(journal);
+}
@@ -0,0 +1,94 @@
+/**
+ * @file journal.h
+ * @brief Storj transfer journal.
+ *
+ * A journal is a file of the completed steps of a transfer, so that an
+ * upload or download can continue from where it stopped when the process
+ * exits before it has finished.
+ */
+#ifndef STORJ_JOURNAL_H
+#define STORJ_JOURNAL_H
+
+#include "storj.h"
+#include "utils.h"
+
+#define STORJ_JOURNAL_LINE_SIZE 4096
+
+/** @brief A completed step of a transfer, such as a pushed shard
+ */
+typedef struct {
+    char *name;
+    uint32_t index;
+    char *value;
+} storj_journal_record_t;
+
+/** @brief The records of a transfer journal
+ *
+ * The first line of the file identifies the transfer, followed by a line
+ * for each record as "<name> <index> <value>". Records are appended and
+ * flushed as they are added, a line that wasn't completed is discarded
+ * when the journal is opened again.
+ */
+typedef struct storj_journal {
+    char *path;
+    FILE *fd;
+    storj_journal_record_t *records;
+    uint32_t length;
+    uint32_t size;
+} storj_journal_t;
+
+/**
+ * @brief Open a journal and read the records of an earlier attempt
+ *
+ * The records are kept if the journal is of the same transfer, otherwise
+ * the journal is replaced by an empty journal of the identity.
+ *
+ * @param[in] path The path of the journal file
+ * @param[in] identity A line that identifies the transfer
+ * @param[out] journal The opened journal
+ * @return A non-zero error value on failure and 0 on success.
+ */
+int journal_open(const char *path, const char *identity,
+                 storj_journal_t **journal);
+
+/**
+ * @brief Find the value of the last record with a name and index
+ *
+ * @param[in] journal The journal
+ * @param[in] name The name of the record
+ * @param[in] index The index of the record
+ * @return The value or NULL if there isn't a record.
+ */
+const char *journal_find(storj_journal_t *journal, const char *name,
+                         uint32_t index);
+
+/**
+ * @brief Add a record and write it to the journal file
+ *
+ * @param[in] journal The journal
+ * @param[in] name The name of the record, without spaces
+ * @param[in] index The index of the record
+ * @param[in] value The value of the record, without line breaks
+ * @return A non-zero error value on failure and 0 on success.
+ */
+int journal_append(storj_journal_t *journal, const char *name,
+                   uint32_t index, const char *value);
+
+/**
+ * @brief Remove all records, keeping the identity
+ *
+ * @param[in] journal The journal
+ * @param[in] identity A line that identifies the transfer
+ * @return A non-zero error value on failure and 0 on success.
+ */
+int journal_reset(storj_journal_t *journal, const char *identity);
+
+/**
+ * @brief Close a journal and free its memory
+ *
+ * @param[in] journal The journal
+ * @param[in] remove Delete the journal file, once the transfer is complete
+ */
+void journal_close(storj_journal_t *journal, bool remove);
+
+#endif /* STORJ_JOURNAL_H */
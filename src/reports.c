@@ -0,0 +1,374 @@
+#include "reports.h"
+
+static void free_report_timer(uv_handle_t *timer)
+{
+    free(timer);
+}
+
+static void free_report(storj_exchange_report_t *report)
+{
+    free(report->data_hash);
+    free(report->reporter_id);
+    free(report->farmer_id);
+    free(report->client_id);
+}
+
+static char *strdup_null(const char *str)
+{
+    return (str) ? strdup(str) : NULL;
+}
+
+static void free_report_batch(report_batch_t *batch)
+{
+    for (uint32_t i = 0; i < batch->length; i++) {
+        free_report(&batch->reports[i]);
+    }
+
+    free(batch->reports);
+    free(batch->status_codes);
+
+    http_pool_destroy(batch->http_options.pool);
+    free((char *)batch->http_options.user_agent);
+    free((char *)batch->http_options.proxy_url);
+    free((char *)batch->http_options.cainfo_path);
+
+    free((char *)batch->options.proto);
+    free((char *)batch->options.host);
+    free((char *)batch->options.user);
+    if (batch->options.pass) {
+        memset_zero((char *)batch->options.pass, strlen(batch->options.pass));
+        free((char *)batch->options.pass);
+    }
+
+    free(batch);
+}
+
+static int copy_batch_options(report_batch_t *batch, storj_env_t *env)
+{
+    storj_http_options_t *http_options = env->http_options;
+    storj_bridge_options_t *options = env->bridge_options;
+
+    batch->http_options = *http_options;
+    batch->http_options.user_agent = strdup_null(http_options->user_agent);
+    batch->http_options.proxy_url = strdup_null(http_options->proxy_url);
+    batch->http_options.cainfo_path = strdup_null(http_options->cainfo_path);
+
+    // The reports of a batch are sent one after another on one connection
+    batch->http_options.pool = http_pool_new(1);
+
+    batch->options = *options;
+    batch->options.proto = strdup_null(options->proto);
+    batch->options.host = strdup_null(options->host);
+    batch->options.user = strdup_null(options->user);
+    batch->options.pass = strdup_null(options->pass);
+
+    if ((http_options->user_agent && !batch->http_options.user_agent) ||
+        (http_options->proxy_url && !batch->http_options.proxy_url) ||
+        (http_options->cainfo_path && !batch->http_options.cainfo_path) ||
+        !batch->http_options.pool ||
+        (options->proto && !batch->options.proto) ||
+        (options->host && !batch->options.host) ||
+        (options->user && !batch->options.user) ||
+        (options->pass && !batch->options.pass)) {
+        return STORJ_MEMORY_ERROR;
+    }
+
+    return 0;
+}
+
+static int append_report(storj_report_queue_t *queue,
+                         storj_exchange_report_t *report)
+{
+    if (queue->length == queue->size) {
+        uint32_t size = (queue->size > 0) ? queue->size * 2 : 16;
+        storj_exchange_report_t *reports =
+            realloc(queue->reports, size * sizeof(storj_exchange_report_t));
+        if (!reports) {
+            return STORJ_MEMORY_ERROR;
+        }
+        queue->reports = reports;
+        queue->size = size;
+    }
+
+    queue->reports[queue->length] = *report;
+    queue->length += 1;
+
+    return 0;
+}
+
+storj_report_queue_t *report_queue_new(storj_env_t *env)
+{
+    storj_report_queue_t *queue = calloc(1, sizeof(storj_report_queue_t));
+    if (!queue) {
+        return NULL;
+    }
+
+    queue->timer = malloc(sizeof(uv_timer_t));
+    if (!queue->timer) {
+        free(queue);
+        return NULL;
+    }
+
+    queue->env = env;
+
+    uv_timer_init(env->loop, queue->timer);
+    queue->timer->data = queue;
+
+    return queue;
+}
+
+static void send_reports(uv_work_t *work)
+{
+    report_batch_t *batch = work->data;
+
+    // The reports are sent one after another on the same connection
+    for (uint32_t i = 0; i < batch->length; i++) {
+        storj_exchange_report_t *report = &batch->reports[i];
+
+        struct json_object *body = json_object_new_object();
+
+        json_object_object_add(body, "dataHash",
+                               json_object_new_string(report->data_hash));
+
+        json_object_object_add(body, "reporterId",
+                               json_object_new_string(report->reporter_id));
+
+        json_object_object_add(body, "farmerId",
+                               json_object_new_string(report->farmer_id));
+
+        json_object_object_add(body, "clientId",
+                               json_object_new_string(report->client_id));
+
+        json_object_object_add(body, "exchangeStart",
+                               json_object_new_int64(report->start));
+
+        json_object_object_add(body, "exchangeEnd",
+                               json_object_new_int64(report->end));
+
+        json_object_object_add(body, "exchangeResultCode",
+                               json_object_new_int(report->code));
+
+        json_object_object_add(body, "exchangeResultMessage",
+                               json_object_new_string(report->message));
+
+        int status_code = 0;
+
+        // there should be an empty object in response
+        struct json_object *response = NULL;
+        fetch_json(&batch->http_options, &batch->options, "POST",
+                   "/reports/exchanges", body, true, &response,
+                   &status_code);
+
+        batch->status_codes[i] = status_code;
+
+        if (response) {
+            json_object_put(response);
+        }
+        json_object_put(body);
+    }
+}
+
+static void send_report_batch(storj_report_queue_t *queue);
+
+static void flush_reports(uv_timer_t *timer)
+{
+    send_report_batch(timer->data);
+}
+
+static void start_flush_timer(storj_report_queue_t *queue)
+{
+    if (!uv_is_active((uv_handle_t *)queue->timer)) {
+        uv_timer_start(queue->timer, flush_reports,
+                       STORJ_REPORT_FLUSH_INTERVAL, 0);
+    }
+}
+
+static void after_send_reports(uv_work_t *work, int status)
+{
+    report_batch_t *batch = work->data;
+    storj_report_queue_t *queue = batch->queue;
+
+    free(work);
+
+    // the queue was destroyed while the batch was being sent
+    if (!queue) {
+        free_report_batch(batch);
+        return;
+    }
+
+    queue->batch = NULL;
+
+    storj_env_t *env = queue->env;
+    uint32_t sent = 0;
+
+    for (uint32_t i = 0; i < batch->length; i++) {
+        storj_exchange_report_t *report = &batch->reports[i];
+
+        if (batch->status_codes[i] == 201) {
+            sent += 1;
+        } else if (status != UV_ECANCELED &&
+                   report->send_count < STORJ_MAX_REPORT_TRIES &&
+                   !append_report(queue, report)) {
+            // the report is owned by the queue again
+            continue;
+        } else {
+            env->log->warn(env->log_options, NULL,
+                           "Failed to send exchange report for shard %s",
+                           report->data_hash);
+        }
+
+        free_report(report);
+    }
+
+    // the reports left in the batch have been queued again
+    batch->length = 0;
+    free_report_batch(batch);
+
+    env->log->debug(env->log_options, NULL,
+                    "Sent %" PRIu32 " exchange reports, %" PRIu32 " queued",
+                    sent, queue->length);
+
+    if (queue->length == 0) {
+        queue->flushing = false;
+    } else if (queue->flushing || queue->length >= STORJ_REPORT_BATCH_SIZE) {
+        send_report_batch(queue);
+    } else {
+        start_flush_timer(queue);
+    }
+}
+
+static void send_report_batch(storj_report_queue_t *queue)
+{
+    if (queue->batch || queue->length == 0) {
+        return;
+    }
+
+    uv_timer_stop(queue->timer);
+
+    uint32_t length = queue->length;
+    if (length > STORJ_REPORT_BATCH_SIZE) {
+        length = STORJ_REPORT_BATCH_SIZE;
+    }
+
+    uv_work_t *work = malloc(sizeof(uv_work_t));
+    report_batch_t *batch = calloc(1, sizeof(report_batch_t));
+    if (!work || !batch) {
+        goto error;
+    }
+
+    batch->reports = malloc(length * sizeof(storj_exchange_report_t));
+    batch->status_codes = calloc(length, sizeof(int));
+    if (!batch->reports || !batch->status_codes ||
+        copy_batch_options(batch, queue->env)) {
+        goto error;
+    }
+
+    memcpy(batch->reports, queue->reports,
+           length * sizeof(storj_exchange_report_t));
+    for (uint32_t i = 0; i < length; i++) {
+        batch->reports[i].send_status = STORJ_REPORT_SENDING;
+        batch->reports[i].send_count += 1;
+    }
+
+    batch->length = length;
+    batch->queue = queue;
+
+    work->data = batch;
+
+    if (uv_queue_work(queue->env->loop, work, send_reports,
+                      after_send_reports)) {
+        batch->length = 0;
+        goto error;
+    }
+
+    queue->length -= length;
+    memmove(queue->reports, queue->reports + length,
+            queue->length * sizeof(storj_exchange_report_t));
+
+    queue->batch = batch;
+
+    return;
+
+error:
+    // the reports stay in the queue and are tried again later
+    free(work);
+    if (batch) {
+        batch->length = 0;
+        free_report_batch(batch);
+    }
+    start_flush_timer(queue);
+}
+
+int report_queue_add(storj_report_queue_t *queue,
+                     storj_exchange_report_t *report)
+{
+    if (!report->farmer_id || report->start == 0 || report->end == 0) {
+        return 0;
+    }
+
+    storj_exchange_report_t copy = *report;
+
+    copy.data_hash = strdup_null(report->data_hash);
+    copy.reporter_id = strdup_null(report->reporter_id);
+    copy.farmer_id = strdup_null(report->farmer_id);
+    copy.client_id = strdup_null(report->client_id);
+    copy.send_status = STORJ_REPORT_AWAITING_SEND;
+    copy.send_count = 0;
+
+    if ((report->data_hash && !copy.data_hash) ||
+        (report->reporter_id && !copy.reporter_id) ||
+        !copy.farmer_id ||
+        (report->client_id && !copy.client_id) ||
+        append_report(queue, &copy)) {
+        free_report(&copy);
+        return STORJ_MEMORY_ERROR;
+    }
+
+    if (queue->length >= STORJ_REPORT_BATCH_SIZE) {
+        send_report_batch(queue);
+    } else {
+        start_flush_timer(queue);
+    }
+
+    return 0;
+}
+
+void report_queue_flush(storj_report_queue_t *queue)
+{
+    if (queue->length == 0) {
+        return;
+    }
+
+    queue->flushing = true;
+
+    send_report_batch(queue);
+}
+
+void report_queue_destroy(storj_report_queue_t *queue)
+{
+    if (!queue) {
+        return;
+    }
+
+    // a batch that is being sent is freed once the worker has finished
+    if (queue->batch) {
+        queue->batch->queue = NULL;
+    }
+
+    uv_timer_stop(queue->timer);
+    uv_close((uv_handle_t *)queue->timer, free_report_timer);
+
+    if (queue->length > 0) {
+        storj_env_t *env = queue->env;
+        env->log->warn(env->log_options, NULL,
+                       "Dropped %" PRIu32 " exchange reports that weren't sent",
+                       queue->length);
+    }
+
+    for (uint32_t i = 0; i < queue->length; i++) {
+        free_report(&queue->reports[i]);
+    }
+
+    free(queue->reports);
+    free(queue);
+}
@@ -0,0 +1,94 @@
+/**
+ * @file reports.h
+ * @brief Storj exchange report queue.
+ *
+ * The exchange reports of the shard transfers of an environment are queued
+ * and sent to the bridge in batches, so that transfers don't wait on the
+ * reports of their shards to continue or to finish.
+ */
+#ifndef STORJ_REPORTS_H
+#define STORJ_REPORTS_H
+
+#include "storj.h"
+#include "http.h"
+#include "utils.h"
+
+#define STORJ_MAX_REPORT_TRIES 3
+#define STORJ_REPORT_BATCH_SIZE 32
+#define STORJ_REPORT_FLUSH_INTERVAL 1000 // 1 second
+
+typedef struct report_batch report_batch_t;
+
+/** @brief The exchange reports waiting to be sent
+ *
+ * Reports are sent once a batch is full or after the flush interval, one
+ * batch at a time from a worker thread. A report that failed to send is
+ * queued again until it has been tried STORJ_MAX_REPORT_TRIES times. The
+ * queue is only used from the event loop thread.
+ */
+typedef struct storj_report_queue {
+    storj_env_t *env;
+    uv_timer_t *timer;
+    storj_exchange_report_t *reports;
+    uint32_t length;
+    uint32_t size;
+    // the batch being sent, and if the rest is sent once it has finished
+    report_batch_t *batch;
+    bool flushing;
+} storj_report_queue_t;
+
+/** @brief A structure for sharing a batch of reports with a worker thread
+ *
+ * The batch has its own copies of the options and its own connection pool,
+ * so that it can still be sent after the environment has been destroyed.
+ */
+struct report_batch {
+    storj_http_options_t http_options;
+    storj_bridge_options_t options;
+    storj_exchange_report_t *reports;
+    int *status_codes;
+    uint32_t length;
+    /* queue should not be modified in worker threads */
+    storj_report_queue_t *queue;
+};
+
+/**
+ * @brief Create the report queue of an environment
+ *
+ * @param[in] env The environment that the reports are sent with
+ * @return A null value on error, otherwise the queue.
+ */
+storj_report_queue_t *report_queue_new(storj_env_t *env);
+
+/**
+ * @brief Queue a copy of an exchange report to be sent
+ *
+ * Reports without a farmer or without exchange times are not sent.
+ *
+ * @param[in] queue The report queue
+ * @param[in] report The exchange report of a finished transfer
+ * @return A non-zero error value on failure and 0 on success.
+ */
+int report_queue_add(storj_report_queue_t *queue,
+                     storj_exchange_report_t *report);
+
+/**
+ * @brief Send the queued reports without waiting for the flush interval
+ *
+ * @param[in] queue The report queue
+ */
+void report_queue_flush(storj_report_queue_t *queue);
+
+/**
+ * @brief Free the report queue and the reports that haven't been sent
+ *
+ * Reports that are still queued are dropped, they can be sent before with
+ * report_queue_flush and by running the loop until the transfers are done.
+ * A batch that is being sent is finished by its worker and freed once the
+ * loop has run its completion.
+ *
+ * @param[in] queue The report queue
+ */
+void report_queue_destroy(storj_report_queue_t *queue);
+
+#endif /* STORJ_REPORTS_H */
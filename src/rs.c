@@ -56,6 +56,17 @@
 
 #include "rs.h"
 
+/*
+ * SIMD multiply-accumulate kernels are built for x86 with gcc/clang and
+ * selected at runtime in fec_init(). Define RS_NO_SIMD to force the
+ * portable table driven loops.
+ */
+#if !defined(RS_NO_SIMD) && defined(__GNUC__) && \
+    (defined(__x86_64__) || defined(__i386__))
+#define RS_HAVE_X86_SIMD 1
+#include <immintrin.h>
+#endif
+
 /*
  * stuff used for testing purposes only
  */
@@ -188,6 +199,14 @@ __attribute__((aligned (256)))
 #define GF_ADDMULC(dst, x) dst ^= __gf_mulc_[x]
 #define GF_MULC(dst, x) dst = __gf_mulc_[x]
 
+/*
+ * Split nibble tables for the SIMD kernels. For every constant c the
+ * first 16 bytes hold c * x and the next 16 bytes hold c * (x << 4) for
+ * x in 0..15, so that c * b == lo[b & 0x0f] ^ hi[b >> 4]. A byte shuffle
+ * then performs 16 (or 32) table lookups at once.
+ */
+static gf gf_mul_nibble[(GF_SIZE + 1)][32] __attribute__((aligned (16)));
+
 static void init_mul_table(void)
 {
     int i, j;
@@ -197,6 +216,13 @@ static void init_mul_table(void)
 
     for (j=0; j< GF_SIZE+1; j++)
         gf_mul_table[j] = gf_mul_table[j<<8] = 0;
+
+    for (i=0; i< GF_SIZE+1; i++) {
+        for (j=0; j< 16; j++) {
+            gf_mul_nibble[i][j] = gf_mul(i, j);
+            gf_mul_nibble[i][16 + j] = gf_mul(i, (j << 4));
+        }
+    }
 }
 
 /*
@@ -293,28 +319,105 @@ static void generate_gf(void)
     if (c != 0) addmul1(dst, src, c, sz, dst_max, src_max)
 #endif
 
+/*
+ * Only the first min(dst_max, src_max) bytes are touched: past src_max
+ * the source is assumed to be zero padding, which leaves dst unchanged.
+ */
 static void slow_addmul1(gf *dst1, gf *src1, gf c, uint64_t sz, uint64_t dst_max, uint64_t src_max)
 {
     USE_GF_MULC;
     register gf *dst = dst1, *src = src1;
     uint64_t low_max = dst_max < src_max ? dst_max : src_max;
-    uint64_t pos = 0;
     gf *lim = &dst[low_max];
+    gf *lim8 = &dst[low_max & ~(uint64_t)7];
 
     GF_MULC0(c);
 
+    for (; dst < lim8; dst += 8, src += 8) {
+        GF_ADDMULC( dst[0] , src[0] );
+        GF_ADDMULC( dst[1] , src[1] );
+        GF_ADDMULC( dst[2] , src[2] );
+        GF_ADDMULC( dst[3] , src[3] );
+        GF_ADDMULC( dst[4] , src[4] );
+        GF_ADDMULC( dst[5] , src[5] );
+        GF_ADDMULC( dst[6] , src[6] );
+        GF_ADDMULC( dst[7] , src[7] );
+    }
     for (; dst < lim; dst++, src++ ) {
-        if (pos < src_max && pos < dst_max) {
-            GF_ADDMULC( *dst , *src );
-        } else if (pos < dst_max) {
-            /* assume zero when past the max */
-            GF_ADDMULC( *dst , 0 );
-        }
-        pos += 1;
+        GF_ADDMULC( *dst , *src );
+    }
+}
+
+#ifdef RS_HAVE_X86_SIMD
+__attribute__((target("ssse3")))
+static void ssse3_addmul1(gf *dst, gf *src, gf c, uint64_t sz, uint64_t dst_max, uint64_t src_max)
+{
+    uint64_t low_max = dst_max < src_max ? dst_max : src_max;
+    uint64_t pos = 0;
+    const __m128i lo = _mm_load_si128((const __m128i *)&gf_mul_nibble[c][0]);
+    const __m128i hi = _mm_load_si128((const __m128i *)&gf_mul_nibble[c][16]);
+    const __m128i mask = _mm_set1_epi8(0x0f);
+
+    for (; pos + 16 <= low_max; pos += 16) {
+        __m128i in = _mm_loadu_si128((const __m128i *)&src[pos]);
+        __m128i out = _mm_loadu_si128((const __m128i *)&dst[pos]);
+        __m128i l = _mm_shuffle_epi8(lo, _mm_and_si128(in, mask));
+        __m128i h = _mm_shuffle_epi8(hi, _mm_and_si128(_mm_srli_epi64(in, 4), mask));
+        out = _mm_xor_si128(out, _mm_xor_si128(l, h));
+        _mm_storeu_si128((__m128i *)&dst[pos], out);
+    }
+
+    if (pos < low_max) {
+        slow_addmul1(&dst[pos], &src[pos], c, sz, low_max - pos, low_max - pos);
     }
 }
 
-# define addmul1 slow_addmul1
+__attribute__((target("avx2")))
+static void avx2_addmul1(gf *dst, gf *src, gf c, uint64_t sz, uint64_t dst_max, uint64_t src_max)
+{
+    uint64_t low_max = dst_max < src_max ? dst_max : src_max;
+    uint64_t pos = 0;
+    const __m256i lo = _mm256_broadcastsi128_si256(
+        _mm_load_si128((const __m128i *)&gf_mul_nibble[c][0]));
+    const __m256i hi = _mm256_broadcastsi128_si256(
+        _mm_load_si128((const __m128i *)&gf_mul_nibble[c][16]));
+    const __m256i mask = _mm256_set1_epi8(0x0f);
+
+    for (; pos + 64 <= low_max; pos += 64) {
+        __m256i in0 = _mm256_loadu_si256((const __m256i *)&src[pos]);
+        __m256i in1 = _mm256_loadu_si256((const __m256i *)&src[pos + 32]);
+        __m256i out0 = _mm256_loadu_si256((const __m256i *)&dst[pos]);
+        __m256i out1 = _mm256_loadu_si256((const __m256i *)&dst[pos + 32]);
+        __m256i l0 = _mm256_shuffle_epi8(lo, _mm256_and_si256(in0, mask));
+        __m256i l1 = _mm256_shuffle_epi8(lo, _mm256_and_si256(in1, mask));
+        __m256i h0 = _mm256_shuffle_epi8(hi, _mm256_and_si256(_mm256_srli_epi64(in0, 4), mask));
+        __m256i h1 = _mm256_shuffle_epi8(hi, _mm256_and_si256(_mm256_srli_epi64(in1, 4), mask));
+        out0 = _mm256_xor_si256(out0, _mm256_xor_si256(l0, h0));
+        out1 = _mm256_xor_si256(out1, _mm256_xor_si256(l1, h1));
+        _mm256_storeu_si256((__m256i *)&dst[pos], out0);
+        _mm256_storeu_si256((__m256i *)&dst[pos + 32], out1);
+    }
+
+    for (; pos + 32 <= low_max; pos += 32) {
+        __m256i in = _mm256_loadu_si256((const __m256i *)&src[pos]);
+        __m256i out = _mm256_loadu_si256((const __m256i *)&dst[pos]);
+        __m256i l = _mm256_shuffle_epi8(lo, _mm256_and_si256(in, mask));
+        __m256i h = _mm256_shuffle_epi8(hi, _mm256_and_si256(_mm256_srli_epi64(in, 4), mask));
+        out = _mm256_xor_si256(out, _mm256_xor_si256(l, h));
+        _mm256_storeu_si256((__m256i *)&dst[pos], out);
+    }
+
+    if (pos < low_max) {
+        slow_addmul1(&dst[pos], &src[pos], c, sz, low_max - pos, low_max - pos);
+    }
+}
+#endif
+
+typedef void (*gf_mul_fn)(gf *dst, gf *src, gf c, uint64_t sz,
+                          uint64_t dst_max, uint64_t src_max);
+
+/* selected by fec_init() based on the cpu features available */
+static gf_mul_fn addmul1 = slow_addmul1;
 
 static void addmul(gf *dst, gf *src, gf c, uint64_t sz, uint64_t dst_max, uint64_t src_max)
 {
@@ -340,29 +443,100 @@ static void slow_mul1(gf *dst1, gf *src1, gf c, uint64_t sz, uint64_t dst_max, u
     USE_GF_MULC;
     register gf *dst = dst1, *src = src1;
     uint64_t low_max = dst_max < src_max ? dst_max : src_max;
-    uint64_t pos = 0;
     gf *lim = &dst[low_max];
+    gf *lim8 = &dst[low_max & ~(uint64_t)7];
 
     GF_MULC0(c);
 
+    for (; dst < lim8; dst += 8, src += 8) {
+        GF_MULC( dst[0] , src[0] );
+        GF_MULC( dst[1] , src[1] );
+        GF_MULC( dst[2] , src[2] );
+        GF_MULC( dst[3] , src[3] );
+        GF_MULC( dst[4] , src[4] );
+        GF_MULC( dst[5] , src[5] );
+        GF_MULC( dst[6] , src[6] );
+        GF_MULC( dst[7] , src[7] );
+    }
     for (; dst < lim; dst++, src++ ) {
-        if (pos < src_max && pos < dst_max) {
-            GF_MULC( *dst , *src );
-        } else if (pos < dst_max) {
-            /* assume zero when past the max */
-            GF_MULC( *dst , 0 );
-        }
-        pos += 1;
+        GF_MULC( *dst , *src );
     }
 }
 
-# define mul1 slow_mul1
+#ifdef RS_HAVE_X86_SIMD
+__attribute__((target("ssse3")))
+static void ssse3_mul1(gf *dst, gf *src, gf c, uint64_t sz, uint64_t dst_max, uint64_t src_max)
+{
+    uint64_t low_max = dst_max < src_max ? dst_max : src_max;
+    uint64_t pos = 0;
+    const __m128i lo = _mm_load_si128((const __m128i *)&gf_mul_nibble[c][0]);
+    const __m128i hi = _mm_load_si128((const __m128i *)&gf_mul_nibble[c][16]);
+    const __m128i mask = _mm_set1_epi8(0x0f);
+
+    for (; pos + 16 <= low_max; pos += 16) {
+        __m128i in = _mm_loadu_si128((const __m128i *)&src[pos]);
+        __m128i l = _mm_shuffle_epi8(lo, _mm_and_si128(in, mask));
+        __m128i h = _mm_shuffle_epi8(hi, _mm_and_si128(_mm_srli_epi64(in, 4), mask));
+        _mm_storeu_si128((__m128i *)&dst[pos], _mm_xor_si128(l, h));
+    }
+
+    if (pos < low_max) {
+        slow_mul1(&dst[pos], &src[pos], c, sz, low_max - pos, low_max - pos);
+    }
+}
+
+__attribute__((target("avx2")))
+static void avx2_mul1(gf *dst, gf *src, gf c, uint64_t sz, uint64_t dst_max, uint64_t src_max)
+{
+    uint64_t low_max = dst_max < src_max ? dst_max : src_max;
+    uint64_t pos = 0;
+    const __m256i lo = _mm256_broadcastsi128_si256(
+        _mm_load_si128((const __m128i *)&gf_mul_nibble[c][0]));
+    const __m256i hi = _mm256_broadcastsi128_si256(
+        _mm_load_si128((const __m128i *)&gf_mul_nibble[c][16]));
+    const __m256i mask = _mm256_set1_epi8(0x0f);
+
+    for (; pos + 32 <= low_max; pos += 32) {
+        __m256i in = _mm256_loadu_si256((const __m256i *)&src[pos]);
+        __m256i l = _mm256_shuffle_epi8(lo, _mm256_and_si256(in, mask));
+        __m256i h = _mm256_shuffle_epi8(hi, _mm256_and_si256(_mm256_srli_epi64(in, 4), mask));
+        _mm256_storeu_si256((__m256i *)&dst[pos], _mm256_xor_si256(l, h));
+    }
+
+    if (pos < low_max) {
+        slow_mul1(&dst[pos], &src[pos], c, sz, low_max - pos, low_max - pos);
+    }
+}
+#endif
+
+/* selected by fec_init() based on the cpu features available */
+static gf_mul_fn mul1 = slow_mul1;
 
 static inline void mul(gf *dst, gf *src, gf c, uint64_t sz, uint64_t dst_max, uint64_t src_max)
 {
     if (c != 0) mul1(dst, src, c, sz, dst_max, src_max); else memset(dst, 0, c);
 }
 
+/*
+ * Pick the widest multiply kernels supported by the running cpu.
+ */
+static void init_mul_kernels(void)
+{
+    addmul1 = slow_addmul1;
+    mul1 = slow_mul1;
+
+#ifdef RS_HAVE_X86_SIMD
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        addmul1 = avx2_addmul1;
+        mul1 = avx2_mul1;
+    } else if (__builtin_cpu_supports("ssse3")) {
+        addmul1 = ssse3_addmul1;
+        mul1 = ssse3_mul1;
+    }
+#endif
+}
+
 /*
  * invert_mat() takes a matrix and produces its inverse
  * k is the size of the matrix.
@@ -501,6 +675,7 @@ void fec_init(void)
     init_mul_table();
     TOCK(ticks[0]);
     DDB(fprintf(stderr, "init_mul_table took %ldus\n", ticks[0]);)
+    init_mul_kernels();
     fec_initialized = 1;
 }
 
@@ -749,33 +924,78 @@ int reed_solomon_encode(reed_solomon* rs,
                         uint8_t** fec_blocks,
                         uint64_t block_size,
                         uint64_t total_bytes)
+{
+    return reed_solomon_encode_range(rs, data_blocks, fec_blocks, block_size,
+                                     total_bytes, 0, block_size);
+}
+
+int reed_solomon_encode_range(reed_solomon* rs,
+                              uint8_t** data_blocks,
+                              uint8_t** fec_blocks,
+                              uint64_t block_size,
+                              uint64_t total_bytes,
+                              uint64_t offset,
+                              uint64_t length)
 {
     assert(NULL != rs && NULL != rs->parity);
 
     uint64_t data_blocks_max[rs->data_shards];
     uint64_t fec_blocks_max[rs->parity_shards];
+    uint64_t stripe_max[rs->data_shards];
+    uint8_t* stripe_in[rs->data_shards];
+    uint8_t* stripe_out[rs->parity_shards];
+    uint64_t end, pos, n;
 
     int c = 0;
 
     // Calculate the max for each shard based on the total bytes
     // the last shard may be less than the shard size
     for (c = 0; c < rs->data_shards; c++) {
-        uint64_t bytes_remaining = total_bytes - c * block_size;
         uint64_t max = block_size;
-        if (bytes_remaining < block_size) {
-            max = bytes_remaining;
+        if (total_bytes <= c * block_size) {
+            max = 0;
+        } else if (total_bytes - c * block_size < block_size) {
+            max = total_bytes - c * block_size;
         }
         data_blocks_max[c] = max;
     }
 
-    // All of the parity shards will be the block size
-    for (c = 0; c < rs->parity_shards; c++) {
-        fec_blocks_max[c] = block_size;
+    end = offset + length;
+    if (end > block_size) {
+        end = block_size;
     }
 
-    return code_some_shards(rs->parity, data_blocks, fec_blocks,
-                            rs->data_shards, rs->parity_shards, block_size,
-                            data_blocks_max, fec_blocks_max);
+    // Work through the range one stripe at a time so that the stripe of
+    // every parity shard stays in cache while each data stripe is read once
+    for (pos = offset; pos < end; pos += n) {
+        n = end - pos;
+        if (n > RS_STRIPE_SIZE) {
+            n = RS_STRIPE_SIZE;
+        }
+
+        for (c = 0; c < rs->data_shards; c++) {
+            stripe_in[c] = data_blocks[c] + pos;
+            if (data_blocks_max[c] <= pos) {
+                stripe_max[c] = 0;
+            } else if (data_blocks_max[c] - pos < n) {
+                stripe_max[c] = data_blocks_max[c] - pos;
+            } else {
+                stripe_max[c] = n;
+            }
+        }
+
+        // All of the parity shards will be the block size
+        for (c = 0; c < rs->parity_shards; c++) {
+            stripe_out[c] = fec_blocks[c] + pos;
+            fec_blocks_max[c] = n;
+        }
+
+        code_some_shards(rs->parity, stripe_in, stripe_out,
+                         rs->data_shards, rs->parity_shards, n,
+                         stripe_max, fec_blocks_max);
+    }
+
+    return 0;
 }
 
 int reed_solomon_decode(reed_solomon* rs,
@@ -19,6 +19,11 @@
 #define RS_CALLOC(n, x) calloc(n, x)
 #endif
 
+/* bytes of each shard encoded at a time, sized to keep parity in cache */
+#ifndef RS_STRIPE_SIZE
+#define RS_STRIPE_SIZE (16 * 1024)
+#endif
+
 typedef struct _reed_solomon {
     int data_shards;
     int parity_shards;
@@ -54,6 +59,29 @@ int reed_solomon_encode(reed_solomon* rs,
                         uint64_t block_size,
                         uint64_t total_bytes);
 
+/**
+ * @brief Will encode a byte range of the data shards into parity shards
+ *
+ * Only bytes [offset, offset + length) of every shard are read and written,
+ * so that separate ranges of the same shards can be encoded concurrently.
+ *
+ * @param[in] rs
+ * @param[in] data_blocks Data shards
+ * @param[in] fec_blocks Parity shards
+ * @param[in] block_size The size of each shard
+ * @param[in] total_bytes The total size used for zero padding the last shard
+ * @param[in] offset The position within each shard to start encoding
+ * @param[in] length The number of bytes of each shard to encode
+ * @return A non-zero error value on failure and 0 on success.
+ */
+int reed_solomon_encode_range(reed_solomon* rs,
+                              uint8_t** data_blocks,
+                              uint8_t** fec_blocks,
+                              uint64_t block_size,
+                              uint64_t total_bytes,
+                              uint64_t offset,
+                              uint64_t length);
+
 
 int reed_solomon_decode(reed_solomon* rs,
                         uint8_t **data_blocks,
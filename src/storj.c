@@ -2,6 +2,8 @@
 #include "http.h"
 #include "utils.h"
 #include "crypto.h"
+#include "farmers.h"
+#include "reports.h"
 
 static inline void noop() {};
 
@@ -23,9 +25,9 @@ static void create_bucket_request_worker(uv_work_t *work)
     int status_code = 0;
 
     // Encrypt the bucket name
-    if (encrypt_bucket_name(req->encrypt_options->mnemonic,
-                            req->bucket_name,
-                            (char **)&req->encrypted_bucket_name)) {
+    if (encrypt_bucket_name_cached(req->encrypt_options->key_cache,
+                                   req->bucket_name,
+                                   (char **)&req->encrypted_bucket_name)) {
         req->error_code = STORJ_MEMORY_ERROR;
         return;
     }
@@ -107,9 +109,9 @@ static void get_buckets_request_worker(uv_work_t *work)
             continue;
         }
         char *decrypted_name;
-        int error_status = decrypt_bucket_name(req->encrypt_options->mnemonic,
-                                               encrypted_name,
-                                               &decrypted_name);
+        int error_status = decrypt_bucket_name_cached(req->encrypt_options->key_cache,
+                                                      encrypted_name,
+                                                      &decrypted_name);
         if (!error_status) {
             bucket->decrypted = true;
             bucket->name = decrypted_name;
@@ -159,9 +161,9 @@ static void get_bucket_request_worker(uv_work_t *work)
     const char *encrypted_name = json_object_get_string(name);
     if (encrypted_name) {
         char *decrypted_name;
-        int error_status = decrypt_bucket_name(req->encrypt_options->mnemonic,
-                                               encrypted_name,
-                                               &decrypted_name);
+        int error_status = decrypt_bucket_name_cached(req->encrypt_options->key_cache,
+                                                      encrypted_name,
+                                                      &decrypted_name);
         if (!error_status) {
             req->bucket->decrypted = true;
             req->bucket->name = decrypted_name;
@@ -181,9 +183,9 @@ static void get_bucket_id_request_worker(uv_work_t *work)
 
     // Encrypt the bucket name
     char *encrypted_bucket_name;
-    if (encrypt_bucket_name(req->encrypt_options->mnemonic,
-                            req->bucket_name,
-                            &encrypted_bucket_name)) {
+    if (encrypt_bucket_name_cached(req->encrypt_options->key_cache,
+                                   req->bucket_name,
+                                   &encrypted_bucket_name)) {
         req->error_code = STORJ_MEMORY_ERROR;
         goto cleanup;
     }
@@ -219,14 +221,30 @@ cleanup:
     free(path);
 }
 
+static int list_files_append(struct json_object *file, void *handle)
+{
+    list_files_request_t *req = handle;
+
+    json_object_array_add(req->response, file);
+
+    // files past the limit belong to the next page
+    if (req->limit && json_object_array_length(req->response) >= req->limit) {
+        return 1;
+    }
+
+    return 0;
+}
+
 static void list_files_request_worker(uv_work_t *work)
 {
     list_files_request_t *req = work->data;
     int status_code = 0;
 
-    req->error_code = fetch_json(req->http_options,
-                                 req->options, req->method, req->path, req->body,
-                                 req->auth, &req->response, &status_code);
+    req->error_code = fetch_json_stream(req->http_options,
+                                        req->options, req->method, req->path,
+                                        req->body, req->auth,
+                                        list_files_append, req,
+                                        &req->response, &status_code);
 
     req->status_code = status_code;
 
@@ -291,10 +309,10 @@ static void list_files_request_worker(uv_work_t *work)
             continue;
         }
         char *decrypted_file_name;
-        int error_status = decrypt_file_name(req->encrypt_options->mnemonic,
-                                             req->bucket_id,
-                                             encrypted_file_name,
-                                             &decrypted_file_name);
+        int error_status = decrypt_file_name_cached(req->encrypt_options->key_cache,
+                                                    req->bucket_id,
+                                                    encrypted_file_name,
+                                                    &decrypted_file_name);
         if (!error_status) {
             file->decrypted = true;
             file->filename = decrypted_file_name;
@@ -305,6 +323,15 @@ static void list_files_request_worker(uv_work_t *work)
             req->error_code = STORJ_MEMORY_ERROR;
         }
     }
+
+    // a full page continues after the creation date of its last file
+    if (req->limit && num_files == req->limit &&
+        req->files[num_files - 1].created) {
+        req->next_cursor = strdup(req->files[num_files - 1].created);
+        if (!req->next_cursor) {
+            req->error_code = STORJ_MEMORY_ERROR;
+        }
+    }
 }
 
 static void get_file_info_request_worker(uv_work_t *work)
@@ -361,10 +388,10 @@ static void get_file_info_request_worker(uv_work_t *work)
     const char *encrypted_file_name = json_object_get_string(filename);
     if (encrypted_file_name) {
         char *decrypted_file_name;
-        int error_status = decrypt_file_name(req->encrypt_options->mnemonic,
-                                             req->bucket_id,
-                                             encrypted_file_name,
-                                             &decrypted_file_name);
+        int error_status = decrypt_file_name_cached(req->encrypt_options->key_cache,
+                                                    req->bucket_id,
+                                                    encrypted_file_name,
+                                                    &decrypted_file_name);
         if (!error_status) {
             req->file->decrypted = true;
             req->file->filename = decrypted_file_name;
@@ -383,10 +410,10 @@ static void get_file_id_request_worker(uv_work_t *work)
     int status_code = 0;
 
     char *encrypted_file_name;
-    if (encrypt_file_name(req->encrypt_options->mnemonic,
-                          req->bucket_id,
-                          req->file_name,
-                          &encrypted_file_name)) {
+    if (encrypt_file_name_cached(req->encrypt_options->key_cache,
+                                 req->bucket_id,
+                                 req->file_name,
+                                 &encrypted_file_name)) {
         req->error_code = STORJ_MEMORY_ERROR;
         goto cleanup;
     }
@@ -485,6 +512,8 @@ static list_files_request_t *list_files_request_new(
     req->response = NULL;
     req->files = NULL;
     req->total_files = 0;
+    req->limit = 0;
+    req->next_cursor = NULL;
     req->error_code = 0;
     req->status_code = 0;
     req->handle = handle;
@@ -780,6 +809,10 @@ STORJ_API struct storj_env *storj_init_env(storj_bridge_options_t *options,
     bo->proto = strdup(options->proto);
     bo->host = strdup(options->host);
     bo->port = options->port;
+    bo->pointer_page_size = (options->pointer_page_size > 0) ?
+        options->pointer_page_size : STORJ_POINTER_PAGE_SIZE;
+    bo->pointer_page_requests = (options->pointer_page_requests > 0) ?
+        options->pointer_page_requests : STORJ_POINTER_PAGE_REQUESTS;
     if (options->user) {
         bo->user = strdup(options->user);
     } else {
@@ -894,6 +927,11 @@ STORJ_API struct storj_env *storj_init_env(storj_bridge_options_t *options,
         eo->mnemonic = NULL;
     }
 
+    eo->key_cache = key_cache_new(eo->mnemonic);
+    if (!eo->key_cache) {
+        return NULL;
+    }
+
     env->encrypt_options = eo;
 
     // Set tmp_path
@@ -944,9 +982,53 @@ STORJ_API struct storj_env *storj_init_env(storj_bridge_options_t *options,
     } else {
         ho->timeout = STORJ_HTTP_TIMEOUT;
     }
+    if (http_options->max_idle_connections > 0) {
+        ho->max_idle_connections = http_options->max_idle_connections;
+    } else {
+        ho->max_idle_connections = STORJ_HTTP_MAX_IDLE_CONNECTIONS;
+    }
+
+    // transfer buffers are page aligned and a whole number of pages, and
+    // hold at least the largest piece of data that curl receives at once
+    ho->transfer_buffer_size = (http_options->transfer_buffer_size > 0) ?
+        http_options->transfer_buffer_size : STORJ_HTTP_TRANSFER_BUFFER_SIZE;
+    if (ho->transfer_buffer_size < CURL_MAX_WRITE_SIZE) {
+        ho->transfer_buffer_size = CURL_MAX_WRITE_SIZE;
+    }
+    ho->transfer_buffer_size = ((ho->transfer_buffer_size +
+                                 TRANSFER_BUFFER_ALIGNMENT - 1) /
+                                TRANSFER_BUFFER_ALIGNMENT) *
+        TRANSFER_BUFFER_ALIGNMENT;
+    ho->direct_io = http_options->direct_io;
+    ho->upload_rate_limit = http_options->upload_rate_limit;
+    ho->download_rate_limit = http_options->download_rate_limit;
+
+    // connections are reused between requests of the environment
+    ho->pool = http_pool_new(ho->max_idle_connections);
+    if (!ho->pool) {
+        return NULL;
+    }
 
     env->http_options = ho;
 
+    // shard transfers run on the event loop
+    env->http_multi = http_multi_new(env->loop, ho);
+    if (!env->http_multi) {
+        return NULL;
+    }
+
+    // farmers that have failed are avoided by all transfers
+    env->farmers = farmer_table_new();
+    if (!env->farmers) {
+        return NULL;
+    }
+
+    // exchange reports are sent in batches for all transfers
+    env->reports = report_queue_new(env);
+    if (!env->reports) {
+        return NULL;
+    }
+
     // setup the log options
     env->log_options = log_options;
     if (!env->log_options->logger) {
@@ -981,6 +1063,15 @@ STORJ_API struct storj_env *storj_init_env(storj_bridge_options_t *options,
     return env;
 }
 
+STORJ_API void storj_env_set_rate_limits(storj_env_t *env,
+                                         uint64_t upload_rate_limit,
+                                         uint64_t download_rate_limit)
+{
+    // the running transfers use the limits of the env's http options
+    http_multi_set_rate_limits(env->http_multi, upload_rate_limit,
+                               download_rate_limit);
+}
+
 STORJ_API int storj_destroy_env(storj_env_t *env)
 {
     int status = 0;
@@ -1015,6 +1106,10 @@ STORJ_API int storj_destroy_env(storj_env_t *env)
     free(env->bridge_options);
 
     // free and destroy all encryption options
+    if (env->encrypt_options) {
+        key_cache_destroy(env->encrypt_options->key_cache);
+    }
+
     if (env->encrypt_options && env->encrypt_options->mnemonic) {
         unsigned int mnemonic_len = strlen(env->encrypt_options->mnemonic);
 
@@ -1044,6 +1139,10 @@ STORJ_API int storj_destroy_env(storj_env_t *env)
     free(env->encrypt_options);
 
     // free all http options
+    http_multi_destroy(env->http_multi);
+    farmer_table_destroy(env->farmers);
+    report_queue_destroy(env->reports);
+    http_pool_destroy(env->http_options->pool);
     free((char *)env->http_options->user_agent);
     if (env->http_options->proxy_url) {
         free((char *)env->http_options->proxy_url);
@@ -1311,6 +1410,8 @@ STORJ_API char *storj_strerror(int error_code)
             return "File unsupported erasure code error";
         case STORJ_FILE_PARITY_ERROR:
             return "File create parity error";
+        case STORJ_FILE_JOURNAL_ERROR:
+            return "File journal error";
         case STORJ_META_ENCRYPTION_ERROR:
             return "Meta encryption error";
         case STORJ_META_DECRYPTION_ERROR:
@@ -1509,12 +1610,57 @@ STORJ_API int storj_bridge_list_files(storj_env_t *env,
                          list_files_request_worker, cb);
 }
 
+STORJ_API int storj_bridge_list_files_page(storj_env_t *env,
+                                           const char *id,
+                                           const char *cursor,
+                                           uint32_t limit,
+                                           void *handle,
+                                           uv_after_work_cb cb)
+{
+    if (!limit) {
+        limit = STORJ_LIST_FILES_PAGE_SIZE;
+    }
+
+    char limit_str[11];
+    snprintf(limit_str, sizeof(limit_str), "%u", limit);
+
+    char *path = NULL;
+    if (cursor) {
+        path = str_concat_many(6, "/buckets/", id, "/files?limit=", limit_str,
+                               "&startDate=", cursor);
+    } else {
+        path = str_concat_many(4, "/buckets/", id, "/files?limit=", limit_str);
+    }
+    if (!path) {
+        return STORJ_MEMORY_ERROR;
+    }
+
+    uv_work_t *work = uv_work_new();
+    if (!work) {
+        return STORJ_MEMORY_ERROR;
+    }
+    list_files_request_t *req = list_files_request_new(env->http_options,
+                                                       env->bridge_options,
+                                                       env->encrypt_options,
+                                                       id, "GET", path,
+                                                       NULL, true, handle);
+    if (!req) {
+        return STORJ_MEMORY_ERROR;
+    }
+    req->limit = limit;
+    work->data = req;
+
+    return uv_queue_work(env->loop, (uv_work_t*) work,
+                         list_files_request_worker, cb);
+}
+
 STORJ_API void storj_free_list_files_request(list_files_request_t *req)
 {
     if (req->response) {
         json_object_put(req->response);
     }
     free(req->path);
+    free(req->next_cursor);
     if (req->files && req->total_files > 0) {
         for (int i = 0; i < req->total_files; i++) {
             free((char *)req->files[i].filename);
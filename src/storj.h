@@ -85,6 +85,7 @@ extern "C" {
 #define STORJ_FILE_RESIZE_ERROR 3009
 #define STORJ_FILE_UNSUPPORTED_ERASURE 3010
 #define STORJ_FILE_PARITY_ERROR 3011
+#define STORJ_FILE_JOURNAL_ERROR 3012
 
 // Memory related errors
 #define STORJ_MEMORY_ERROR 4000
@@ -116,6 +117,11 @@ extern "C" {
 #define STORJ_LOW_SPEED_LIMIT 30720L
 #define STORJ_LOW_SPEED_TIME 20L
 #define STORJ_HTTP_TIMEOUT 60L
+#define STORJ_HTTP_MAX_IDLE_CONNECTIONS 16
+#define STORJ_HTTP_TRANSFER_BUFFER_SIZE 2097152
+#define STORJ_LIST_FILES_PAGE_SIZE 1000
+#define STORJ_POINTER_PAGE_SIZE 24
+#define STORJ_POINTER_PAGE_REQUESTS 4
 
 typedef struct {
   uint8_t *encryption_ctr;
@@ -133,7 +139,9 @@ typedef enum {
 /** @brief Bridge configuration options
  *
  * Proto can be "http" or "https", and the user/pass are used for
- * basic authentication to a Storj bridge.
+ * basic authentication to a Storj bridge. The pointers of a file are
+ * requested pointer_page_size at a time, with up to pointer_page_requests
+ * requests at once.
  */
 typedef struct {
     const char *proto;
@@ -141,22 +149,45 @@ typedef struct {
     int port;
     const char *user;
     const char *pass;
+    uint32_t pointer_page_size;
+    uint32_t pointer_page_requests;
 } storj_bridge_options_t;
 
+struct storj_key_cache;
+
 /** @brief File encryption options
  *
  * The mnemonic is a BIP39 secret code used for generating keys for file
- * encryption and decryption.
+ * encryption and decryption. The key cache holds the seed and bucket keys
+ * derived from the mnemonic, and is created with the environment.
  */
 typedef struct storj_encrypt_options {
     const char *mnemonic;
+    struct storj_key_cache *key_cache;
 } storj_encrypt_options_t;
 
 
 
+struct storj_http_pool;
+struct storj_http_multi;
+struct storj_farmer_table;
+struct storj_report_queue;
+
 /** @brief HTTP configuration options
  *
- * Settings for making HTTP requests
+ * Settings for making HTTP requests. Connections are kept alive and reused
+ * between requests to the same host, up to max_idle_connections idle
+ * connections per environment. The pool is created by storj_init_env and
+ * should not be set by the caller.
+ *
+ * Shards are read from and written to files transfer_buffer_size bytes at
+ * a time, while the previous buffer is sent or the next is received. With
+ * direct_io the writes bypass the page cache where the system and file
+ * system support it.
+ *
+ * The upload and download rate limits are in bytes per second for all
+ * shard transfers of the environment together, 0 is unlimited. They can
+ * be changed while transfers are running with storj_env_set_rate_limits.
  */
 typedef struct storj_http_options {
     const char *user_agent;
@@ -165,6 +196,12 @@ typedef struct storj_http_options {
     uint64_t low_speed_limit;
     uint64_t low_speed_time;
     uint64_t timeout;
+    uint32_t max_idle_connections;
+    uint64_t transfer_buffer_size;
+    bool direct_io;
+    uint64_t upload_rate_limit;
+    uint64_t download_rate_limit;
+    struct storj_http_pool *pool;
 } storj_http_options_t;
 
 /** @brief A function signature for logging
@@ -198,7 +235,9 @@ typedef struct storj_log_levels {
 /** @brief A structure for a Storj user environment.
  *
  * This is the highest level structure and holds many commonly used options
- * and the event loop for queuing work.
+ * and the event loop for queuing work. The outcomes of the shard transfers
+ * with each farmer are kept in the farmer table of the environment, and
+ * their exchange reports are sent from the report queue.
  */
 typedef struct storj_env {
     storj_bridge_options_t *bridge_options;
@@ -207,6 +246,9 @@ typedef struct storj_env {
     storj_log_options_t *log_options;
     const char *tmp_path;
     uv_loop_t *loop;
+    struct storj_http_multi *http_multi;
+    struct storj_farmer_table *farmers;
+    struct storj_report_queue *reports;
     storj_log_levels_t *log;
 } storj_env_t;
 
@@ -327,6 +369,8 @@ typedef struct {
     struct json_object *response;
     storj_file_meta_t *files;
     uint32_t total_files;
+    uint32_t limit;
+    char *next_cursor;
     int error_code;
     int status_code;
     void *handle;
@@ -402,6 +446,14 @@ typedef void (*storj_progress_cb)(double progress,
  */
 typedef void (*storj_finished_download_cb)(int status, FILE *fd, void *handle);
 
+/** @brief A function signature for receiving decrypted data of a streamed
+ * download, the data is given in order and is only valid during the call.
+ * A non-zero return value will stop the download.
+ */
+typedef int (*storj_write_cb)(const uint8_t *buffer,
+                              size_t length,
+                              void *handle);
+
 /** @brief A function signature for an upload complete callback
  */
 typedef void (*storj_finished_upload_cb)(int error_status, storj_file_meta_t *file, void *handle);
@@ -416,6 +468,11 @@ typedef void (*storj_finished_upload_cb)(int error_status, storj_file_meta_t *fi
  *
  * The data can be replaced with new farmer contact, in case of failure, and the
  * total number of replacements can be tracked.
+ *
+ * A shard that is downloaded much slower than the others can be hedged, it's
+ * then also downloaded from another farmer into hedge_data, and the first
+ * copy to be received is used. The farmer and times of the hedged download
+ * replace those of the report once its copy is used.
  */
 typedef struct {
     unsigned int replace_count;
@@ -431,18 +488,97 @@ typedef struct {
     int farmer_port;
     storj_exchange_report_t *report;
     uv_work_t *work;
+    uint8_t *shard_data;
+    bool slow;
+    bool hedged;
+    uv_work_t *hedge_work;
+    uint8_t *hedge_data;
+    char *hedge_farmer_id;
+    uint64_t hedge_start;
+    uint64_t hedge_end;
 } storj_pointer_t;
 
+/** @brief A queue of shard or pointer indexes that are ready for work
+ *
+ * The lowest index is taken first, so that work proceeds in the order of
+ * the file. An index is added whenever it may have become ready, and is
+ * checked again when it's taken, as it could have changed since.
+ */
+typedef struct {
+    uint32_t *items;
+    uint32_t length;
+    uint32_t size;
+} storj_index_queue_t;
+
+/** @brief An adaptive limit of the shards transferred at once
+ *
+ * The throughput of each window of finished shards, from the start and end
+ * times of their exchange reports, is compared with the window before it.
+ * The limit is doubled while the throughput grows at the start, and then
+ * moves by one in the direction that last increased the throughput. A
+ * failed transfer halves the limit, once per window. The limit stays
+ * between min and max.
+ */
+typedef struct {
+    uint32_t limit;
+    uint32_t min;
+    uint32_t max;
+    bool slow_start;
+    bool decreased;
+    int step;
+    uint32_t window_shards;
+    uint64_t window_bytes;
+    uint64_t window_start;
+    uint64_t window_end;
+    uint64_t last_rate;
+} storj_concurrency_t;
+
+/** @brief A page of pointers requested from the bridge
+ *
+ * Pages can be received in any order, and a received page is kept until
+ * the pages before it have been added to the pointers.
+ */
+typedef struct {
+    uint32_t skip;
+    uint32_t limit;
+    bool pending;
+    struct json_object *response;
+} storj_pointer_page_t;
+
+struct storj_journal;
+
 /** @brief A structure for file upload options
+ *
+ * With stream set, a file using reed solomon is encrypted, hashed and
+ * erasure coded in one pass over the file, and no encrypted copy of the
+ * file is written to the temp path.
+ *
+ * With a journal path, the index, frame and pushed shards are recorded as
+ * the upload progresses. An upload of the same file with the same journal
+ * path continues where the earlier upload stopped, and the journal is
+ * removed once the upload is complete.
+ *
+ * The number of shards pushed at once starts at push_shard_limit and is
+ * adapted to the throughput of the pushed shards, between push_shard_min
+ * and push_shard_max.
+ *
+ * With an upload rate limit, the shards of an upload are given a share of
+ * the limit relative to the bandwidth_weight of the other transfers.
  */
 typedef struct {
     int prepare_frame_limit;
     int push_frame_limit;
     int push_shard_limit;
+    int push_shard_min;
+    int push_shard_max;
+    int bandwidth_weight;
+    int encode_threads;
     bool rs;
+    bool stream;
     const char *index;
     const char *bucket_id;
     const char *file_name;
+    const char *journal_path;
     FILE *fd;
 } storj_upload_opts_t;
 
@@ -455,6 +591,25 @@ typedef struct {
  * thread, the event loop thread, and any work that is performed in another
  * thread should not modify this structure directly, but should pass a
  * reference to it, so that once the work is complete the state can be updated.
+ *
+ * A download to a file can set a journal path before the event loop is run,
+ * the downloaded shards are then recorded so that a download of the same
+ * file to the same destination continues where an earlier one stopped. The
+ * destination must be opened without truncating it to continue.
+ *
+ * Up to hedge_limit shards that are downloading at less than half of the
+ * median rate of the finished shards are also requested from another
+ * farmer, a hedge_limit of 0 disables this.
+ *
+ * The parity shards of a download to a file are only downloaded once a
+ * data shard has failed, is missing or is slow.
+ *
+ * The number of shards downloaded at once is adapted to the throughput of
+ * the downloaded shards, between download_min_concurrency and
+ * download_max_concurrency.
+ *
+ * With a download rate limit, the shards of a download are given a share
+ * of the limit relative to the bandwidth_weight of the other transfers.
  */
 typedef struct {
     uint64_t total_bytes;
@@ -465,17 +620,35 @@ typedef struct {
     const char *file_id;
     const char *bucket_id;
     FILE *destination;
+    storj_write_cb write_cb;
+    bool stream;
+    uint32_t stream_position;
+    bool stream_recovering;
+    uint64_t range_offset;
+    uint64_t range_length;
     storj_progress_cb progress_cb;
     storj_finished_download_cb finished_cb;
     bool finished;
     bool canceled;
     uint64_t shard_size;
     uint32_t total_shards;
+    int download_min_concurrency;
     int download_max_concurrency;
+    storj_concurrency_t download_concurrency;
+    uint32_t bandwidth_weight;
+    int decrypt_threads;
+    bool decrypt_on_receive;
+    const char *journal_path;
+    struct storj_journal *journal;
     uint32_t completed_shards;
     uint32_t resolving_shards;
+    bool fetching_parity;
+    uint32_t hedge_limit;
+    uint32_t hedging_shards;
+    uint64_t hedge_checked;
+    uint64_t *shard_rates;
+    uint32_t total_shard_rates;
     storj_pointer_t *pointers;
-    char *excluded_farmer_ids;
     uint32_t total_pointers;
     uint32_t total_parity_pointers;
     bool rs;
@@ -484,6 +657,14 @@ typedef struct {
     bool pointers_completed;
     uint32_t pointer_fail_count;
     bool requesting_pointers;
+    uint32_t missing_pointers;
+    uint32_t missing_data_pointers;
+    uint32_t downloaded_pointers;
+    storj_index_queue_t created_pointers;
+    storj_index_queue_t reported_pointers;
+    storj_pointer_page_t *pointer_pages;
+    uint32_t pointer_page_size;
+    uint32_t pointers_end;
     int error_status;
     bool writing;
     uint8_t *decrypt_key;
@@ -545,14 +726,16 @@ typedef struct {
     uint64_t shard_size;
     uint64_t total_bytes;
     uint64_t uploaded_bytes;
-    char *exclude;
     char *frame_id;
     char *hmac_id;
     uint8_t *encryption_key;
     uint8_t *encryption_ctr;
+    const char *journal_path;
+    struct storj_journal *journal;
 
     // TODO: change this to opts or env
     bool rs;
+    bool stream;
     bool awaiting_parity_shards;
     char *parity_file_path;
     FILE *parity_file;
@@ -574,6 +757,9 @@ typedef struct {
     int push_shard_limit;
     int push_frame_limit;
     int prepare_frame_limit;
+    int encode_threads;
+    storj_concurrency_t push_concurrency;
+    uint32_t bandwidth_weight;
 
     int frame_request_count;
     int add_bucket_entry_count;
@@ -588,6 +774,13 @@ typedef struct {
     void *handle;
     shard_tracker_t *shard;
     int pending_work_count;
+
+    uint32_t preparing_frames;
+    uint32_t pushing_frames;
+    uint32_t pushing_shards;
+    storj_index_queue_t ready_prepare_frame;
+    storj_index_queue_t ready_push_frame;
+    storj_index_queue_t ready_push_shard;
 } storj_upload_state_t;
 
 /**
@@ -616,11 +809,27 @@ STORJ_API storj_env_t *storj_init_env(storj_bridge_options_t *options,
  * with sensitive information, such as passwords and encryption keys.
  *
  * The event loop must be closed before this method should be used.
+ * Exchange reports that are still queued and haven't been sent are dropped.
  *
  * @param [in] env
  */
 STORJ_API int storj_destroy_env(storj_env_t *env);
 
+/**
+ * @brief Change the bandwidth limits of a Storj environment
+ *
+ * The limits apply to the running shard transfers as well, and can be
+ * changed from any thread while the event loop is running.
+ *
+ * @param[in] env The storj environment
+ * @param[in] upload_rate_limit The upload limit in bytes per second, or 0
+ * @param[in] download_rate_limit The download limit in bytes per second,
+ * or 0
+ */
+STORJ_API void storj_env_set_rate_limits(storj_env_t *env,
+                                         uint64_t upload_rate_limit,
+                                         uint64_t download_rate_limit);
+
 /**
  * @brief Will encrypt and write options to disk
  *
@@ -851,6 +1060,30 @@ STORJ_API int storj_bridge_list_files(storj_env_t *env,
                                       void *handle,
                                       uv_after_work_cb cb);
 
+/**
+ * @brief Get a page of the files in a bucket.
+ *
+ * The response is parsed as it is received, so that memory use depends on
+ * the page size and not the number of files in the bucket. Files are listed
+ * in the order they were created, and when the page is full the request has
+ * a next_cursor to pass for the following page. The next_cursor is NULL
+ * once the last page has been listed.
+ *
+ * @param[in] env The storj environment struct
+ * @param[in] id The bucket id
+ * @param[in] cursor The next_cursor of the previous page, or NULL to start
+ * @param[in] limit The maximum number of files in the page, 0 for default
+ * @param[in] handle A pointer that will be available in the callback
+ * @param[in] cb A function called with response when complete
+ * @return A non-zero error value on failure and 0 on success.
+ */
+STORJ_API int storj_bridge_list_files_page(storj_env_t *env,
+                                           const char *id,
+                                           const char *cursor,
+                                           uint32_t limit,
+                                           void *handle,
+                                           uv_after_work_cb cb);
+
 /**
  * @brief Will free all structs for list files request
  *
@@ -1074,6 +1307,61 @@ STORJ_API storj_download_state_t *storj_bridge_resolve_file(storj_env_t *env,
                                                             storj_progress_cb progress_cb,
                                                             storj_finished_download_cb finished_cb);
 
+/**
+ * @brief Download a file as a stream
+ *
+ * Shards are held in memory and the decrypted data is given to the write
+ * callback in order as each shard is available, only a few shards ahead of
+ * the written position are downloaded at a time. Parity shards are only
+ * downloaded if a data shard is missing and needs to be recovered. The
+ * finished callback is called with a NULL file descriptor.
+ *
+ * @param[in] env A pointer to environment
+ * @param[in] bucket_id Character array of bucket id
+ * @param[in] file_id Character array of file id
+ * @param[in] handle A pointer that will be available in the callback
+ * @param[in] write_cb Function called with decrypted data in order
+ * @param[in] progress_cb Function called with progress updates
+ * @param[in] finished_cb Function called when download finished
+ * @return A pointer to the download state or NULL on error
+ */
+STORJ_API storj_download_state_t *storj_bridge_resolve_file_stream(storj_env_t *env,
+                                                                   const char *bucket_id,
+                                                                   const char *file_id,
+                                                                   void *handle,
+                                                                   storj_write_cb write_cb,
+                                                                   storj_progress_cb progress_cb,
+                                                                   storj_finished_download_cb finished_cb);
+
+/**
+ * @brief Download a byte range of a file as a stream
+ *
+ * Only the pointers and shards that cover the range are requested, and the
+ * decrypted data of the range is given to the write callback in order. The
+ * integrity of each shard is verified, however the hmac of the file can not
+ * be verified and missing shards can not be recovered from parity shards.
+ *
+ * @param[in] env A pointer to environment
+ * @param[in] bucket_id Character array of bucket id
+ * @param[in] file_id Character array of file id
+ * @param[in] offset The byte offset of the range in the file
+ * @param[in] length The number of bytes of the range
+ * @param[in] handle A pointer that will be available in the callback
+ * @param[in] write_cb Function called with decrypted data in order
+ * @param[in] progress_cb Function called with progress updates
+ * @param[in] finished_cb Function called when download finished
+ * @return A pointer to the download state or NULL on error
+ */
+STORJ_API storj_download_state_t *storj_bridge_resolve_file_range(storj_env_t *env,
+                                                                  const char *bucket_id,
+                                                                  const char *file_id,
+                                                                  uint64_t offset,
+                                                                  uint64_t length,
+                                                                  void *handle,
+                                                                  storj_write_cb write_cb,
+                                                                  storj_progress_cb progress_cb,
+                                                                  storj_finished_download_cb finished_cb);
+
 /**
  * @brief Register a user
  *
@@ -48,6 +48,27 @@ static uv_work_t *uv_work_new()
     return work;
 }
 
+// make sure we switch between parity and data shards files.
+// When using Reed solomon must also read from encrypted file
+// rather than the original file for the data, unless the data is
+// streamed and encrypted as it is read.
+static FILE *shard_source_file(storj_upload_state_t *state, int index)
+{
+    if (index + 1 > state->total_data_shards) {
+        return state->parity_file;
+    } else if (state->rs && !state->stream) {
+        return state->encrypted_file;
+    }
+
+    return state->original_file;
+}
+
+// Data read from the original file needs to be encrypted before sending
+static bool shard_is_plaintext(storj_upload_state_t *state, int index)
+{
+    return shard_source_file(state, index) == state->original_file;
+}
+
 static uv_work_t *frame_work_new(int *index, storj_upload_state_t *state)
 {
     uv_work_t *work = uv_work_new();
@@ -66,6 +87,7 @@ static uv_work_t *frame_work_new(int *index, storj_upload_state_t *state)
     req->error_status = 0;
     req->status_code = 0;
     req->log = state->log;
+    req->exclude = NULL;
 
     if (index != NULL) {
         req->shard_meta_index = *index;
@@ -94,16 +116,8 @@ static uv_work_t *shard_meta_work_new(int index, storj_upload_state_t *state)
     req->upload_state = state;
     req->log = state->log;
 
-    // make sure we switch between parity and data shards files.
-    // When using Reed solomon must also read from encrypted file
-    // rather than the original file for the data
-    if (index + 1 > state->total_data_shards) {
-        req->shard_file = state->parity_file;
-    } else if (state->rs) {
-        req->shard_file = state->encrypted_file;
-    } else {
-        req->shard_file = state->original_file;
-    }
+    req->shard_file = shard_source_file(state, index);
+
     // Reset shard index when using parity shards
     req->shard_meta->index = (index + 1 > state->total_data_shards) ? index - state->total_data_shards: index;
 
@@ -228,6 +242,140 @@ static void pointer_cleanup(farmer_pointer_t *farmer_pointer)
     free(farmer_pointer);
 }
 
+static uint32_t *shards_in_progress(storj_upload_state_t *state,
+                                    int progress)
+{
+    switch (progress) {
+        case PREPARING_FRAME:
+            return &state->preparing_frames;
+        case PUSHING_FRAME:
+            return &state->pushing_frames;
+        case PUSHING_SHARD:
+            return &state->pushing_shards;
+        default:
+            return NULL;
+    }
+}
+
+// Add a shard to the queues of the work that it's ready for. This is called
+// whenever the progress or report of a shard changes, and the shard is
+// checked again when it's taken from a queue.
+static void queue_ready_shard(storj_upload_state_t *state, int index)
+{
+    shard_tracker_t *shard = &state->shard[index];
+    int status = 0;
+
+    if (shard->progress == AWAITING_PREPARE_FRAME) {
+        status = index_queue_push(&state->ready_prepare_frame, index);
+    } else if (shard->progress == AWAITING_PUSH_FRAME) {
+        status = index_queue_push(&state->ready_push_frame, index);
+    } else if (shard->progress == AWAITING_PUSH_SHARD) {
+        status = index_queue_push(&state->ready_push_shard, index);
+    }
+
+    if (status) {
+        state->error_status = STORJ_MEMORY_ERROR;
+    }
+}
+
+static void set_shard_progress(storj_upload_state_t *state, int index,
+                               int progress)
+{
+    shard_tracker_t *shard = &state->shard[index];
+
+    uint32_t *in_progress = shards_in_progress(state, shard->progress);
+    if (in_progress) {
+        *in_progress -= 1;
+    }
+
+    shard->progress = progress;
+
+    in_progress = shards_in_progress(state, progress);
+    if (in_progress) {
+        *in_progress += 1;
+    }
+
+    queue_ready_shard(state, index);
+}
+
+// The journal of an upload is only continued by an upload of the same file
+// name and content, and of the same index when one is given
+static int open_upload_journal(storj_upload_state_t *state, int64_t modified)
+{
+    const char *format = "upload %s %s %" PRIu64 " %" PRId64 " %" PRIu64
+        " %d %s";
+    const char *index = (state->index) ? state->index : "-";
+
+    int length = snprintf(NULL, 0, format, state->bucket_id,
+                          state->encrypted_file_name, state->file_size,
+                          modified, state->shard_size, state->rs, index);
+
+    char *identity = calloc(length + 1, sizeof(char));
+    if (!identity) {
+        return STORJ_MEMORY_ERROR;
+    }
+
+    snprintf(identity, length + 1, format, state->bucket_id,
+             state->encrypted_file_name, state->file_size,
+             modified, state->shard_size, state->rs, index);
+
+    int status = journal_open(state->journal_path, identity, &state->journal);
+
+    free(identity);
+
+    return status;
+}
+
+// Shards that were pushed by an earlier upload are completed with the hash
+// and size that were recorded, and the frame is reused
+static int restore_upload_journal(storj_upload_state_t *state)
+{
+    const char *frame_id = journal_find(state->journal, "frame", 0);
+    if (frame_id) {
+        state->frame_id = strdup(frame_id);
+        if (!state->frame_id) {
+            return STORJ_MEMORY_ERROR;
+        }
+    }
+
+    for (int i = 0; i < state->total_shards; i++) {
+        const char *value = journal_find(state->journal, "shard", i);
+        if (!value) {
+            continue;
+        }
+
+        char hash[RIPEMD160_DIGEST_SIZE * 2 + 1];
+        uint64_t size = 0;
+        if (sscanf(value, "%40s %" SCNu64, hash, &size) != 2 ||
+            strlen(hash) != RIPEMD160_DIGEST_SIZE * 2) {
+            continue;
+        }
+
+        shard_tracker_t *shard = &state->shard[i];
+        shard->meta->hash = strdup(hash);
+        if (!shard->meta->hash) {
+            return STORJ_MEMORY_ERROR;
+        }
+        shard->meta->index = i;
+        shard->meta->size = size;
+        shard->progress = COMPLETED_PUSH_SHARD;
+        shard->uploaded_size = size;
+        state->completed_shards += 1;
+    }
+
+    return 0;
+}
+
+static int append_shard_journal(storj_upload_state_t *state, int index)
+{
+    shard_meta_t *meta = state->shard[index].meta;
+
+    char value[RIPEMD160_DIGEST_SIZE * 2 + 32];
+    snprintf(value, sizeof(value), "%s %" PRIu64, meta->hash, meta->size);
+
+    return journal_append(state->journal, "shard", index, value);
+}
+
 static void cleanup_state(storj_upload_state_t *state)
 {
     if (state->final_callback_called) {
@@ -252,10 +400,6 @@ static void cleanup_state(storj_upload_state_t *state)
         free((char *)state->encrypted_file_name);
     }
 
-    if (state->exclude) {
-        free(state->exclude);
-    }
-
     if (state->index) {
         free((char *)state->index);
     }
@@ -268,6 +412,10 @@ static void cleanup_state(storj_upload_state_t *state)
         free(state->encryption_key);
     }
 
+    // the journal is kept to continue an upload that didn't complete
+    journal_close(state->journal,
+                  state->completed_upload && !state->error_status);
+
     if (state->parity_file) {
         fclose(state->parity_file);
     }
@@ -305,6 +453,13 @@ static void cleanup_state(storj_upload_state_t *state)
         free(state->shard);
     }
 
+    index_queue_free(&state->ready_prepare_frame);
+    index_queue_free(&state->ready_push_frame);
+    index_queue_free(&state->ready_push_shard);
+
+    // the reports of the shards are sent without waiting for a full batch
+    report_queue_flush(state->env->reports);
+
     state->finished_cb(state->error_status, state->info, state->handle);
 
     free(state);
@@ -576,6 +731,27 @@ static void free_push_shard_work(uv_handle_t *progress_handle)
     }
 }
 
+// A shard transfer that couldn't be started, the upload continues once
+// the progress handle has been closed
+static void free_failed_push_shard_work(uv_handle_t *progress_handle)
+{
+    uv_work_t *work = progress_handle->data;
+    push_shard_request_t *req = work->data;
+    storj_upload_state_t *state = req->upload_state;
+
+    free_push_shard_work(progress_handle);
+
+    state->pending_work_count -= 1;
+    queue_next_work(state);
+}
+
+static void log_push_concurrency(storj_upload_state_t *state)
+{
+    state->log->info(state->env->log_options, state->handle,
+                     "Pushing up to %" PRIu32 " shards at once",
+                     state->push_concurrency.limit);
+}
+
 static void after_push_shard(uv_work_t *work, int status)
 {
     push_shard_request_t *req = work->data;
@@ -593,8 +769,7 @@ static void after_push_shard(uv_work_t *work, int status)
 
     if (status == UV_ECANCELED) {
         shard->push_shard_request_count = 0;
-        shard->progress = AWAITING_PUSH_FRAME;
-        shard->report->send_status = STORJ_REPORT_NOT_PREPARED;
+        set_shard_progress(state, req->shard_meta_index, AWAITING_PUSH_FRAME);
         goto clean_variables;
     }
 
@@ -612,24 +787,50 @@ static void after_push_shard(uv_work_t *work, int status)
                        "Successfully transferred shard index %d",
                        req->shard_meta_index);
 
-        shard->progress = COMPLETED_PUSH_SHARD;
+        set_shard_progress(state, req->shard_meta_index, COMPLETED_PUSH_SHARD);
         state->completed_shards += 1;
         shard->push_shard_request_count = 0;
 
+        if (concurrency_add_transfer(&state->push_concurrency,
+                                     shard->meta->size, req->start, req->end)) {
+            log_push_concurrency(state);
+        }
+
         // Update the uploaded size outside of the progress async handle
         shard->uploaded_size = shard->meta->size;
 
+        if (state->journal) {
+            int journal_status = append_shard_journal(state,
+                                                      req->shard_meta_index);
+            if (journal_status) {
+                state->error_status = journal_status;
+            }
+        }
+
         // Update the exchange report with success
         shard->report->code = STORJ_REPORT_SUCCESS;
         shard->report->message = STORJ_REPORT_SHARD_UPLOADED;
-        shard->report->send_status = STORJ_REPORT_AWAITING_SEND;
+
+        if (farmer_table_add_report(state->env->farmers, shard->report) ||
+            report_queue_add(state->env->reports, shard->report)) {
+            state->error_status = STORJ_MEMORY_ERROR;
+        }
 
     } else if (!state->canceled){
 
+        if (concurrency_add_failure(&state->push_concurrency)) {
+            log_push_concurrency(state);
+        }
+
         // Update the exchange report with failure
         shard->report->code = STORJ_REPORT_FAILURE;
         shard->report->message = STORJ_REPORT_UPLOAD_ERROR;
-        shard->report->send_status = STORJ_REPORT_AWAITING_SEND;
+
+        // the farmer is excluded from the next frame pushes
+        if (farmer_table_add_report(state->env->farmers, shard->report) ||
+            report_queue_add(state->env->reports, shard->report)) {
+            state->error_status = STORJ_MEMORY_ERROR;
+        }
 
         if (shard->push_shard_request_count == 6) {
 
@@ -643,24 +844,8 @@ static void after_push_shard(uv_work_t *work, int status)
                            req->shard_meta_index);
 
             // We go back to getting a new pointer instead of retrying push with same pointer
-            shard->progress = AWAITING_PUSH_FRAME;
+            set_shard_progress(state, req->shard_meta_index, AWAITING_PUSH_FRAME);
             shard->push_shard_request_count += 1;
-
-            // Add pointer to exclude for future calls
-            if (state->exclude == NULL) {
-                state->exclude = calloc(strlen(shard->pointer->farmer_node_id) + 1, sizeof(char));
-                if (!state->exclude) {
-                    state->error_status = STORJ_MEMORY_ERROR;
-                    return;
-                }
-                strcpy(state->exclude, shard->pointer->farmer_node_id);
-            } else {
-                int new_len = strlen(state->exclude) + strlen(shard->pointer->farmer_node_id) + 1;
-                state->exclude = realloc(state->exclude, new_len + 1);
-                strcat(state->exclude, ",");
-                strcat(state->exclude, shard->pointer->farmer_node_id);
-                state->exclude[new_len] = '\0';
-            }
         }
     }
 
@@ -670,7 +855,37 @@ clean_variables:
     uv_close(progress_handle, free_push_shard_work);
 }
 
-static void push_shard(uv_work_t *work)
+static void after_put_shard(int error_status, int status_code, int read_code,
+                            void *handle)
+{
+    uv_work_t *work = handle;
+    push_shard_request_t *req = work->data;
+    storj_upload_state_t *state = req->upload_state;
+
+    if (read_code != 0) {
+        req->log->error(state->env->log_options, state->handle,
+                        "Put shard read error: %i", read_code);
+    }
+
+    if (error_status) {
+        req->error_status = error_status;
+        req->log->error(state->env->log_options, state->handle,
+                        "Put shard request error code: %i", error_status);
+    }
+
+    req->end = get_time_milliseconds();
+
+    req->status_code = status_code;
+
+    if (req->encryption_ctx) {
+        free_encryption_ctx(req->encryption_ctx);
+        req->encryption_ctx = NULL;
+    }
+
+    after_push_shard(work, 0);
+}
+
+static int push_shard(uv_work_t *work)
 {
     push_shard_request_t *req = work->data;
     storj_upload_state_t *state = req->upload_state;
@@ -681,61 +896,49 @@ static void push_shard(uv_work_t *work)
                    req->shard_meta_index,
                    state->shard[req->shard_meta_index].push_shard_request_count);
 
-    int status_code = 0;
-    int read_code = 0;
-
     req->start = get_time_milliseconds();
 
     uint64_t file_position = req->shard_index * state->shard_size;
 
-    storj_encryption_ctx_t *encryption_ctx = NULL;
-    if (!state->rs) {
+    if (shard_is_plaintext(state, req->shard_meta_index)) {
         // Initialize the encryption context
-        encryption_ctx = prepare_encryption_ctx(state->encryption_ctr,
-                                                                        state->encryption_key);
-        if (!encryption_ctx) {
-            state->error_status = STORJ_MEMORY_ERROR;
-            goto clean_variables;
+        req->encryption_ctx = prepare_encryption_ctx(state->encryption_ctr,
+                                                     state->encryption_key);
+        if (!req->encryption_ctx) {
+            return STORJ_MEMORY_ERROR;
         }
         // Increment the iv to proper placement because we may be reading from the middle of the file
-        increment_ctr_aes_iv(encryption_ctx->encryption_ctr, req->shard_meta_index * state->shard_size);
-    }
+        increment_ctr_aes_iv(req->encryption_ctx->encryption_ctr, req->shard_meta_index * state->shard_size);
+    }
+
+    // The shard is sent from the event loop and after_put_shard is
+    // called once the transfer has finished
+    int status = put_shard(state->env->http_multi,
+                           shard->pointer->farmer_node_id,
+                           "http",
+                           shard->pointer->farmer_address,
+                           atoi(shard->pointer->farmer_port),
+                           shard->meta->hash,
+                           shard->meta->size,
+                           req->shard_file,
+                           file_position,
+                           req->encryption_ctx,
+                           shard->pointer->token,
+                           &req->progress_handle,
+                           req->canceled,
+                           state->bandwidth_weight,
+                           after_put_shard,
+                           work);
 
-    int req_status = put_shard(req->http_options,
-                               shard->pointer->farmer_node_id,
-                               "http",
-                               shard->pointer->farmer_address,
-                               atoi(shard->pointer->farmer_port),
-                               shard->meta->hash,
-                               shard->meta->size,
-                               req->shard_file,
-                               file_position,
-                               encryption_ctx,
-                               shard->pointer->token,
-                               &status_code,
-                               &read_code,
-                               &req->progress_handle,
-                               req->canceled);
-
-    if (read_code != 0) {
-        req->log->error(state->env->log_options, state->handle,
-                        "Put shard read error: %i", read_code);
-    }
-
-    if (req_status) {
-        req->error_status = req_status;
-        req->log->error(state->env->log_options, state->handle,
-                        "Put shard request error code: %i", req_status);
+    if (status) {
+        if (req->encryption_ctx) {
+            free_encryption_ctx(req->encryption_ctx);
+            req->encryption_ctx = NULL;
+        }
+        return STORJ_QUEUE_ERROR;
     }
 
-    req->end = get_time_milliseconds();
-
-    req->status_code = status_code;
-
-clean_variables:
-    if (encryption_ctx) {
-        free_encryption_ctx(encryption_ctx);
-    }
+    return 0;
 }
 
 static void progress_put_shard(uv_async_t* async)
@@ -786,6 +989,7 @@ static void queue_push_shard(storj_upload_state_t *state, int index)
 
     push_shard_request_t *req = malloc(sizeof(push_shard_request_t));
     if (!req) {
+        free(work);
         state->error_status = STORJ_MEMORY_ERROR;
         return;
     }
@@ -799,16 +1003,7 @@ static void queue_push_shard(storj_upload_state_t *state, int index)
     // Reset shard index when using parity shards
     req->shard_index = (index + 1 > state->total_data_shards) ? index - state->total_data_shards: index;
 
-    // make sure we switch between parity and data shards files.
-    // When using Reed solomon must also read from encrypted file
-    // rather than the original file for the data
-    if (index + 1 > state->total_data_shards) {
-        req->shard_file = state->parity_file;
-    } else if (state->rs) {
-        req->shard_file = state->encrypted_file;
-    } else {
-        req->shard_file = state->original_file;
-    }
+    req->shard_file = shard_source_file(state, index);
 
     // Position on shard_meta array
     req->shard_meta_index = index;
@@ -817,11 +1012,15 @@ static void queue_push_shard(storj_upload_state_t *state, int index)
 
     req->canceled = &state->canceled;
 
+    req->encryption_ctx = NULL;
+
     // setup upload progress reporting
     shard_upload_progress_t *progress =
         malloc(sizeof(shard_upload_progress_t));
 
     if (!progress) {
+        free(req);
+        free(work);
         state->error_status = STORJ_MEMORY_ERROR;
         return;
     }
@@ -838,15 +1037,21 @@ static void queue_push_shard(storj_upload_state_t *state, int index)
     work->data = req;
 
     state->pending_work_count += 1;
-    int status = uv_queue_work(state->env->loop, (uv_work_t*) work,
-                               push_shard, after_push_shard);
+    int status = push_shard(work);
 
     if (status) {
-        state->error_status = STORJ_QUEUE_ERROR;
+        // the transfer wasn't started and after_push_shard won't be
+        // called, the work is pending until the handle has been closed
+        state->error_status = status;
+
+        free(progress);
+        req->progress_handle.data = work;
+        uv_close((uv_handle_t *)&req->progress_handle,
+                 free_failed_push_shard_work);
         return;
     }
 
-    state->shard[index].progress = PUSHING_SHARD;
+    set_shard_progress(state, index, PUSHING_SHARD);
 
     if (state->shard[index].report->farmer_id != NULL) {
         free(state->shard[index].report);
@@ -885,7 +1090,7 @@ static void after_push_frame(uv_work_t *work, int status)
 
     if (status == UV_ECANCELED) {
         state->shard[req->shard_meta_index].push_frame_request_count = 0;
-        state->shard[req->shard_meta_index].progress = AWAITING_PUSH_FRAME;
+        set_shard_progress(state, req->shard_meta_index, AWAITING_PUSH_FRAME);
         goto clean_variables;
     }
 
@@ -902,7 +1107,7 @@ static void after_push_frame(uv_work_t *work, int status)
 
         // Reset for if we need to get a new pointer later
         state->shard[req->shard_meta_index].push_frame_request_count = 0;
-        state->shard[req->shard_meta_index].progress = AWAITING_PUSH_SHARD;
+        set_shard_progress(state, req->shard_meta_index, AWAITING_PUSH_SHARD);
 
         farmer_pointer_t *p = state->shard[req->shard_meta_index].pointer;
 
@@ -983,7 +1188,7 @@ static void after_push_frame(uv_work_t *work, int status)
                STORJ_MAX_PUSH_FRAME_COUNT) {
         state->error_status = STORJ_BRIDGE_OFFER_ERROR;
     } else {
-        state->shard[req->shard_meta_index].progress = AWAITING_PUSH_FRAME;
+        set_shard_progress(state, req->shard_meta_index, AWAITING_PUSH_FRAME);
     }
 
 clean_variables:
@@ -992,6 +1197,7 @@ clean_variables:
         pointer_cleanup(pointer);
     }
 
+    free(req->exclude);
     free(req);
     free(work);
 }
@@ -1055,20 +1261,15 @@ static void push_frame(uv_work_t *work)
 
     // Add exclude (Don't try to upload to farmers that have failed before)
     json_object *exclude = json_object_new_array();
-    if (state->exclude) {
-        char *exclude_list = calloc(strlen(state->exclude) + 1, sizeof(char));
-        if (!exclude_list) {
-            req->error_status = STORJ_MEMORY_ERROR;
-            goto clean_variables;
-        }
-        strcpy(exclude_list, state->exclude);
-
-        char *node_id = strtok(exclude_list, ",");
-        while (node_id != NULL) {
-            json_object_array_add(exclude, json_object_new_string(node_id));
-            node_id = strtok (NULL, ",");
+    char *node_id = req->exclude;
+    while (node_id != NULL) {
+        char *next = strchr(node_id, ',');
+        if (next) {
+            *next = '\0';
+            next += 1;
         }
-        free(exclude_list);
+        json_object_array_add(exclude, json_object_new_string(node_id));
+        node_id = next;
     }
 
     json_object_object_add(body, "exclude", exclude);
@@ -1235,10 +1436,30 @@ clean_variables:
 
 static void queue_push_frame(storj_upload_state_t *state, int index)
 {
-    if (state->shard[index].pointer->token != NULL) {
-        pointer_cleanup(state->shard[index].pointer);
-        state->shard[index].pointer = farmer_pointer_new();
-        if (!state->shard[index].pointer) {
+    shard_tracker_t *shard = &state->shard[index];
+
+    // farmers that have recently failed with any transfer of the env, and
+    // the farmer that the shard failed to be pushed to
+    const char *failed_node_id = NULL;
+    if (shard->push_shard_request_count > 0 && shard->pointer->token) {
+        failed_node_id = shard->pointer->farmer_node_id;
+    }
+
+    char *exclude = NULL;
+    int exclude_status = farmer_table_exclude_list(state->env->farmers,
+                                                   failed_node_id,
+                                                   get_time_milliseconds(),
+                                                   &exclude);
+    if (exclude_status) {
+        state->error_status = exclude_status;
+        return;
+    }
+
+    if (shard->pointer->token != NULL) {
+        pointer_cleanup(shard->pointer);
+        shard->pointer = farmer_pointer_new();
+        if (!shard->pointer) {
+            free(exclude);
             state->error_status = STORJ_MEMORY_ERROR;
             return;
         }
@@ -1246,10 +1467,14 @@ static void queue_push_frame(storj_upload_state_t *state, int index)
 
     uv_work_t *shard_work = frame_work_new(&index, state);
     if (!shard_work) {
+        free(exclude);
         state->error_status = STORJ_MEMORY_ERROR;
         return;
     }
 
+    frame_request_t *req = shard_work->data;
+    req->exclude = exclude;
+
     state->pending_work_count += 1;
     int status = uv_queue_work(state->env->loop, (uv_work_t*) shard_work,
                                push_frame, after_push_frame);
@@ -1258,89 +1483,100 @@ static void queue_push_frame(storj_upload_state_t *state, int index)
         return;
     }
 
-    state->shard[index].progress = PUSHING_FRAME;
+    set_shard_progress(state, index, PUSHING_FRAME);
 }
 
-static void after_prepare_frame(uv_work_t *work, int status)
+static int apply_shard_meta(storj_upload_state_t *state, int index,
+                            shard_meta_t *shard_meta)
 {
-    frame_builder_t *req = work->data;
-    shard_meta_t *shard_meta = req->shard_meta;
-    storj_upload_state_t *state = req->upload_state;
-
-    state->pending_work_count -= 1;
-
-    if (status == UV_ECANCELED) {
-        state->shard[shard_meta->index].progress = AWAITING_PREPARE_FRAME;
-        goto clean_variables;
-    }
-
-    if (req->error_status) {
-        state->error_status = req->error_status;
-        goto clean_variables;
-    }
-
-    /* set the shard_meta to a struct array in the state for later use. */
-
     // Add Hash
-    state->shard[req->shard_meta_index].meta->hash =
+    state->shard[index].meta->hash =
         calloc(RIPEMD160_DIGEST_SIZE * 2 + 1, sizeof(char));
 
-    if (!state->shard[req->shard_meta_index].meta->hash) {
-        state->error_status = STORJ_MEMORY_ERROR;
-        goto clean_variables;
+    if (!state->shard[index].meta->hash) {
+        return STORJ_MEMORY_ERROR;
     }
 
-    memcpy(state->shard[req->shard_meta_index].meta->hash,
+    memcpy(state->shard[index].meta->hash,
            shard_meta->hash,
            RIPEMD160_DIGEST_SIZE * 2);
 
-    req->log->info(state->env->log_options, state->handle,
-                  "Shard (%d) hash: %s", req->shard_meta_index,
-                  state->shard[req->shard_meta_index].meta->hash);
+    state->log->info(state->env->log_options, state->handle,
+                  "Shard (%d) hash: %s", index,
+                  state->shard[index].meta->hash);
 
     // Add challenges_as_str
     state->log->debug(state->env->log_options, state->handle,
                       "Challenges for shard index %d",
-                      req->shard_meta_index);
+                      index);
 
     for (int i = 0; i < STORJ_SHARD_CHALLENGES; i++ ) {
-        memcpy(state->shard[req->shard_meta_index].meta->challenges_as_str[i],
+        memcpy(state->shard[index].meta->challenges_as_str[i],
                shard_meta->challenges_as_str[i],
                64);
 
         state->log->debug(state->env->log_options, state->handle,
                           "Shard %d Challenge [%d]: %s",
-                        req->shard_meta_index,
+                        index,
                           i,
-                          state->shard[req->shard_meta_index].meta->challenges_as_str[i]);
+                          state->shard[index].meta->challenges_as_str[i]);
     }
 
     // Add Merkle Tree leaves.
     state->log->debug(state->env->log_options, state->handle,
                       "Tree for shard index %d",
-                      req->shard_meta_index);
+                      index);
 
     for (int i = 0; i < STORJ_SHARD_CHALLENGES; i++ ) {
-        memcpy(state->shard[req->shard_meta_index].meta->tree[i],
+        memcpy(state->shard[index].meta->tree[i],
                shard_meta->tree[i],
                40);
 
         state->log->debug(state->env->log_options, state->handle,
-                          "Shard %d Leaf [%d]: %s", req->shard_meta_index, i,
-                          state->shard[req->shard_meta_index].meta->tree[i]);
+                          "Shard %d Leaf [%d]: %s", index, i,
+                          state->shard[index].meta->tree[i]);
     }
 
     // Add index
-    state->shard[req->shard_meta_index].meta->index = shard_meta->index;
+    state->shard[index].meta->index = shard_meta->index;
 
     // Add size
-    state->shard[req->shard_meta_index].meta->size = shard_meta->size;
+    state->shard[index].meta->size = shard_meta->size;
+
+    return 0;
+}
+
+static void after_prepare_frame(uv_work_t *work, int status)
+{
+    frame_builder_t *req = work->data;
+    shard_meta_t *shard_meta = req->shard_meta;
+    storj_upload_state_t *state = req->upload_state;
+
+    state->pending_work_count -= 1;
+
+    if (status == UV_ECANCELED) {
+        set_shard_progress(state, shard_meta->index, AWAITING_PREPARE_FRAME);
+        goto clean_variables;
+    }
+
+    if (req->error_status) {
+        state->error_status = req->error_status;
+        goto clean_variables;
+    }
+
+    /* set the shard_meta to a struct array in the state for later use. */
+    int error_status = apply_shard_meta(state, req->shard_meta_index,
+                                        shard_meta);
+    if (error_status) {
+        state->error_status = error_status;
+        goto clean_variables;
+    }
 
     state->log->info(state->env->log_options, state->handle,
                      "Successfully created frame for shard index %d",
                      req->shard_meta_index);
 
-    state->shard[req->shard_meta_index].progress = AWAITING_PUSH_FRAME;
+    set_shard_progress(state, req->shard_meta_index, AWAITING_PUSH_FRAME);
 
 clean_variables:
     queue_next_work(state);
@@ -1352,12 +1588,8 @@ clean_variables:
     free(work);
 }
 
-static void prepare_frame(uv_work_t *work)
+static int shard_hasher_init(shard_hasher_t *hasher, shard_meta_t *shard_meta)
 {
-    frame_builder_t *req = work->data;
-    shard_meta_t *shard_meta = req->shard_meta;
-    storj_upload_state_t *state = req->upload_state;
-
     // Set the challenges
     uint8_t buff[32];
     for (int i = 0; i < STORJ_SHARD_CHALLENGES; i++ ) {
@@ -1369,8 +1601,7 @@ static void prepare_frame(uv_work_t *work)
         // Convert the uint8_t challenges to character arrays
         char *challenge_as_str = hex2str(32, buff);
         if (!challenge_as_str) {
-            req->error_status = STORJ_MEMORY_ERROR;
-            goto clean_variables;
+            return STORJ_MEMORY_ERROR;
         }
         memcpy(shard_meta->challenges_as_str[i], challenge_as_str, strlen(challenge_as_str));
         free(challenge_as_str);
@@ -1379,46 +1610,102 @@ static void prepare_frame(uv_work_t *work)
     // Hash of the shard_data
     shard_meta->hash = calloc(RIPEMD160_DIGEST_SIZE*2 + 2, sizeof(char));
     if (!shard_meta->hash) {
-        req->error_status = STORJ_MEMORY_ERROR;
-        goto clean_variables;
+        return STORJ_MEMORY_ERROR;
     }
 
-    req->log->info(state->env->log_options, state->handle,
-                   "Creating frame for shard index %d",
-                   req->shard_meta_index);
-
-    // Sha256 of encrypted data for calculating shard has
-    uint8_t prehash_sha256[SHA256_DIGEST_SIZE];
-
     // Initialize context for sha256 of encrypted data
-    struct sha256_ctx shard_hash_ctx;
-    sha256_init(&shard_hash_ctx);
+    sha256_init(&hasher->lanes[0]);
 
     // Calculate the merkle tree with challenges
-    struct sha256_ctx first_sha256_for_leaf[STORJ_SHARD_CHALLENGES];
     for (int i = 0; i < STORJ_SHARD_CHALLENGES; i++ ) {
-        sha256_init(&first_sha256_for_leaf[i]);
-        sha256_update(&first_sha256_for_leaf[i], 32, (uint8_t *)&shard_meta->challenges[i]);
+        sha256_init(&hasher->lanes[i + 1]);
+        sha256_update(&hasher->lanes[i + 1], 32, (uint8_t *)&shard_meta->challenges[i]);
     }
 
-    storj_encryption_ctx_t *encryption_ctx = NULL;
-    if (!state->rs) {
-        // Initialize the encryption context
-        encryption_ctx = prepare_encryption_ctx(state->encryption_ctr, state->encryption_key);
-        if (!encryption_ctx) {
-            state->error_status = STORJ_MEMORY_ERROR;
-            goto clean_variables;
-        }
-        // Increment the iv to proper placement because we may be reading from the middle of the file
-        increment_ctr_aes_iv(encryption_ctx->encryption_ctr, req->shard_meta_index * state->shard_size);
-    }
+    return 0;
+}
 
-    uint8_t cphr_txt[AES_BLOCK_SIZE * 256];
-    memset_zero(cphr_txt, AES_BLOCK_SIZE * 256);
-    char read_data[AES_BLOCK_SIZE * 256];
-    memset_zero(read_data, AES_BLOCK_SIZE * 256);
-    unsigned long int read_bytes = 0;
-    uint64_t total_read = 0;
+static void shard_hasher_update(shard_hasher_t *hasher, size_t length,
+                                const uint8_t *cphr_txt)
+{
+    sha256_update_lanes(hasher->lanes, SHARD_HASHER_LANES, length, cphr_txt);
+}
+
+static int shard_hasher_finish(shard_hasher_t *hasher, shard_meta_t *shard_meta)
+{
+    // Sha256 of encrypted data for calculating shard has
+    uint8_t prehash_sha256[SHA256_DIGEST_SIZE];
+
+    sha256_digest(&hasher->lanes[0], SHA256_DIGEST_SIZE, prehash_sha256);
+
+    uint8_t prehash_ripemd160[RIPEMD160_DIGEST_SIZE];
+    memset_zero(prehash_ripemd160, RIPEMD160_DIGEST_SIZE);
+    ripemd160_of_str(prehash_sha256, SHA256_DIGEST_SIZE, prehash_ripemd160);
+
+    // Shard Hash
+    char *hash = hex2str(RIPEMD160_DIGEST_SIZE, prehash_ripemd160);
+    if (!hash) {
+        return STORJ_MEMORY_ERROR;
+    }
+    memcpy(shard_meta->hash, hash, strlen(hash));
+    free(hash);
+
+    uint8_t preleaf_sha256[SHA256_DIGEST_SIZE];
+    memset_zero(preleaf_sha256, SHA256_DIGEST_SIZE);
+    uint8_t preleaf_ripemd160[RIPEMD160_DIGEST_SIZE];
+    memset_zero(preleaf_ripemd160, RIPEMD160_DIGEST_SIZE);
+    char leaf[RIPEMD160_DIGEST_SIZE*2 +1];
+    memset(leaf, '\0', RIPEMD160_DIGEST_SIZE*2 +1);
+    for (int i = 0; i < STORJ_SHARD_CHALLENGES; i++ ) {
+        // finish first sha256 for leaf
+        sha256_digest(&hasher->lanes[i + 1], SHA256_DIGEST_SIZE, preleaf_sha256);
+
+        // ripemd160 result of sha256
+        ripemd160_of_str(preleaf_sha256, SHA256_DIGEST_SIZE, preleaf_ripemd160);
+
+        // sha256 and ripemd160 again
+        ripemd160sha256_as_string(preleaf_ripemd160, RIPEMD160_DIGEST_SIZE, leaf);
+
+        memcpy(shard_meta->tree[i], leaf, RIPEMD160_DIGEST_SIZE*2 + 1);
+    }
+
+    return 0;
+}
+
+static void prepare_frame(uv_work_t *work)
+{
+    frame_builder_t *req = work->data;
+    shard_meta_t *shard_meta = req->shard_meta;
+    storj_upload_state_t *state = req->upload_state;
+    storj_encryption_ctx_t *encryption_ctx = NULL;
+    shard_hasher_t hasher;
+
+    req->error_status = shard_hasher_init(&hasher, shard_meta);
+    if (req->error_status) {
+        goto clean_variables;
+    }
+
+    req->log->info(state->env->log_options, state->handle,
+                   "Creating frame for shard index %d",
+                   req->shard_meta_index);
+
+    if (shard_is_plaintext(state, req->shard_meta_index)) {
+        // Initialize the encryption context
+        encryption_ctx = prepare_encryption_ctx(state->encryption_ctr, state->encryption_key);
+        if (!encryption_ctx) {
+            state->error_status = STORJ_MEMORY_ERROR;
+            goto clean_variables;
+        }
+        // Increment the iv to proper placement because we may be reading from the middle of the file
+        increment_ctr_aes_iv(encryption_ctx->encryption_ctr, req->shard_meta_index * state->shard_size);
+    }
+
+    uint8_t cphr_txt[AES_BLOCK_SIZE * 256];
+    memset_zero(cphr_txt, AES_BLOCK_SIZE * 256);
+    char read_data[AES_BLOCK_SIZE * 256];
+    memset_zero(read_data, AES_BLOCK_SIZE * 256);
+    unsigned long int read_bytes = 0;
+    uint64_t total_read = 0;
 
     do {
         if (state->canceled) {
@@ -1439,21 +1726,16 @@ static void prepare_frame(uv_work_t *work)
 
         total_read += read_bytes;
 
-        if (!state->rs) {
+        if (encryption_ctx) {
             // Encrypt data
-            ctr_crypt(encryption_ctx->ctx, (nettle_cipher_func *)aes256_encrypt,
-                      AES_BLOCK_SIZE, encryption_ctx->encryption_ctr, read_bytes,
-                      (uint8_t *)cphr_txt, (uint8_t *)read_data);
+            aes256_ctr_crypt(encryption_ctx->ctx, encryption_ctx->encryption_ctr, read_bytes,
+                             (uint8_t *)cphr_txt, (uint8_t *)read_data);
         } else {
             // Just use the already encrypted data
             memcpy(cphr_txt, read_data, AES_BLOCK_SIZE*256);
         }
 
-        sha256_update(&shard_hash_ctx, read_bytes, cphr_txt);
-
-        for (int i = 0; i < STORJ_SHARD_CHALLENGES; i++ ) {
-            sha256_update(&first_sha256_for_leaf[i], read_bytes, cphr_txt);
-        }
+        shard_hasher_update(&hasher, read_bytes, cphr_txt);
 
         memset_zero(read_data, AES_BLOCK_SIZE * 256);
         memset_zero(cphr_txt, AES_BLOCK_SIZE * 256);
@@ -1462,39 +1744,7 @@ static void prepare_frame(uv_work_t *work)
 
     shard_meta->size = total_read;
 
-    sha256_digest(&shard_hash_ctx, SHA256_DIGEST_SIZE, prehash_sha256);
-
-    uint8_t prehash_ripemd160[RIPEMD160_DIGEST_SIZE];
-    memset_zero(prehash_ripemd160, RIPEMD160_DIGEST_SIZE);
-    ripemd160_of_str(prehash_sha256, SHA256_DIGEST_SIZE, prehash_ripemd160);
-
-    // Shard Hash
-    char *hash = hex2str(RIPEMD160_DIGEST_SIZE, prehash_ripemd160);
-    if (!hash) {
-        req->error_status = STORJ_MEMORY_ERROR;
-        goto clean_variables;
-    }
-    memcpy(shard_meta->hash, hash, strlen(hash));
-    free(hash);
-
-    uint8_t preleaf_sha256[SHA256_DIGEST_SIZE];
-    memset_zero(preleaf_sha256, SHA256_DIGEST_SIZE);
-    uint8_t preleaf_ripemd160[RIPEMD160_DIGEST_SIZE];
-    memset_zero(preleaf_ripemd160, RIPEMD160_DIGEST_SIZE);
-    char leaf[RIPEMD160_DIGEST_SIZE*2 +1];
-    memset(leaf, '\0', RIPEMD160_DIGEST_SIZE*2 +1);
-    for (int i = 0; i < STORJ_SHARD_CHALLENGES; i++ ) {
-        // finish first sha256 for leaf
-        sha256_digest(&first_sha256_for_leaf[i], SHA256_DIGEST_SIZE, preleaf_sha256);
-
-        // ripemd160 result of sha256
-        ripemd160_of_str(preleaf_sha256, SHA256_DIGEST_SIZE, preleaf_ripemd160);
-
-        // sha256 and ripemd160 again
-        ripemd160sha256_as_string(preleaf_ripemd160, RIPEMD160_DIGEST_SIZE, leaf);
-
-        memcpy(shard_meta->tree[i], leaf, RIPEMD160_DIGEST_SIZE*2 + 1);
-    }
+    req->error_status = shard_hasher_finish(&hasher, shard_meta);
 
 clean_variables:
     if (encryption_ctx) {
@@ -1519,7 +1769,7 @@ static void queue_prepare_frame(storj_upload_state_t *state, int index)
         return;
     }
 
-    state->shard[index].progress = PREPARING_FRAME;
+    set_shard_progress(state, index, PREPARING_FRAME);
 }
 
 static void after_create_encrypted_file(uv_work_t *work, int status)
@@ -1616,9 +1866,8 @@ static void create_encrypted_file(uv_work_t *work)
         }
 
         // Encrypt data
-        ctr_crypt(encryption_ctx->ctx, (nettle_cipher_func *)aes256_encrypt,
-                  AES_BLOCK_SIZE, encryption_ctx->encryption_ctr, read_bytes,
-                  (uint8_t *)cphr_txt, (uint8_t *)read_data);
+        aes256_ctr_crypt(encryption_ctx->ctx, encryption_ctx->encryption_ctr, read_bytes,
+                         (uint8_t *)cphr_txt, (uint8_t *)read_data);
 
         written_bytes = pwrite(fileno(encrypted_file), cphr_txt, read_bytes, total_read);
 
@@ -1694,6 +1943,14 @@ static void after_request_frame_id(uv_work_t *work, int status)
 
         state->frame_id = req->frame_id;
 
+        if (state->journal) {
+            int journal_status = journal_append(state->journal, "frame", 0,
+                                                state->frame_id);
+            if (journal_status) {
+                state->error_status = journal_status;
+            }
+        }
+
     } else if (state->frame_request_count == 6) {
         state->error_status = STORJ_BRIDGE_FRAME_ERROR;
     }
@@ -1819,6 +2076,75 @@ clean_variables:
     free(work);
 }
 
+static void encode_parity_range(void *arg)
+{
+    parity_range_job_t *job = arg;
+
+    reed_solomon_encode_range(job->rs, job->data_blocks, job->fec_blocks,
+                              job->block_size, job->total_bytes,
+                              job->offset, job->length);
+}
+
+static void encode_parity_ranges(reed_solomon *rs, uint8_t **data_blocks,
+                                 uint8_t **fec_blocks, uint64_t block_size,
+                                 uint64_t total_bytes, int thread_count)
+{
+    // Each thread gets a contiguous range of every shard, aligned to the
+    // encoder stripe size and not smaller than the minimum range
+    uint64_t max_threads = block_size / STORJ_MIN_ENCODE_RANGE;
+    if ((uint64_t)thread_count > max_threads) {
+        thread_count = max_threads;
+    }
+    if (thread_count < 1) {
+        thread_count = 1;
+    }
+
+    uint64_t range = block_size / thread_count;
+    range = ((range + RS_STRIPE_SIZE - 1) / RS_STRIPE_SIZE) * RS_STRIPE_SIZE;
+
+    parity_range_job_t jobs[thread_count];
+    uv_thread_t threads[thread_count];
+    int started = 0;
+    bool failed = false;
+
+    for (int i = 0; i < thread_count; i++) {
+        jobs[i].rs = rs;
+        jobs[i].data_blocks = data_blocks;
+        jobs[i].fec_blocks = fec_blocks;
+        jobs[i].block_size = block_size;
+        jobs[i].total_bytes = total_bytes;
+        jobs[i].offset = i * range;
+        jobs[i].length = range;
+    }
+
+    // The first range is encoded by the calling thread
+    for (int i = 1; i < thread_count; i++) {
+        if (jobs[i].offset >= block_size) {
+            break;
+        }
+        if (uv_thread_create(&threads[i], encode_parity_range, &jobs[i])) {
+            failed = true;
+            break;
+        }
+        started = i;
+    }
+
+    encode_parity_range(&jobs[0]);
+
+    for (int i = 1; i <= started; i++) {
+        uv_thread_join(&threads[i]);
+    }
+
+    // Finish any ranges that a thread could not be started for
+    if (failed) {
+        for (int i = started + 1; i < thread_count; i++) {
+            if (jobs[i].offset < block_size) {
+                encode_parity_range(&jobs[i]);
+            }
+        }
+    }
+}
+
 static void create_parity_shards(uv_work_t *work)
 {
     parity_shard_req_t *req = work->data;
@@ -1920,17 +2246,26 @@ static void create_parity_shards(uv_work_t *work)
     state->log->debug(state->env->log_options, state->handle,
                       "Encoding parity shards, data_shards: %i, "       \
                       "parity_shards: %i, shard_size: %" PRIu64 ", "    \
-                      "file_size: %" PRIu64,
+                      "file_size: %" PRIu64 ", threads: %i",
                       state->total_data_shards,
                       state->total_parity_shards,
                       state->shard_size,
-                      state->file_size);
+                      state->file_size,
+                      state->encode_threads);
 
 
     reed_solomon *rs = reed_solomon_new(state->total_data_shards,
                                         state->total_parity_shards);
-    reed_solomon_encode2(rs, data_blocks, fec_blocks, state->total_shards,
-                         state->shard_size, state->file_size);
+    if (!rs) {
+        req->error_status = 1;
+        state->log->error(state->env->log_options, state->handle,
+                       "Unable to initialize reed solomon encoder");
+        goto clean_variables;
+    }
+
+    encode_parity_ranges(rs, data_blocks, fec_blocks, state->shard_size,
+                         state->file_size, state->encode_threads);
+
     reed_solomon_release(rs);
 
 clean_variables:
@@ -1990,128 +2325,323 @@ static void queue_create_parity_shards(storj_upload_state_t *state)
     state->awaiting_parity_shards = false;
 }
 
-static void after_send_exchange_report(uv_work_t *work, int status)
+static void after_stream_encode(uv_work_t *work, int status)
 {
-    shard_send_report_t *req = work->data;
+    stream_encode_req_t *req = work->data;
+    storj_upload_state_t *state = req->upload_state;
 
-    req->state->pending_work_count -= 1;
+    state->pending_work_count -= 1;
 
     if (status == UV_ECANCELED) {
-        req->report->send_count = 0;
-        req->report->send_status = STORJ_REPORT_AWAITING_SEND;
+        state->awaiting_parity_shards = true;
+        goto clean_variables;
+    }
+
+    if (req->error_status == STORJ_TRANSFER_CANCELED) {
+        state->log->info(state->env->log_options, state->handle,
+                         "Stopped encoding file");
+
+        state->error_status = req->error_status;
+        goto clean_variables;
+    }
+
+    if (req->error_status != 0) {
+        state->log->warn(state->env->log_options, state->handle,
+                       "Failed to encode file");
 
+        state->error_status = req->error_status;
         goto clean_variables;
     }
 
-    req->report->send_count += 1;
+    state->log->info(state->env->log_options, state->handle,
+                     "Successfully encoded file");
 
-    if (req->status_code == 201) {
-        req->state->env->log->info(req->state->env->log_options,
-                        req->state->handle,
-                         "Successfully sent exchange report for shard %d",
-                         req->report->pointer_index);
+    state->parity_file = fopen(state->parity_file_path, "r");
+    if (!state->parity_file) {
+        state->error_status = STORJ_FILE_READ_ERROR;
+        goto clean_variables;
+    }
 
-        req->report->send_status = STORJ_REPORT_NOT_PREPARED; // report has been sent
-    } else if (req->report->send_count == 6) {
-        req->report->send_status = STORJ_REPORT_NOT_PREPARED; // report failed retries
-    } else {
-        req->report->send_status = STORJ_REPORT_AWAITING_SEND; // reset report back to unsent
+    for (int i = 0; i < state->total_shards; i++) {
+        // shards pushed before the upload was continued from a journal
+        // are expected to have the same hash
+        if (state->shard[i].progress == COMPLETED_PUSH_SHARD) {
+            if (strncmp(state->shard[i].meta->hash, req->shard_meta[i]->hash,
+                        RIPEMD160_DIGEST_SIZE * 2)) {
+                state->error_status = STORJ_FILE_INTEGRITY_ERROR;
+                goto clean_variables;
+            }
+            continue;
+        }
+
+        int error_status = apply_shard_meta(state, i, req->shard_meta[i]);
+        if (error_status) {
+            state->error_status = error_status;
+            goto clean_variables;
+        }
+
+        set_shard_progress(state, i, AWAITING_PUSH_FRAME);
     }
 
 clean_variables:
-    queue_next_work(req->state);
-    free(work->data);
+    queue_next_work(state);
+    for (int i = 0; i < state->total_shards; i++) {
+        if (req->shard_meta[i]) {
+            shard_meta_cleanup(req->shard_meta[i]);
+        }
+    }
+    free(req->shard_meta);
+    free(req);
     free(work);
+}
+
+static int read_stripe(int fd, uint8_t *buffer, uint64_t length, uint64_t offset)
+{
+    uint64_t total_read = 0;
 
+    while (total_read < length) {
+        ssize_t read_bytes = pread(fd, buffer + total_read,
+                                   length - total_read, offset + total_read);
+        if (read_bytes <= 0) {
+            return 1;
+        }
+        total_read += read_bytes;
+    }
+
+    return 0;
 }
 
-static void send_exchange_report(uv_work_t *work)
+static void stream_encode(uv_work_t *work)
 {
-    shard_send_report_t *req = work->data;
-    storj_upload_state_t *state = req->state;
+    stream_encode_req_t *req = work->data;
+    storj_upload_state_t *state = req->upload_state;
 
-    struct json_object *body = json_object_new_object();
+    uint32_t data_shards = state->total_data_shards;
+    uint32_t parity_shards = state->total_parity_shards;
+    uint64_t shard_size = state->shard_size;
+    uint64_t parity_size = parity_shards * shard_size;
 
-    json_object_object_add(body, "dataHash",
-                           json_object_new_string(req->report->data_hash));
+    reed_solomon *rs = NULL;
+    FILE *parity_file = NULL;
+    uint8_t *data_buffer = NULL;
+    uint8_t *parity_buffer = NULL;
+    shard_hasher_t *hashers = NULL;
+    storj_encryption_ctx_t **encryption_ctx = NULL;
+    uint8_t *data_blocks[data_shards];
+    uint8_t *fec_blocks[parity_shards];
 
-    json_object_object_add(body, "reporterId",
-                           json_object_new_string(req->report->reporter_id));
+    // Only a stripe of every shard is held in memory at a time
+    uint64_t stripe_size = STORJ_STREAM_BUFFER_SIZE / state->total_shards;
+    stripe_size -= stripe_size % RS_STRIPE_SIZE;
+    if (stripe_size < RS_STRIPE_SIZE) {
+        stripe_size = RS_STRIPE_SIZE;
+    }
+    if (stripe_size > shard_size) {
+        stripe_size = shard_size;
+    }
 
-    json_object_object_add(body, "farmerId",
-                           json_object_new_string(req->report->farmer_id));
+    state->log->info(state->env->log_options, state->handle,
+                     "Encoding file in stripes of %" PRIu64 " bytes",
+                     stripe_size);
 
-    json_object_object_add(body, "clientId",
-                           json_object_new_string(req->report->client_id));
+    fec_init();
 
-    json_object_object_add(body, "exchangeStart",
-                           json_object_new_int64(req->report->start));
+    rs = reed_solomon_new(data_shards, parity_shards);
+    data_buffer = malloc(data_shards * stripe_size);
+    parity_buffer = malloc(parity_shards * stripe_size);
+    hashers = malloc(state->total_shards * sizeof(shard_hasher_t));
+    encryption_ctx = calloc(data_shards, sizeof(storj_encryption_ctx_t *));
+    if (!rs || !data_buffer || !parity_buffer || !hashers || !encryption_ctx) {
+        req->error_status = STORJ_MEMORY_ERROR;
+        goto clean_variables;
+    }
 
-    json_object_object_add(body, "exchangeEnd",
-                           json_object_new_int64(req->report->end));
+    for (int i = 0; i < state->total_shards; i++) {
+        req->shard_meta[i] = shard_meta_new();
+        if (!req->shard_meta[i]) {
+            req->error_status = STORJ_MEMORY_ERROR;
+            goto clean_variables;
+        }
 
-    json_object_object_add(body, "exchangeResultCode",
-                           json_object_new_int(req->report->code));
+        req->shard_meta[i]->is_parity = (i + 1 > data_shards);
+        req->shard_meta[i]->index = (i + 1 > data_shards) ? i - data_shards : i;
 
-    json_object_object_add(body, "exchangeResultMessage",
-                           json_object_new_string(req->report->message));
+        req->error_status = shard_hasher_init(&hashers[i], req->shard_meta[i]);
+        if (req->error_status) {
+            goto clean_variables;
+        }
+    }
 
-    int status_code = 0;
+    for (int i = 0; i < data_shards; i++) {
+        encryption_ctx[i] = prepare_encryption_ctx(state->encryption_ctr,
+                                                   state->encryption_key);
+        if (!encryption_ctx[i]) {
+            req->error_status = STORJ_MEMORY_ERROR;
+            goto clean_variables;
+        }
+        increment_ctr_aes_iv(encryption_ctx[i]->encryption_ctr, i * shard_size);
 
-    // there should be an empty object in response
-    struct json_object *response = NULL;
-    int request_status = fetch_json(req->http_options,
-                                    req->options, "POST",
-                                    "/reports/exchanges", body,
-                                    true, &response, &status_code);
+        data_blocks[i] = data_buffer + i * stripe_size;
+    }
 
+    for (int i = 0; i < parity_shards; i++) {
+        fec_blocks[i] = parity_buffer + i * stripe_size;
+    }
 
-    if (request_status) {
-        state->log->warn(state->env->log_options, state->handle,
-                         "Send exchange report error: %i", request_status);
+    parity_file = fopen(state->parity_file_path, "w+");
+    if (!parity_file) {
+        state->log->error(state->env->log_options, state->handle,
+                          "Could not open parity file [%s]",
+                          state->parity_file_path);
+        req->error_status = STORJ_FILE_PARITY_ERROR;
+        goto clean_variables;
     }
 
-    req->status_code = status_code;
+    if (allocatefile(fileno(parity_file), parity_size)) {
+        state->log->error(state->env->log_options, state->handle,
+                          "Could not allocate space for parity shard file");
+        req->error_status = STORJ_FILE_PARITY_ERROR;
+        goto clean_variables;
+    }
 
-    // free all memory for body and response
-    json_object_put(response);
-    json_object_put(body);
-}
+    int original_fd = fileno(state->original_file);
+    int parity_fd = fileno(parity_file);
 
-static void queue_send_exchange_report(storj_upload_state_t *state, int index)
-{
-    if (state->shard[index].report->send_count == 6) {
-        return;
+    for (uint64_t pos = 0; pos < shard_size; pos += stripe_size) {
+        // the hashes and parity of a partly encoded file are not used
+        if (state->canceled) {
+            req->error_status = STORJ_TRANSFER_CANCELED;
+            goto clean_variables;
+        }
+
+        uint64_t length = shard_size - pos;
+        if (length > stripe_size) {
+            length = stripe_size;
+        }
+
+        for (int i = 0; i < data_shards; i++) {
+            // The last data shard may be shorter than the shard size
+            uint64_t shard_offset = i * shard_size + pos;
+            uint64_t read_length = 0;
+            if (shard_offset < state->file_size) {
+                read_length = state->file_size - shard_offset;
+                if (read_length > length) {
+                    read_length = length;
+                }
+            }
+
+            if (read_length > 0) {
+                if (read_stripe(original_fd, data_blocks[i], read_length,
+                                shard_offset)) {
+                    state->log->warn(state->env->log_options, state->handle,
+                                     "Error reading file: %d", errno);
+                    req->error_status = STORJ_FILE_READ_ERROR;
+                    goto clean_variables;
+                }
+
+                aes256_ctr_crypt(encryption_ctx[i]->ctx, encryption_ctx[i]->encryption_ctr,
+                                 read_length, data_blocks[i], data_blocks[i]);
+
+                shard_hasher_update(&hashers[i], read_length, data_blocks[i]);
+
+                req->shard_meta[i]->size += read_length;
+            }
+
+            // Past the end of the file the shard is zero padded
+            memset(data_blocks[i] + read_length, 0, length - read_length);
+        }
+
+        encode_parity_ranges(rs, data_blocks, fec_blocks, length,
+                             data_shards * length, state->encode_threads);
+
+        for (int i = 0; i < parity_shards; i++) {
+            shard_hasher_update(&hashers[data_shards + i], length, fec_blocks[i]);
+
+            req->shard_meta[data_shards + i]->size += length;
+
+            if (pwrite(parity_fd, fec_blocks[i], length,
+                       i * shard_size + pos) != length) {
+                state->log->error(state->env->log_options, state->handle,
+                                  "Error writing parity file: %d", errno);
+                req->error_status = STORJ_FILE_PARITY_ERROR;
+                goto clean_variables;
+            }
+        }
     }
 
-    state->env->log->info(state->env->log_options, state->handle,
-                   "Sending exchange report for Shard index %d... (retry: %d)",
-                   index,
-                  state->shard[index].report->send_count);
+    for (int i = 0; i < state->total_shards; i++) {
+        req->error_status = shard_hasher_finish(&hashers[i], req->shard_meta[i]);
+        if (req->error_status) {
+            goto clean_variables;
+        }
+    }
 
-    shard_tracker_t *shard = &state->shard[index];
+clean_variables:
+    if (rs) {
+        reed_solomon_release(rs);
+    }
 
-    uv_work_t *work = malloc(sizeof(uv_work_t));
-    assert(work != NULL);
+    if (parity_file) {
+        fclose(parity_file);
+    }
 
-    shard_send_report_t *req = malloc(sizeof(shard_send_report_t));
+    if (data_buffer) {
+        memset_zero(data_buffer, data_shards * stripe_size);
+        free(data_buffer);
+    }
 
-    req->http_options = state->env->http_options;
-    req->options = state->env->bridge_options;
-    req->status_code = 0;
-    req->report = shard->report;
-    req->report->send_status = STORJ_REPORT_SENDING;
-    req->state = state;
-    req->pointer_index = index;
+    if (parity_buffer) {
+        free(parity_buffer);
+    }
 
+    if (hashers) {
+        free(hashers);
+    }
+
+    if (encryption_ctx) {
+        for (int i = 0; i < data_shards; i++) {
+            if (encryption_ctx[i]) {
+                free_encryption_ctx(encryption_ctx[i]);
+            }
+        }
+        free(encryption_ctx);
+    }
+}
+
+static void queue_stream_encode(storj_upload_state_t *state)
+{
+    uv_work_t *work = uv_work_new();
+    if (!work) {
+        state->error_status = STORJ_MEMORY_ERROR;
+        return;
+    }
+
+    stream_encode_req_t *req = malloc(sizeof(stream_encode_req_t));
+    if (!req) {
+        state->error_status = STORJ_MEMORY_ERROR;
+        return;
+    }
+
+    req->shard_meta = calloc(state->total_shards, sizeof(shard_meta_t *));
+    if (!req->shard_meta) {
+        state->error_status = STORJ_MEMORY_ERROR;
+        return;
+    }
+
+    req->error_status = 0;
+    req->upload_state = state;
     work->data = req;
 
     state->pending_work_count += 1;
+
     int status = uv_queue_work(state->env->loop, (uv_work_t*) work,
-                               send_exchange_report, after_send_exchange_report);
+                               stream_encode, after_stream_encode);
+
     if (status) {
         state->error_status = STORJ_QUEUE_ERROR;
     }
+
+    state->awaiting_parity_shards = false;
 }
 
 static void verify_bucket_id_callback(uv_work_t *work_req, int status)
@@ -2276,36 +2806,46 @@ static void queue_verify_file_name(storj_upload_state_t *state)
     }
 }
 
-// Check if a frame/shard is already being prepared/pushed.
-// We want to limit disk reads for dd and network activity
-static int check_in_progress(storj_upload_state_t *state, int status)
+// Take the lowest shard index from a ready queue that is still waiting
+// for the given progress, entries may be stale if the shard has moved on.
+static int take_ready_shard(storj_upload_state_t *state,
+                            storj_index_queue_t *queue,
+                            int progress)
 {
-    int active = 0;
+    uint32_t index;
 
-    for (int index = 0; index < state->total_shards; index++ ) {
-        if (state->shard[index].progress == status) {
-            active += 1;
+    while (index_queue_pop(queue, &index)) {
+        if (state->shard[index].progress != progress) {
+            continue;
         }
+        return index;
     }
 
-    return active;
+    return -1;
 }
 
+// The number of frames/shards being prepared/pushed is limited to reduce
+// disk reads for dd and network activity
 static void queue_push_frame_and_shard(storj_upload_state_t *state)
 {
-    for (int index = 0; index < state->total_shards; index++) {
+    int index;
 
-        if (state->shard[index].progress == AWAITING_PUSH_FRAME &&
-            state->shard[index].report->send_status == STORJ_REPORT_NOT_PREPARED &&
-            check_in_progress(state, PUSHING_FRAME) < state->push_frame_limit) {
-            queue_push_frame(state, index);
+    while (state->pushing_frames < state->push_frame_limit && !state->error_status) {
+        index = take_ready_shard(state, &state->ready_push_frame,
+                                 AWAITING_PUSH_FRAME);
+        if (index < 0) {
+            break;
         }
+        queue_push_frame(state, index);
+    }
 
-        if (state->shard[index].progress == AWAITING_PUSH_SHARD &&
-            state->shard[index].report->send_status == STORJ_REPORT_NOT_PREPARED &&
-            check_in_progress(state, PUSHING_SHARD) < state->push_shard_limit) {
-            queue_push_shard(state, index);
+    while (state->pushing_shards < state->push_concurrency.limit && !state->error_status) {
+        index = take_ready_shard(state, &state->ready_push_shard,
+                                 AWAITING_PUSH_SHARD);
+        if (index < 0) {
+            break;
         }
+        queue_push_shard(state, index);
     }
 }
 
@@ -2347,7 +2887,17 @@ static void queue_next_work(storj_upload_state_t *state)
         goto finish_up;
     }
 
-    if (state->rs) {
+    if (state->rs && state->stream) {
+        // Encrypt, hash and create parity shards in one pass
+        if (state->awaiting_parity_shards) {
+            queue_stream_encode(state);
+            goto finish_up;
+        }
+
+        if (!state->parity_file) {
+            goto finish_up;
+        }
+    } else if (state->rs) {
         if (!state->encrypted_file) {
             queue_create_encrypted_file(state);
             goto finish_up;
@@ -2360,11 +2910,14 @@ static void queue_next_work(storj_upload_state_t *state)
         }
     }
 
-    for (int index = 0; index < state->total_shards; index++ ) {
-        if (state->shard[index].progress == AWAITING_PREPARE_FRAME &&
-            check_in_progress(state, PREPARING_FRAME) < state->prepare_frame_limit) {
-            queue_prepare_frame(state, index);
+    while (state->preparing_frames < state->prepare_frame_limit &&
+           !state->error_status) {
+        int index = take_ready_shard(state, &state->ready_prepare_frame,
+                                     AWAITING_PREPARE_FRAME);
+        if (index < 0) {
+            break;
         }
+        queue_prepare_frame(state, index);
     }
 
     // report upload complete
@@ -2374,12 +2927,6 @@ static void queue_next_work(storj_upload_state_t *state)
         queue_create_bucket_entry(state);
     }
 
-    for (int index = 0; index < state->total_shards; index++ ) {
-        if (state->shard[index].report->send_status == STORJ_REPORT_AWAITING_SEND) {
-            queue_send_exchange_report(state, index);
-        }
-    }
-
     // NB: This needs to be the last thing, there is a bug with mingw
     // builds and uv_async_init, where leaving a block will cause the state
     // pointer to change values.
@@ -2401,6 +2948,13 @@ static void begin_work_queue(uv_work_t *work, int status)
     state->progress_cb(0, 0, 0, state->handle);
 
     state->pending_work_count -= 1;
+
+    if (!state->error_status && state->shard) {
+        for (int index = 0; index < state->total_shards; index++) {
+            queue_ready_shard(state, index);
+        }
+    }
+
     queue_next_work(state);
 
     free(work);
@@ -2474,16 +3028,33 @@ static void prepare_upload_state(uv_work_t *work)
         state->shard[i].work = NULL;
     }
 
-    if (encrypt_file_name(state->env->encrypt_options->mnemonic,
-                          state->bucket_id,
-                          state->file_name,
-                          (char **)&state->encrypted_file_name)) {
+    if (encrypt_file_name_cached(state->env->encrypt_options->key_cache,
+                                 state->bucket_id,
+                                 state->file_name,
+                                 (char **)&state->encrypted_file_name)) {
         state->error_status = STORJ_MEMORY_ERROR;
         return;
     }
 
     uint8_t *index = NULL;
     char *key_as_str = NULL;
+    const char *journal_index = NULL;
+
+    if (state->journal_path) {
+        int journal_status = open_upload_journal(state, st.st_mtime);
+        if (!journal_status) {
+            journal_status = restore_upload_journal(state);
+        }
+        if (journal_status) {
+            state->error_status = journal_status;
+            return;
+        }
+
+        journal_index = journal_find(state->journal, "index", 0);
+        if (journal_index && strlen(journal_index) != SHA256_DIGEST_SIZE * 2) {
+            journal_index = NULL;
+        }
+    }
 
     if (state->index) {
         index = str2hex(strlen(state->index), (char *)state->index);
@@ -2491,6 +3062,13 @@ static void prepare_upload_state(uv_work_t *work)
             state->error_status = STORJ_MEMORY_ERROR;
             goto cleanup;
         }
+    } else if (journal_index) {
+        // the encryption of the earlier upload is repeated with its index
+        index = str2hex(strlen(journal_index), (char *)journal_index);
+        if (!index) {
+            state->error_status = STORJ_MEMORY_ERROR;
+            goto cleanup;
+        }
     } else {
         // Get random index used for encryption
         index = calloc(SHA256_DIGEST_SIZE + 1, sizeof(uint8_t));
@@ -2509,6 +3087,15 @@ static void prepare_upload_state(uv_work_t *work)
 
     state->index = index_as_str;
 
+    if (state->journal && !journal_index) {
+        int journal_status = journal_append(state->journal, "index", 0,
+                                            state->index);
+        if (journal_status) {
+            state->error_status = journal_status;
+            goto cleanup;
+        }
+    }
+
     // Caculate the file encryption key based on the index
     key_as_str = calloc(DETERMINISTIC_KEY_SIZE + 1, sizeof(char));
     if (!key_as_str) {
@@ -2516,10 +3103,10 @@ static void prepare_upload_state(uv_work_t *work)
         goto cleanup;
     }
 
-    int key_status = generate_file_key(state->env->encrypt_options->mnemonic,
-                                       state->bucket_id,
-                                       index_as_str,
-                                       &key_as_str);
+    int key_status = generate_file_key_cached(state->env->encrypt_options->key_cache,
+                                              state->bucket_id,
+                                              index_as_str,
+                                              &key_as_str);
     if (key_status) {
         switch (key_status) {
             case 2:
@@ -2548,7 +3135,9 @@ static void prepare_upload_state(uv_work_t *work)
 
     if (state->rs) {
         state->parity_file_path = create_tmp_name(state, ".parity");
-        state->encrypted_file_path = create_tmp_name(state, ".crypt");
+        if (!state->stream) {
+            state->encrypted_file_path = create_tmp_name(state, ".crypt");
+        }
     }
 
 
@@ -2612,16 +3201,8 @@ STORJ_API int storj_bridge_store_file_cancel(storj_upload_state_t *state)
 
     state->error_status = STORJ_TRANSFER_CANCELED;
 
-    // loop over all shards, and cancel any that are queued to be uploaded
     // any uploads that are in-progress will monitor the state->canceled
     // status and exit when set to true
-    for (int i = 0; i < state->total_shards; i++) {
-        shard_tracker_t *shard = &state->shard[i];
-        if (shard->progress == PUSHING_SHARD) {
-            uv_cancel((uv_req_t *)shard->work);
-        }
-    }
-
     return 0;
 }
 
@@ -2661,13 +3242,15 @@ STORJ_API storj_upload_state_t *storj_bridge_store_file(storj_env_t *env,
     state->shard_size = 0;
     state->total_bytes = 0;
     state->uploaded_bytes = 0;
-    state->exclude = NULL;
     state->frame_id = NULL;
     state->hmac_id = NULL;
     state->encryption_key = NULL;
     state->encryption_ctr = NULL;
+    state->journal_path = opts->journal_path;
+    state->journal = NULL;
 
     state->rs = (opts->rs == false) ? false : true;
+    state->stream = opts->stream;
     state->awaiting_parity_shards = true;
     state->parity_file_path = NULL;
     state->parity_file = NULL;
@@ -2688,9 +3271,32 @@ STORJ_API storj_upload_state_t *storj_bridge_store_file(storj_env_t *env,
 
     state->progress_finished = false;
 
+    state->preparing_frames = 0;
+    state->pushing_frames = 0;
+    state->pushing_shards = 0;
+    state->ready_prepare_frame = (storj_index_queue_t){NULL, 0, 0};
+    state->ready_push_frame = (storj_index_queue_t){NULL, 0, 0};
+    state->ready_push_shard = (storj_index_queue_t){NULL, 0, 0};
+
     state->push_shard_limit = (opts->push_shard_limit > 0) ? (opts->push_shard_limit) : PUSH_SHARD_LIMIT;
+
+    // the default floor and ceiling include the starting limit
+    int push_shard_min = (opts->push_shard_min > 0) ? (opts->push_shard_min) : PUSH_SHARD_MIN;
+    int push_shard_max = (opts->push_shard_max > 0) ? (opts->push_shard_max) : PUSH_SHARD_MAX;
+    if (opts->push_shard_min <= 0 && push_shard_min > state->push_shard_limit) {
+        push_shard_min = state->push_shard_limit;
+    }
+    if (opts->push_shard_max <= 0 && push_shard_max < state->push_shard_limit) {
+        push_shard_max = state->push_shard_limit;
+    }
+    concurrency_init(&state->push_concurrency, state->push_shard_limit,
+                     push_shard_min, push_shard_max);
+
+    state->bandwidth_weight = (opts->bandwidth_weight > 0) ? (opts->bandwidth_weight) : 1;
+
     state->push_frame_limit = (opts->push_frame_limit > 0) ? (opts->push_frame_limit) : PUSH_FRAME_LIMIT;
     state->prepare_frame_limit = (opts->prepare_frame_limit > 0) ? (opts->prepare_frame_limit) : PREPARE_FRAME_LIMIT;
+    state->encode_threads = (opts->encode_threads > 0) ? (opts->encode_threads) : default_thread_count();
 
     state->frame_request_count = 0;
     state->add_bucket_entry_count = 0;
@@ -2706,6 +3312,13 @@ STORJ_API storj_upload_state_t *storj_bridge_store_file(storj_env_t *env,
     state->shard = NULL;
     state->pending_work_count = 0;
 
+    state->log->info(env->log_options, handle,
+                     "Pushing %" PRIu32 " shards at once, adapting between "
+                     "%" PRIu32 " and %" PRIu32,
+                     state->push_concurrency.limit,
+                     state->push_concurrency.min,
+                     state->push_concurrency.max);
+
     uv_work_t *work = uv_work_new();
     work->data = state;
 
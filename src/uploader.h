@@ -11,10 +11,14 @@
 #include "utils.h"
 #include "crypto.h"
 #include "rs.h"
+#include "journal.h"
+#include "farmers.h"
+#include "reports.h"
 
 #define STORJ_NULL -1
-#define STORJ_MAX_REPORT_TRIES 2
 #define STORJ_MAX_PUSH_FRAME_COUNT 6
+#define STORJ_MIN_ENCODE_RANGE 1048576 // 1Mb
+#define STORJ_STREAM_BUFFER_SIZE 67108864 // 64Mb
 
 typedef enum {
     CANCELED = 0,
@@ -30,7 +34,9 @@ typedef enum {
 typedef enum {
     PREPARE_FRAME_LIMIT = 1,
     PUSH_FRAME_LIMIT = 32,
-    PUSH_SHARD_LIMIT = 32
+    PUSH_SHARD_LIMIT = 32,
+    PUSH_SHARD_MIN = 4,
+    PUSH_SHARD_MAX = 128
 } storj_state_progress_limits_t;
 
 typedef struct {
@@ -52,6 +58,32 @@ typedef struct {
     storj_upload_state_t *upload_state;
 } parity_shard_req_t;
 
+typedef struct {
+    int error_status;
+    /* state should not be modified in worker threads */
+    storj_upload_state_t *upload_state;
+    // Shard meta for every data and parity shard, in shard order
+    shard_meta_t **shard_meta;
+} stream_encode_req_t;
+
+#define SHARD_HASHER_LANES (STORJ_SHARD_CHALLENGES + 1)
+
+typedef struct {
+    // The sha256 of the shard followed by the first sha256 of each
+    // challenge leaf, updated together with the same data
+    struct sha256_ctx lanes[SHARD_HASHER_LANES];
+} shard_hasher_t;
+
+typedef struct {
+    reed_solomon *rs;
+    uint8_t **data_blocks;
+    uint8_t **fec_blocks;
+    uint64_t block_size;
+    uint64_t total_bytes;
+    uint64_t offset;
+    uint64_t length;
+} parity_range_job_t;
+
 typedef struct {
     int error_status;
     /* state should not be modified in worker threads */
@@ -70,6 +102,7 @@ typedef struct {
     uv_async_t progress_handle;
     uint64_t start;
     uint64_t end;
+    storj_encryption_ctx_t *encryption_ctx;
 
     /* state should not be modified in worker threads */
     storj_upload_state_t *upload_state;
@@ -101,6 +134,7 @@ typedef struct {
     // Add shard to frame
     int shard_meta_index;
     farmer_pointer_t *farmer_pointer;
+    char *exclude;
 
     storj_log_levels_t *log;
 } frame_request_t;
@@ -116,16 +150,6 @@ typedef struct {
   storj_log_levels_t *log;
 } post_to_bucket_request_t;
 
-typedef struct {
-    uint32_t pointer_index;
-    storj_http_options_t *http_options;
-    storj_bridge_options_t *options;
-    int status_code;
-    storj_exchange_report_t *report;
-    /* state should not be modified in worker threads */
-    storj_upload_state_t *state;
-} shard_send_report_t;
-
 static farmer_pointer_t *farmer_pointer_new();
 static shard_meta_t *shard_meta_new();
 static uv_work_t *shard_meta_work_new(int index, storj_upload_state_t *state);
@@ -137,7 +161,6 @@ static int prepare_encryption_key(storj_upload_state_t *state,
                                char *pre_salt,
                                int pre_salt_size);
 
-static int check_in_progress(storj_upload_state_t *state, int status);
 char *create_tmp_name(storj_upload_state_t *state, char *extension);
 
 static void shard_meta_cleanup(shard_meta_t *shard_meta);
@@ -152,17 +175,17 @@ static void queue_prepare_frame(storj_upload_state_t *state, int index);
 static void queue_push_frame(storj_upload_state_t *state, int index);
 static void queue_push_shard(storj_upload_state_t *state, int index);
 static void queue_create_bucket_entry(storj_upload_state_t *state);
-static void queue_send_exchange_report(storj_upload_state_t *state, int index);
 static void queue_create_encrypted_file(storj_upload_state_t *state);
+static void queue_stream_encode(storj_upload_state_t *state);
 
 static void request_token(uv_work_t *work);
 static void request_frame_id(uv_work_t *work);
 static void prepare_frame(uv_work_t *work);
 static void push_frame(uv_work_t *work);
-static void push_shard(uv_work_t *work);
+static int push_shard(uv_work_t *work);
 static void create_bucket_entry(uv_work_t *work);
-static void send_exchange_report(uv_work_t *work);
 static void create_encrypted_file(uv_work_t *work);
+static void stream_encode(uv_work_t *work);
 
 static void after_request_token(uv_work_t *work, int status);
 static void after_request_frame_id(uv_work_t *work, int status);
@@ -170,8 +193,8 @@ static void after_prepare_frame(uv_work_t *work, int status);
 static void after_push_frame(uv_work_t *work, int status);
 static void after_push_shard(uv_work_t *work, int status);
 static void after_create_bucket_entry(uv_work_t *work, int status);
-static void after_send_exchange_report(uv_work_t *work, int status);
 static void after_create_encrypted_file(uv_work_t *work, int status);
+static void after_stream_encode(uv_work_t *work, int status);
 
 static void queue_verify_bucket_id(storj_upload_state_t *state);
 static void queue_verify_file_id(storj_upload_state_t *state);
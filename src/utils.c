@@ -153,6 +153,20 @@ uint64_t shard_size(int hops)
     return MIN_SHARD_SIZE * pow(2, hops);
 };
 
+int default_thread_count()
+{
+    uv_cpu_info_t *cpu_infos = NULL;
+    int count = 0;
+
+    if (uv_cpu_info(&cpu_infos, &count) || count < 1) {
+        return 1;
+    }
+
+    uv_free_cpu_info(cpu_infos, count);
+
+    return count;
+}
+
 uint64_t get_time_milliseconds() {
 #ifdef _WIN32
 
@@ -382,3 +396,206 @@ win_finished:
 #endif
     return status;
 }
+
+int index_queue_push(storj_index_queue_t *queue, uint32_t index)
+{
+    if (queue->length == queue->size) {
+        uint32_t size = queue->size ? queue->size * 2 : 16;
+        uint32_t *items = realloc(queue->items, size * sizeof(uint32_t));
+        if (!items) {
+            return 1;
+        }
+        queue->items = items;
+        queue->size = size;
+    }
+
+    // the queue is a binary heap, move the index up to its place
+    uint32_t i = queue->length;
+    queue->length += 1;
+
+    while (i > 0) {
+        uint32_t parent = (i - 1) / 2;
+        if (queue->items[parent] <= index) {
+            break;
+        }
+        queue->items[i] = queue->items[parent];
+        i = parent;
+    }
+
+    queue->items[i] = index;
+
+    return 0;
+}
+
+bool index_queue_peek(storj_index_queue_t *queue, uint32_t *index)
+{
+    if (queue->length == 0) {
+        return false;
+    }
+
+    *index = queue->items[0];
+
+    return true;
+}
+
+bool index_queue_pop(storj_index_queue_t *queue, uint32_t *index)
+{
+    if (queue->length == 0) {
+        return false;
+    }
+
+    *index = queue->items[0];
+
+    queue->length -= 1;
+    uint32_t last = queue->items[queue->length];
+
+    // move the last index down from the top to its place
+    uint32_t i = 0;
+    while (true) {
+        uint32_t child = 2 * i + 1;
+        if (child >= queue->length) {
+            break;
+        }
+        if (child + 1 < queue->length &&
+            queue->items[child + 1] < queue->items[child]) {
+            child += 1;
+        }
+        if (last <= queue->items[child]) {
+            break;
+        }
+        queue->items[i] = queue->items[child];
+        i = child;
+    }
+
+    queue->items[i] = last;
+
+    return true;
+}
+
+void index_queue_free(storj_index_queue_t *queue)
+{
+    free(queue->items);
+    queue->items = NULL;
+    queue->length = 0;
+    queue->size = 0;
+}
+
+void concurrency_init(storj_concurrency_t *concurrency, uint32_t limit,
+                      uint32_t min, uint32_t max)
+{
+    concurrency->max = (max > 0) ? max : 1;
+    concurrency->min = (min > 0) ? min : 1;
+    if (concurrency->min > concurrency->max) {
+        concurrency->min = concurrency->max;
+    }
+    concurrency->limit = limit;
+    if (concurrency->limit < concurrency->min) {
+        concurrency->limit = concurrency->min;
+    }
+    if (concurrency->limit > concurrency->max) {
+        concurrency->limit = concurrency->max;
+    }
+    concurrency->slow_start = true;
+    concurrency->decreased = false;
+    concurrency->step = 1;
+    concurrency->window_shards = 0;
+    concurrency->window_bytes = 0;
+    concurrency->window_start = 0;
+    concurrency->window_end = 0;
+    concurrency->last_rate = 0;
+}
+
+static bool set_concurrency_limit(storj_concurrency_t *concurrency,
+                                  uint64_t limit)
+{
+    if (limit < concurrency->min) {
+        limit = concurrency->min;
+    }
+    if (limit > concurrency->max) {
+        limit = concurrency->max;
+    }
+
+    if (limit == concurrency->limit) {
+        return false;
+    }
+
+    concurrency->limit = limit;
+
+    return true;
+}
+
+bool concurrency_add_transfer(storj_concurrency_t *concurrency,
+                              uint64_t bytes, uint64_t start, uint64_t end)
+{
+    if (end < start) {
+        return false;
+    }
+
+    if (concurrency->window_shards == 0 || start < concurrency->window_start) {
+        concurrency->window_start = start;
+    }
+    if (end > concurrency->window_end) {
+        concurrency->window_end = end;
+    }
+    concurrency->window_bytes += bytes;
+    concurrency->window_shards += 1;
+
+    // a window is about one round of transfers at the current limit
+    uint32_t window = concurrency->limit;
+    if (window < STORJ_CONCURRENCY_MIN_WINDOW) {
+        window = STORJ_CONCURRENCY_MIN_WINDOW;
+    }
+    if (concurrency->window_shards < window) {
+        return false;
+    }
+
+    uint64_t time = concurrency->window_end - concurrency->window_start;
+    uint64_t rate = concurrency->window_bytes * 1000 / ((time > 0) ? time : 1);
+    uint64_t last_rate = concurrency->last_rate;
+
+    bool grew = (last_rate == 0 ||
+        rate * 100 > last_rate * (100 + STORJ_CONCURRENCY_RATE_CHANGE));
+    bool dropped = (last_rate > 0 &&
+        rate * 100 < last_rate * (100 - STORJ_CONCURRENCY_RATE_CHANGE));
+
+    concurrency->last_rate = rate;
+    concurrency->window_shards = 0;
+    concurrency->window_bytes = 0;
+    concurrency->window_end = 0;
+    concurrency->decreased = false;
+
+    uint64_t limit = concurrency->limit;
+
+    if (concurrency->slow_start && grew) {
+        limit *= 2;
+    } else if (concurrency->slow_start) {
+        // the last doubling didn't increase the throughput
+        concurrency->slow_start = false;
+        concurrency->step = -1;
+        limit -= limit / 4;
+    } else {
+        if (dropped) {
+            concurrency->step = -concurrency->step;
+        } else if (!grew) {
+            // the same throughput with fewer transfers
+            concurrency->step = -1;
+        }
+        limit = (concurrency->step > 0) ? limit + 1 : limit - 1;
+    }
+
+    return set_concurrency_limit(concurrency, limit);
+}
+
+bool concurrency_add_failure(storj_concurrency_t *concurrency)
+{
+    concurrency->slow_start = false;
+    concurrency->step = -1;
+
+    // transfers failing at the same time are a single decrease
+    if (concurrency->decreased) {
+        return false;
+    }
+    concurrency->decreased = true;
+
+    return set_concurrency_limit(concurrency, concurrency->limit / 2);
+}
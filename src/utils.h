@@ -34,9 +34,13 @@ ssize_t pwrite(int fd, const void *buf, size_t count, uint64_t offset);
 #include <sys/mman.h>
 #endif
 
+#include "storj.h"
+
 #define MAX_SHARD_SIZE 4294967296 // 4Gb
 #define MIN_SHARD_SIZE 2097152 // 2Mb
 #define SHARD_MULTIPLES_BACK 4
+#define STORJ_CONCURRENCY_MIN_WINDOW 4
+#define STORJ_CONCURRENCY_RATE_CHANGE 5 // percent
 
 int allocatefile(int fd, uint64_t length);
 
@@ -66,6 +70,13 @@ uint64_t shard_size(int hops);
 
 uint64_t get_time_milliseconds();
 
+/**
+ * @brief The number of threads to use for CPU bound work
+ *
+ * @return The number of CPUs, or 1 if it can't be determined
+ */
+int default_thread_count();
+
 void memset_zero(void *v, size_t n);
 
 uint64_t determine_shard_size(uint64_t file_size, int accumulator);
@@ -74,4 +85,69 @@ int unmap_file(uint8_t *map, uint64_t filesize);
 
 int map_file(int fd, uint64_t filesize, uint8_t **map, bool read_only);
 
+/**
+ * @brief Add an index to a queue
+ *
+ * @param[in] queue The index queue
+ * @param[in] index The index to add
+ * @return A non-zero error value on failure and 0 on success.
+ */
+int index_queue_push(storj_index_queue_t *queue, uint32_t index);
+
+/**
+ * @brief Get the lowest index of a queue without removing it
+ *
+ * @param[in] queue The index queue
+ * @param[out] index The lowest index
+ * @return False if the queue is empty
+ */
+bool index_queue_peek(storj_index_queue_t *queue, uint32_t *index);
+
+/**
+ * @brief Remove the lowest index of a queue
+ *
+ * @param[in] queue The index queue
+ * @param[out] index The lowest index
+ * @return False if the queue is empty
+ */
+bool index_queue_pop(storj_index_queue_t *queue, uint32_t *index);
+
+/**
+ * @brief Free the memory of a queue
+ *
+ * @param[in] queue The index queue
+ */
+void index_queue_free(storj_index_queue_t *queue);
+
+/**
+ * @brief Initialize an adaptive concurrency limit
+ *
+ * @param[in] concurrency The concurrency limit
+ * @param[in] limit The limit to start with
+ * @param[in] min The lowest limit
+ * @param[in] max The highest limit
+ */
+void concurrency_init(storj_concurrency_t *concurrency, uint32_t limit,
+                      uint32_t min, uint32_t max);
+
+/**
+ * @brief Add a finished transfer to the current window
+ *
+ * @param[in] concurrency The concurrency limit
+ * @param[in] bytes The bytes transferred
+ * @param[in] start The start time of the transfer in milliseconds
+ * @param[in] end The end time of the transfer in milliseconds
+ * @return True if the limit was changed
+ */
+bool concurrency_add_transfer(storj_concurrency_t *concurrency,
+                              uint64_t bytes, uint64_t start, uint64_t end);
+
+/**
+ * @brief Decrease the limit after a failed transfer
+ *
+ * @param[in] concurrency The concurrency limit
+ * @return True if the limit was changed
+ */
+bool concurrency_add_failure(storj_concurrency_t *concurrency);
+
 #endif /* STORJ_UTILS_H */
@@ -70,6 +70,7 @@ int mock_bridge_server(void *cls,
 
     char *page = "Not Found";
     int status_code = MHD_HTTP_NOT_FOUND;
+    json_object *listing = NULL;
 
     int ret;
 
@@ -97,7 +98,34 @@ int mock_bridge_server(void *cls,
             }
         }  else if (0 == strcmp(url, "/buckets/368be0816766b28fd5f43af5/files")) {
             if (check_auth(user, pass, &status_code, page)) {
-                page = get_response_string(responses, "listfiles");
+                const char* limit = MHD_lookup_connection_value(connection,
+                                                                MHD_GET_ARGUMENT_KIND,
+                                                                "limit");
+                const char* start_date = MHD_lookup_connection_value(connection,
+                                                                     MHD_GET_ARGUMENT_KIND,
+                                                                     "startDate");
+                if (limit) {
+                    // files created after the start date, up to the limit
+                    json_object *files;
+                    json_object_object_get_ex(responses, "listfiles", &files);
+                    listing = json_object_new_array();
+                    for (int i = 0; i < json_object_array_length(files); i++) {
+                        json_object *file = json_object_array_get_idx(files, i);
+                        json_object *created;
+                        json_object_object_get_ex(file, "created", &created);
+                        if (json_object_array_length(listing) >= atoi(limit)) {
+                            break;
+                        }
+                        if (start_date && strcmp(json_object_get_string(created),
+                                                 start_date) <= 0) {
+                            continue;
+                        }
+                        json_object_array_add(listing, json_object_get(file));
+                    }
+                    page = (char *)json_object_to_json_string(listing);
+                } else {
+                    page = get_response_string(responses, "listfiles");
+                }
                 status_code = MHD_HTTP_OK;
             }
         } else if (0 == strcmp(url, "/buckets/368be0816766b28fd5f43af5/files/998960317b6725a3f8080c2b/info")) {
@@ -121,13 +149,21 @@ int mock_bridge_server(void *cls,
                                                            MHD_GET_ARGUMENT_KIND,
                                                            "skip");
             if (!skip || 0 == strcmp(skip, "0")) {
-                page = get_response_string(responses, "getfilepointers-0");
+                if (mock_shards == MOCK_SHARDS_DEFAULT) {
+                    page = get_response_string(responses, "getfilepointers-0");
+                } else {
+                    page = get_response_string(responses, "getfilepointers-0-all");
+                }
                 status_code = MHD_HTTP_OK;
             } else if (0 == strcmp(skip, "3")) {
                 page = get_response_string(responses, "getfilepointers-1");
                 status_code = MHD_HTTP_OK;
             } else if (0 == strcmp(skip, "6")) {
-                page = get_response_string(responses, "getfilepointers-2");
+                if (mock_shards == MOCK_SHARDS_DEFAULT) {
+                    page = get_response_string(responses, "getfilepointers-2");
+                } else {
+                    page = get_response_string(responses, "getfilepointers-2-all");
+                }
                 status_code = MHD_HTTP_OK;
             } else if (0 == strcmp(skip, "9")) {
                 page = get_response_string(responses, "getfilepointers-3");
@@ -142,6 +178,16 @@ int mock_bridge_server(void *cls,
                 // TODO check exclude and limit query
                 page = get_response_string(responses, "getfilepointers-r");
                 status_code = MHD_HTTP_OK;
+            } else if (0 == strcmp(skip, "5") &&
+                       mock_shards == MOCK_SHARDS_FAILED_FARMER) {
+                // no other farmer has the failed shard
+                page = get_response_string(responses, "getfilepointers-failed");
+                status_code = MHD_HTTP_OK;
+            } else if (0 == strcmp(skip, "5") &&
+                       mock_shards != MOCK_SHARDS_DEFAULT) {
+                // the pointer of another farmer for the slow shard
+                page = get_response_string(responses, "getfilepointers-hedge");
+                status_code = MHD_HTTP_OK;
             } else if (0 == strcmp(skip, "14")) {
                 // parity-shard
                 page = get_response_string(responses, "getfilepointers-missing");
@@ -265,6 +311,9 @@ int mock_bridge_server(void *cls,
     free(user);
     json_object_put(responses);
     json_object_put(responses_info);
+    if (listing) {
+        json_object_put(listing);
+    }
 
     return ret;
 }
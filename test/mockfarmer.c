@@ -1,6 +1,7 @@
 #include <nettle/aes.h>
 #include <nettle/ctr.h>
 #include <nettle/ctr.h>
+#include <pthread.h>
 
 #include "storjtests.h"
 #include "../src/rs.h"
@@ -8,11 +9,135 @@
 static int e_count = 0;
 static int i_count = 0;
 static char* data = NULL;
+static pthread_mutex_t data_lock = PTHREAD_MUTEX_INITIALIZER;
+
+mock_shards_t mock_shards = MOCK_SHARDS_DEFAULT;
+int mock_hedge_requests = 0;
+int mock_parity_requests = 0;
+int mock_early_parity_requests = 0;
+
+#define SLOW_SHARD_URL "/shards/0219bb523832c09c77069c74804e5b0476cea7cf"
+#define FAILED_SHARD_URL SLOW_SHARD_URL
+#define SLOW_SHARD_HEDGE_TOKEN "6e1f0c2b9d8a7e3f4c5b6a7d8e9f0a1b2c3d4e5f"
+#define SLOW_SHARD_CHUNK 65536
+#define SLOW_SHARD_DELAY 50000 // 50 ms per chunk
+#define SLOW_SHARD_STALL 6291456 // slow bytes before the rest is sent
+#define SLOW_SHARD_WAIT 10000000 // 10 seconds
+
+// the parity shards are held back until a copy of the slow shard was sent
+static volatile bool slow_shard_sent = false;
+
+// parity requests are counted as early until the failed shard was answered
+static volatile bool failed_shard_sent = false;
+
+typedef struct {
+    char *page;
+    uint64_t size;
+    uint64_t slow_bytes;
+} slow_response_t;
+
+void set_mock_shards(mock_shards_t shards)
+{
+    mock_shards = shards;
+    mock_hedge_requests = 0;
+    mock_parity_requests = 0;
+    mock_early_parity_requests = 0;
+    slow_shard_sent = false;
+    failed_shard_sent = false;
+}
+
+static bool is_parity_shard(const char *url)
+{
+    return 0 == strcmp(url, "/shards/424cdf090604317570da38ef7d5b41abea0952df") ||
+        0 == strcmp(url, "/shards/a292c0de26b2a9086473905abb938c7a1c45a9e9") ||
+        0 == strcmp(url, "/shards/aca155b4deeac64f2be748e3c434e1f5e9719ef3");
+}
+
+static void wait_for_slow_shard()
+{
+    for (int waited = 0; !slow_shard_sent && waited < SLOW_SHARD_WAIT;
+         waited += 10000) {
+        usleep(10000);
+    }
+}
+
+static ssize_t read_slow_response(void *cls, uint64_t pos, char *buf,
+                                  size_t max)
+{
+    slow_response_t *response = cls;
+
+    if (pos >= response->size) {
+        return MHD_CONTENT_READER_END_OF_STREAM;
+    }
+
+    size_t length = response->size - pos;
+    if (pos < response->slow_bytes) {
+        usleep(SLOW_SHARD_DELAY);
+        if (length > SLOW_SHARD_CHUNK) {
+            length = SLOW_SHARD_CHUNK;
+        }
+    }
+    if (length > max) {
+        length = max;
+    }
+
+    memcpy(buf, response->page + pos, length);
+
+    if (pos + length == response->size) {
+        slow_shard_sent = true;
+    }
+
+    return length;
+}
+
+static void free_slow_response(void *cls)
+{
+    slow_response_t *response = cls;
+    free(response->page);
+    free(response);
+}
+
+// Send the slow shard, or its hedged copy, a chunk at a time
+static int queue_slow_shard(struct MHD_Connection *connection, char *page,
+                            int shard_bytes)
+{
+    const char *token = MHD_lookup_connection_value(connection,
+                                                    MHD_GET_ARGUMENT_KIND,
+                                                    "token");
+    bool hedge = token && 0 == strcmp(token, SLOW_SHARD_HEDGE_TOKEN);
+
+    slow_response_t *slow = malloc(sizeof(slow_response_t));
+    slow->page = page;
+    slow->size = shard_bytes;
+
+    if (hedge) {
+        mock_hedge_requests += 1;
+        slow->slow_bytes = (mock_shards == MOCK_SHARDS_SLOW_HEDGE) ?
+            shard_bytes : 0;
+    } else {
+        slow->slow_bytes = (mock_shards == MOCK_SHARDS_SLOW_FARMER) ?
+            shard_bytes : SLOW_SHARD_STALL;
+    }
+
+    struct MHD_Response *response =
+        MHD_create_response_from_callback(shard_bytes, SLOW_SHARD_CHUNK * 16,
+                                          &read_slow_response, slow,
+                                          &free_slow_response);
+
+    int ret = MHD_queue_response(connection, MHD_HTTP_OK, response);
+    MHD_destroy_response(response);
+
+    return ret;
+}
 
 static void setup_test_farmer_data(int shard_bytes, int shard_bytes_sent)
 {
+    // requests are answered on their own threads, only the first sets up
+    pthread_mutex_lock(&data_lock);
+
     // check if data already setu
     if (data) {
+        pthread_mutex_unlock(&data_lock);
         return;
     }
 
@@ -74,6 +199,8 @@ static void setup_test_farmer_data(int shard_bytes, int shard_bytes_sent)
     free(data_blocks);
     free(fec_blocks);
     free(ctx);
+
+    pthread_mutex_unlock(&data_lock);
 }
 
 static void farmer_request_completed(void *cls,
@@ -306,6 +433,30 @@ int mock_farmer_shard_server(void *cls,
             printf("url: %s\n", url);
         }
 
+        if (page && mock_shards == MOCK_SHARDS_FAILED_FARMER) {
+            if (0 == strcmp(url, FAILED_SHARD_URL)) {
+                // mock a farmer that is unable to send the shard
+                free(page);
+                page = NULL;
+                status_code = MHD_HTTP_INTERNAL_SERVER_ERROR;
+                failed_shard_sent = true;
+            } else if (is_parity_shard(url)) {
+                mock_parity_requests += 1;
+                if (!failed_shard_sent) {
+                    mock_early_parity_requests += 1;
+                }
+            }
+        } else if (page && mock_shards != MOCK_SHARDS_DEFAULT) {
+            if (0 == strcmp(url, SLOW_SHARD_URL)) {
+                return queue_slow_shard(connection, page, shard_bytes);
+            }
+
+            // the slow shard isn't recovered before either copy was sent
+            if (is_parity_shard(url)) {
+                wait_for_slow_shard();
+            }
+        }
+
         char *sent_page = NULL;
 
         if (page) {
@@ -340,7 +491,8 @@ int mock_farmer_shard_server(void *cls,
 
 struct MHD_Daemon *start_farmer_server()
 {
-    return MHD_start_daemon(MHD_USE_SELECT_INTERNALLY,
+    // slow shards are sent while the other requests are answered
+    return MHD_start_daemon(MHD_USE_THREAD_PER_CONNECTION,
                             8092,
                             NULL,
                             NULL,
@@ -5,6 +5,9 @@
 #include "../src/bip39.h"
 #include "../src/utils.h"
 #include "../src/crypto.h"
+#include "../src/journal.h"
+#include "../src/farmers.h"
+#include "../src/reports.h"
 
 #include "mockbridge.json.h"
 #include "mockbridgeinfo.json.h"
@@ -38,4 +41,23 @@ int mock_farmer_shard_server(void *cls,
 struct MHD_Daemon *start_farmer_server();
 void free_farmer_data();
 
+/* How the mock bridge and farmer serve the shards of the test file, all of
+ * the data shards have a farmer unless they are served by default */
+typedef enum {
+    MOCK_SHARDS_DEFAULT = 0,
+    // shard 5 is sent slowly, the farmer of its hedge pointer is fast
+    MOCK_SHARDS_SLOW_FARMER,
+    // shard 5 is slow at first, the farmer of its hedge pointer is slow
+    MOCK_SHARDS_SLOW_HEDGE,
+    // the farmer of shard 5 fails and no other farmer has it
+    MOCK_SHARDS_FAILED_FARMER
+} mock_shards_t;
+
+extern mock_shards_t mock_shards;
+extern int mock_hedge_requests;
+extern int mock_parity_requests;
+extern int mock_early_parity_requests;
+
+void set_mock_shards(mock_shards_t shards);
+
 int create_test_file(char *file);
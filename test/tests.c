@@ -191,6 +191,42 @@ void check_list_files(uv_work_t *work_req, int status)
     free(work_req);
 }
 
+static int list_files_pages = 0;
+
+void check_list_files_page(uv_work_t *work_req, int status)
+{
+    assert(status == 0);
+    list_files_request_t *req = work_req->data;
+    storj_env_t *env = req->handle;
+    assert(req->error_code == 0);
+
+    list_files_pages += 1;
+
+    if (list_files_pages == 1) {
+        assert(req->total_files == 1);
+        assert(strcmp(req->files[0].id, "f18b5ca437b1ca3daa14969f") == 0);
+        assert(strcmp(req->next_cursor, "2016-03-04T17:01:02.629Z") == 0);
+    } else if (list_files_pages == 2) {
+        assert(req->total_files == 1);
+        assert(strcmp(req->files[0].id, "85fb0ed00de1196dc22e0f6d") == 0);
+        assert(req->next_cursor != NULL);
+    } else {
+        assert(req->total_files == 0);
+        assert(req->next_cursor == NULL);
+        pass("storj_bridge_list_files_page");
+    }
+
+    if (req->next_cursor) {
+        status = storj_bridge_list_files_page(env, req->bucket_id,
+                                              req->next_cursor, 1, env,
+                                              check_list_files_page);
+        assert(status == 0);
+    }
+
+    storj_free_list_files_request(req);
+    free(work_req);
+}
+
 void check_list_files_badauth(uv_work_t *work_req, int status)
 {
     assert(status == 0);
@@ -281,11 +317,41 @@ void check_resolve_file_progress(double progress,
     // TODO check error case
 }
 
+bool check_downloaded_data(FILE *fd)
+{
+    // each shard of the mock file is filled with the next letter
+    uint64_t shard_size = 16777216;
+    uint64_t position = 0;
+    bool data_matches = true;
+    uint8_t buffer[BUFSIZ];
+    size_t read_bytes;
+
+    rewind(fd);
+    while ((read_bytes = fread(buffer, 1, BUFSIZ, fd)) > 0) {
+        for (size_t i = 0; i < read_bytes; i++) {
+            if (buffer[i] != 'a' + (position + i) / shard_size) {
+                data_matches = false;
+                break;
+            }
+        }
+        position += read_bytes;
+    }
+
+    return data_matches && position == shard_size * 14;
+}
+
 void check_resolve_file(int status, FILE *fd, void *handle)
 {
-    fclose(fd);
     assert(handle == NULL);
-    if (status) {
+
+    bool data_matches = !status && check_downloaded_data(fd);
+
+    fclose(fd);
+
+    if (!status && !data_matches) {
+        fail("storj_bridge_resolve_file");
+        printf("Downloaded data does not match\n");
+    } else if (status) {
         fail("storj_bridge_resolve_file");
         printf("Download failed: %s\n", storj_strerror(status));
     } else {
@@ -293,6 +359,57 @@ void check_resolve_file(int status, FILE *fd, void *handle)
     }
 }
 
+uint64_t stream_offset = 0;
+uint64_t stream_written_bytes = 0;
+bool stream_data_matches = true;
+
+int check_resolve_file_stream_write(const uint8_t *buffer,
+                                    size_t length,
+                                    void *handle)
+{
+    assert(handle == NULL);
+
+    // each shard of the mock file is filled with the next letter
+    uint64_t shard_size = 16777216;
+    for (size_t i = 0; i < length; i++) {
+        uint64_t position = stream_offset + stream_written_bytes + i;
+        if (buffer[i] != 'a' + position / shard_size) {
+            stream_data_matches = false;
+            break;
+        }
+    }
+
+    stream_written_bytes += length;
+
+    return 0;
+}
+
+void check_resolve_file_stream(int status, FILE *fd, void *handle)
+{
+    assert(fd == NULL);
+    assert(handle == NULL);
+    if (status || !stream_data_matches ||
+        stream_written_bytes != (uint64_t)16777216 * 14) {
+        fail("storj_bridge_resolve_file_stream");
+        printf("Download failed: %s\n", storj_strerror(status));
+    } else {
+        pass("storj_bridge_resolve_file_stream");
+    }
+}
+
+void check_resolve_file_range(int status, FILE *fd, void *handle)
+{
+    assert(fd == NULL);
+    assert(handle == NULL);
+    if (status || !stream_data_matches ||
+        stream_written_bytes != 16777216 + 1000) {
+        fail("storj_bridge_resolve_file_range");
+        printf("Download failed: %s\n", storj_strerror(status));
+    } else {
+        pass("storj_bridge_resolve_file_range");
+    }
+}
+
 void check_resolve_file_null_mnemonic(int status, FILE *fd, void *handle)
 {
     fclose(fd);
@@ -316,6 +433,29 @@ void check_resolve_file_cancel(int status, FILE *fd, void *handle)
     }
 }
 
+storj_download_state_t *journal_download_state = NULL;
+int journal_download_status = 0;
+bool journal_download_matches = false;
+
+void check_resolve_file_journal_progress(double progress,
+                                         uint64_t downloaded_bytes,
+                                         uint64_t total_bytes,
+                                         void *handle)
+{
+    // stop the first download after a few shards
+    if (journal_download_state && downloaded_bytes >= (uint64_t)16777216 * 3) {
+        storj_bridge_resolve_file_cancel(journal_download_state);
+    }
+}
+
+void check_resolve_file_journal(int status, FILE *fd, void *handle)
+{
+    assert(handle == NULL);
+    journal_download_status = status;
+    journal_download_matches = !status && check_downloaded_data(fd);
+    fclose(fd);
+}
+
 void check_store_file_progress(double progress,
                                uint64_t uploaded_bytes,
                                uint64_t total_bytes,
@@ -327,9 +467,12 @@ void check_store_file_progress(double progress,
     }
 }
 
+bool store_file_finished = false;
+
 void check_store_file(int error_code, storj_file_meta_t *file, void *handle)
 {
     assert(handle == NULL);
+    store_file_finished = true;
     if (error_code == 0) {
         if (file && strcmp(file->id, "85fb0ed00de1196dc22e0f6d") == 0 ) {
             pass("storj_bridge_store_file");
@@ -357,6 +500,49 @@ void check_store_file_cancel(int error_code, storj_file_meta_t *file, void *hand
     storj_free_uploaded_file_info(file);
 }
 
+int journal_upload_status = 0;
+bool journal_upload_matches = false;
+
+void check_store_file_journal_progress(double progress,
+                                       uint64_t uploaded_bytes,
+                                       uint64_t total_bytes,
+                                       void *handle)
+{
+    assert(handle == NULL);
+}
+
+void check_store_file_journal(int error_code, storj_file_meta_t *file,
+                              void *handle)
+{
+    assert(handle == NULL);
+    journal_upload_status = error_code;
+    journal_upload_matches = file &&
+        strcmp(file->id, "85fb0ed00de1196dc22e0f6d") == 0;
+    storj_free_uploaded_file_info(file);
+}
+
+// Count the records of a journal with a name
+int count_journal_records(char *path, char *name)
+{
+    FILE *fp = fopen(path, "r");
+    if (!fp) {
+        return -1;
+    }
+
+    int count = 0;
+    char line[STORJ_JOURNAL_LINE_SIZE];
+    while (fgets(line, sizeof(line), fp)) {
+        if (strncmp(line, name, strlen(name)) == 0 &&
+            line[strlen(name)] == ' ') {
+            count += 1;
+        }
+    }
+
+    fclose(fp);
+
+    return count;
+}
+
 void check_delete_file(uv_work_t *work_req, int status)
 {
     assert(status == 0);
@@ -538,6 +724,44 @@ int create_test_upload_file(char *filepath)
     return 0;
 }
 
+// The shard hashes of the whole file upload, to compare the stream upload
+// with. The state is freed once the upload has finished, the hashes are
+// copied after each iteration of the loop until then.
+char **upload_shard_hashes = NULL;
+int upload_total_shards = 0;
+
+int run_upload_shard_hashes(storj_env_t *env, storj_upload_state_t *state,
+                            char ***hashes, int *total_shards)
+{
+    store_file_finished = false;
+
+    while (!store_file_finished) {
+        if (state->shard && !*hashes) {
+            *total_shards = state->total_shards;
+            *hashes = calloc(state->total_shards, sizeof(char *));
+        }
+
+        for (int i = 0; *hashes && i < *total_shards; i++) {
+            if (!(*hashes)[i] && state->shard[i].meta->hash) {
+                (*hashes)[i] = strdup(state->shard[i].meta->hash);
+            }
+        }
+
+        uv_run(env->loop, UV_RUN_ONCE);
+    }
+
+    // run the rest of the queued events
+    return uv_run(env->loop, UV_RUN_DEFAULT);
+}
+
+void free_shard_hashes(char **hashes, int total_shards)
+{
+    for (int i = 0; hashes && i < total_shards; i++) {
+        free(hashes[i]);
+    }
+    free(hashes);
+}
+
 int test_upload()
 {
 
@@ -576,10 +800,82 @@ int test_upload()
     }
 
     // run all queued events
-    if (uv_run(env->loop, UV_RUN_DEFAULT)) {
+    if (run_upload_shard_hashes(env, state, &upload_shard_hashes,
+                                &upload_total_shards)) {
+        return 1;
+    }
+
+    free(file);
+    storj_destroy_env(env);
+
+    return 0;
+}
+
+int test_upload_stream()
+{
+
+    // initialize event loop and environment
+    storj_env_t *env = storj_init_env(&bridge_options,
+                                      &encrypt_options,
+                                      &http_options,
+                                      &log_options);
+    assert(env != NULL);
+
+    char *file_name = "storj-test-upload.data";
+    int len = strlen(folder) + strlen(file_name);
+    char *file = calloc(len + 1, sizeof(char));
+    strcpy(file, folder);
+    strcat(file, file_name);
+    file[len] = '\0';
+
+    create_test_upload_file(file);
+
+    // upload file
+    storj_upload_opts_t upload_opts = {
+        .index = "d2891da46d9c3bf42ad619ceddc1b6621f83e6cb74e6b6b6bc96bdbfaefb8692",
+        .bucket_id = "368be0816766b28fd5f43af5",
+        .file_name = file_name,
+        .fd = fopen(file, "r"),
+        .rs = true,
+        .stream = true
+    };
+
+    storj_upload_state_t *state = storj_bridge_store_file(env,
+                                                          &upload_opts,
+                                                          NULL,
+                                                          check_store_file_progress,
+                                                          check_store_file);
+    if (!state || state->error_status != 0) {
+        return 1;
+    }
+
+    // run all queued events
+    char **hashes = NULL;
+    int total_shards = 0;
+    if (run_upload_shard_hashes(env, state, &hashes, &total_shards)) {
         return 1;
     }
 
+    // the shards encoded in stripes are the same as of the whole file
+    bool hashes_match = hashes && upload_shard_hashes &&
+        total_shards == upload_total_shards;
+    for (int i = 0; hashes_match && i < total_shards; i++) {
+        if (!hashes[i] || !upload_shard_hashes[i] ||
+            strcmp(hashes[i], upload_shard_hashes[i])) {
+            hashes_match = false;
+        }
+    }
+
+    if (hashes_match) {
+        pass("storj_bridge_store_file_stream (shard hashes)");
+    } else {
+        fail("storj_bridge_store_file_stream (shard hashes)");
+    }
+
+    free_shard_hashes(hashes, total_shards);
+    free_shard_hashes(upload_shard_hashes, upload_total_shards);
+    upload_shard_hashes = NULL;
+
     free(file);
     storj_destroy_env(env);
 
@@ -651,6 +947,111 @@ int test_upload_cancel()
     return 0;
 }
 
+int test_upload_journal()
+{
+
+    // initialize event loop and environment
+    storj_env_t *env = storj_init_env(&bridge_options,
+                                      &encrypt_options,
+                                      &http_options,
+                                      &log_options);
+    assert(env != NULL);
+
+    char *file_name = "storj-test-upload.data";
+    int len = strlen(folder) + strlen(file_name);
+    char *file = calloc(len + 1, sizeof(char));
+    strcpy(file, folder);
+    strcat(file, file_name);
+    file[len] = '\0';
+
+    char *journal = calloc(strlen(folder) + 25 + 1, sizeof(char));
+    strcpy(journal, folder);
+    strcat(journal, "storj-test-upload.journal");
+
+    create_test_upload_file(file);
+    unlink(journal);
+
+    // upload one shard at a time, and stop the upload after a few shards
+    storj_upload_opts_t upload_opts = {
+        .index = "d2891da46d9c3bf42ad619ceddc1b6621f83e6cb74e6b6b6bc96bdbfaefb8692",
+        .bucket_id = "368be0816766b28fd5f43af5",
+        .file_name = file_name,
+        .journal_path = journal,
+        .fd = fopen(file, "r"),
+        .push_shard_limit = 1,
+        .push_shard_max = 1,
+        .rs = true
+    };
+
+    storj_upload_state_t *state = storj_bridge_store_file(env,
+                                                          &upload_opts,
+                                                          NULL,
+                                                          check_store_file_journal_progress,
+                                                          check_store_file_journal);
+    if (!state || state->error_status != 0) {
+        return 1;
+    }
+
+    // process the loop one at a time, and cancel once shards are recorded
+    bool more;
+    bool canceled = false;
+    do {
+        more = uv_run(env->loop, UV_RUN_ONCE);
+        if (more == false) {
+            more = uv_loop_alive(env->loop);
+            if (uv_run(env->loop, UV_RUN_NOWAIT) != 0) {
+                more = true;
+            }
+        }
+
+        if (!canceled && count_journal_records(journal, "shard") >= 3) {
+            assert(storj_bridge_store_file_cancel(state) == 0);
+            canceled = true;
+        }
+
+    } while (more == true);
+
+    int canceled_status = journal_upload_status;
+    int recorded_frames = count_journal_records(journal, "frame");
+    int recorded_shards = count_journal_records(journal, "shard");
+
+    // continue the upload from the journal
+    upload_opts.fd = fopen(file, "r");
+
+    state = storj_bridge_store_file(env,
+                                    &upload_opts,
+                                    NULL,
+                                    check_store_file_journal_progress,
+                                    check_store_file_journal);
+    if (!state || state->error_status != 0) {
+        return 1;
+    }
+
+    if (uv_run(env->loop, UV_RUN_DEFAULT)) {
+        return 1;
+    }
+
+    if (canceled_status != STORJ_TRANSFER_CANCELED ||
+        recorded_frames != 1 ||
+        recorded_shards < 1 || recorded_shards >= 18 ||
+        journal_upload_status != 0 ||
+        !journal_upload_matches ||
+        access(journal, F_OK) == 0) {
+        fail("storj_bridge_store_file_journal");
+        printf("\t\tframes: %d, shards: %d, status: %s\n",
+               recorded_frames, recorded_shards,
+               storj_strerror(journal_upload_status));
+    } else {
+        pass("storj_bridge_store_file_journal");
+    }
+
+    free(journal);
+    free(file);
+    storj_destroy_env(env);
+
+    return 0;
+}
+
 int _test_download(storj_encrypt_options_t *encrypt_options, void *cb_finished)
 {
 
@@ -698,12 +1099,7 @@ int test_download()
     return _test_download(&encrypt_options, check_resolve_file);
 }
 
-int test_download_null_mnemonic()
-{
-    return _test_download(&encrypt_options_null_mnemonic, check_resolve_file_null_mnemonic);
-}
-
-int test_download_cancel()
+int test_download_stream()
 {
 
     // initialize event loop and environment
@@ -713,44 +1109,124 @@ int test_download_cancel()
                                       &log_options);
     assert(env != NULL);
 
-    // resolve file
-    char *download_file = calloc(strlen(folder) + 33 + 1, sizeof(char));
-    strcpy(download_file, folder);
-    strcat(download_file, "storj-test-download-canceled.data");
-    FILE *download_fp = fopen(download_file, "w+");
-
     char *bucket_id = "368be0816766b28fd5f43af5";
     char *file_id = "998960317b6725a3f8080c2b";
 
-    storj_download_state_t *state = storj_bridge_resolve_file(env,
-                                                              bucket_id,
-                                                              file_id,
-                                                              download_fp,
-                                                              NULL,
-                                                              check_resolve_file_progress,
-                                                              check_resolve_file_cancel);
+    storj_download_state_t *state = storj_bridge_resolve_file_stream(env,
+                                                                     bucket_id,
+                                                                     file_id,
+                                                                     NULL,
+                                                                     check_resolve_file_stream_write,
+                                                                     check_resolve_file_progress,
+                                                                     check_resolve_file_stream);
 
     if (!state || state->error_status != 0) {
         return 1;
     }
 
-    // process the loop one at a time so that we can do other things while
-    // the loop is processing, such as cancel the download
-    int count = 0;
-    bool more;
-    int status = 0;
-    do {
-        more = uv_run(env->loop, UV_RUN_ONCE);
-        if (more == false) {
-            more = uv_loop_alive(env->loop);
-            if (uv_run(env->loop, UV_RUN_NOWAIT) != 0) {
-                more = true;
-            }
-        }
+    if (uv_run(env->loop, UV_RUN_DEFAULT)) {
+        return 1;
+    }
+
+    storj_destroy_env(env);
+
+    return 0;
+}
+
+int test_download_range()
+{
+
+    // initialize event loop and environment
+    storj_env_t *env = storj_init_env(&bridge_options,
+                                      &encrypt_options,
+                                      &http_options,
+                                      &log_options);
+    assert(env != NULL);
+
+    char *bucket_id = "368be0816766b28fd5f43af5";
+    char *file_id = "998960317b6725a3f8080c2b";
+
+    // range across the end of the 7th shard and into the 8th shard
+    stream_offset = (uint64_t)16777216 * 6 + 77;
+    stream_written_bytes = 0;
+    stream_data_matches = true;
+
+    storj_download_state_t *state = storj_bridge_resolve_file_range(env,
+                                                                    bucket_id,
+                                                                    file_id,
+                                                                    stream_offset,
+                                                                    16777216 + 1000,
+                                                                    NULL,
+                                                                    check_resolve_file_stream_write,
+                                                                    check_resolve_file_progress,
+                                                                    check_resolve_file_range);
+
+    if (!state || state->error_status != 0) {
+        return 1;
+    }
+
+    if (uv_run(env->loop, UV_RUN_DEFAULT)) {
+        return 1;
+    }
+
+    storj_destroy_env(env);
+
+    return 0;
+}
+
+int test_download_null_mnemonic()
+{
+    return _test_download(&encrypt_options_null_mnemonic, check_resolve_file_null_mnemonic);
+}
+
+int test_download_cancel()
+{
+
+    // initialize event loop and environment
+    storj_env_t *env = storj_init_env(&bridge_options,
+                                      &encrypt_options,
+                                      &http_options,
+                                      &log_options);
+    assert(env != NULL);
+
+    // resolve file
+    char *download_file = calloc(strlen(folder) + 33 + 1, sizeof(char));
+    strcpy(download_file, folder);
+    strcat(download_file, "storj-test-download-canceled.data");
+    FILE *download_fp = fopen(download_file, "w+");
+
+    char *bucket_id = "368be0816766b28fd5f43af5";
+    char *file_id = "998960317b6725a3f8080c2b";
+
+    storj_download_state_t *state = storj_bridge_resolve_file(env,
+                                                              bucket_id,
+                                                              file_id,
+                                                              download_fp,
+                                                              NULL,
+                                                              check_resolve_file_progress,
+                                                              check_resolve_file_cancel);
+
+    if (!state || state->error_status != 0) {
+        return 1;
+    }
+
+    // process the loop one at a time so that we can do other things while
+    // the loop is processing, such as cancel the download
+    int count = 0;
+    bool more;
+    int status = 0;
+    do {
+        more = uv_run(env->loop, UV_RUN_ONCE);
+        if (more == false) {
+            more = uv_loop_alive(env->loop);
+            if (uv_run(env->loop, UV_RUN_NOWAIT) != 0) {
+                more = true;
+            }
+        }
 
         count++;
 
-        if (count == 100) {
+        if (count == 10) {
             status = storj_bridge_resolve_file_cancel(state);
             assert(status == 0);
         }
@@ -842,6 +1318,11 @@ int test_api()
                                      check_list_files);
     assert(status == 0);
 
+    // list files in a bucket a page at a time
+    status = storj_bridge_list_files_page(env, bucket_id, NULL, 1, env,
+                                          check_list_files_page);
+    assert(status == 0);
+
     // get file id
     status = storj_bridge_get_file_id(env, bucket_id, "storj-test-download.data",
                                       NULL, check_get_file_id);
@@ -1240,6 +1721,63 @@ int test_generate_file_key()
     return 0;
 }
 
+int test_key_cache()
+{
+    char *mnemonic = "abandon abandon abandon abandon abandon abandon abandon abandon abandon abandon abandon about";
+    char *bucket_id = "0123456789ab0123456789ab";
+    char *file_name = "samplefile.txt";
+    char *index = "150589c9593bbebc0e795d8c4fa97304b42c110d9f0095abfac644763beca66e";
+    char *expected_file_key = "bb3552fc2e16d24a147af4b2d163e3164e6dbd04bbc45fc1c3eab69f384337e9";
+    char *file_key = calloc(DETERMINISTIC_KEY_SIZE + 1, sizeof(char));
+    char *encrypted_name = NULL;
+    char *expected_encrypted_name = NULL;
+    char *decrypted_name = NULL;
+    int status = 0;
+
+    storj_key_cache_t *cache = key_cache_new(mnemonic);
+
+    // the second lookup of the bucket is served from the cache
+    for (int i = 0; i < 2; i++) {
+        memset(file_key, 0, DETERMINISTIC_KEY_SIZE + 1);
+        generate_file_key_cached(cache, bucket_id, index, &file_key);
+        if (strcmp(expected_file_key, file_key) != 0) {
+            status = 1;
+        }
+    }
+
+    if (cache->total != 1) {
+        status = 1;
+    }
+
+    encrypt_file_name(mnemonic, bucket_id, file_name,
+                      &expected_encrypted_name);
+    encrypt_file_name_cached(cache, bucket_id, file_name, &encrypted_name);
+    decrypt_file_name_cached(cache, bucket_id, encrypted_name,
+                             &decrypted_name);
+
+    if (!encrypted_name || !decrypted_name ||
+        strcmp(expected_encrypted_name, encrypted_name) != 0 ||
+        strcmp(file_name, decrypted_name) != 0) {
+        status = 1;
+    }
+
+    if (status) {
+        fail("test_key_cache");
+        printf("\t\texpected file_key: %s\n", expected_file_key);
+        printf("\t\tactual file_key:   %s\n", file_key);
+    } else {
+        pass("test_key_cache");
+    }
+
+    free(file_key);
+    free(encrypted_name);
+    free(expected_encrypted_name);
+    free(decrypted_name);
+    key_cache_destroy(cache);
+
+    return status;
+}
+
 int test_str2hex()
 {
     char *data = "632442ba2e5f28a3a4e68dcb0b45d1d8f097d5b47479d74e2259055aa25a08aa";
@@ -1386,6 +1924,101 @@ int test_determine_shard_size()
     return 0;
 }
 
+int test_sha256_update_lanes()
+{
+    // more lanes than are compressed at once, each with a different
+    // amount of data already added
+    int lanes = STORJ_SHA256_LANES + 3;
+    struct sha256_ctx ctx[STORJ_SHA256_LANES + 3];
+    struct sha256_ctx expected[STORJ_SHA256_LANES + 3];
+    uint8_t data[4096 + 37];
+    uint8_t digest[SHA256_DIGEST_SIZE];
+    uint8_t expected_digest[SHA256_DIGEST_SIZE];
+    int status = 0;
+
+    for (int i = 0; i < sizeof(data); i++) {
+        data[i] = i * 7 + 3;
+    }
+
+    for (int l = 0; l < lanes; l++) {
+        sha256_init(&ctx[l]);
+        sha256_init(&expected[l]);
+        sha256_update(&ctx[l], l * 13, data);
+        sha256_update(&expected[l], l * 13, data);
+    }
+
+    for (int i = 0; i < 3; i++) {
+        sha256_update_lanes(ctx, lanes, sizeof(data) - i, data + i);
+        for (int l = 0; l < lanes; l++) {
+            sha256_update(&expected[l], sizeof(data) - i, data + i);
+        }
+    }
+
+    for (int l = 0; l < lanes; l++) {
+        sha256_digest(&ctx[l], SHA256_DIGEST_SIZE, digest);
+        sha256_digest(&expected[l], SHA256_DIGEST_SIZE, expected_digest);
+        if (memcmp(digest, expected_digest, SHA256_DIGEST_SIZE) != 0) {
+            status = 1;
+        }
+    }
+
+    if (status) {
+        fail("test_sha256_update_lanes");
+    } else {
+        pass("test_sha256_update_lanes");
+    }
+
+    return status;
+}
+
+int test_aes256_ctr_crypt()
+{
+    struct aes256_ctx ctx;
+    uint8_t key[AES256_KEY_SIZE];
+    uint8_t ctr[AES_BLOCK_SIZE];
+    uint8_t expected_ctr[AES_BLOCK_SIZE];
+    uint8_t data[4096 + 21];
+    uint8_t expected[sizeof(data)];
+    uint8_t actual[sizeof(data)];
+    int status = 0;
+
+    for (int i = 0; i < sizeof(key); i++) {
+        key[i] = i * 5 + 9;
+    }
+    for (int i = 0; i < sizeof(data); i++) {
+        data[i] = i * 13 + 1;
+    }
+    aes256_set_encrypt_key(&ctx, key);
+
+    // the counter carries into the upper half while encrypting
+    memset(ctr, 0xff, AES_BLOCK_SIZE);
+    ctr[7] = 0x01;
+    ctr[15] = 0x00;
+    memcpy(expected_ctr, ctr, AES_BLOCK_SIZE);
+
+    ctr_crypt(&ctx, (nettle_cipher_func *)aes256_encrypt, AES_BLOCK_SIZE,
+              expected_ctr, sizeof(data), expected, data);
+
+    // in place and in two pieces, the last ending with a partial block
+    memcpy(actual, data, sizeof(data));
+    aes256_ctr_crypt(&ctx, ctr, 4000, actual, actual);
+    aes256_ctr_crypt(&ctx, ctr, sizeof(data) - 4000, actual + 4000,
+                     actual + 4000);
+
+    if (memcmp(expected, actual, sizeof(data)) != 0 ||
+        memcmp(expected_ctr, ctr, AES_BLOCK_SIZE) != 0) {
+        status = 1;
+    }
+
+    if (status) {
+        fail("test_aes256_ctr_crypt");
+    } else {
+        pass("test_aes256_ctr_crypt");
+    }
+
+    return status;
+}
+
 int test_increment_ctr_aes_iv()
 {
     uint8_t iv[16] = {188,14,95,229,78,112,182,107,
@@ -1523,6 +2156,393 @@ int test_meta_encryption()
     return 0;
 }
 
+int test_download_journal()
+{
+
+    // initialize event loop and environment
+    storj_env_t *env = storj_init_env(&bridge_options,
+                                      &encrypt_options,
+                                      &http_options,
+                                      &log_options);
+    assert(env != NULL);
+
+    char *download_file = calloc(strlen(folder) + 32 + 1, sizeof(char));
+    strcpy(download_file, folder);
+    strcat(download_file, "storj-test-download-journal.data");
+
+    char *journal = calloc(strlen(folder) + 27 + 1, sizeof(char));
+    strcpy(journal, folder);
+    strcat(journal, "storj-test-download.journal");
+
+    unlink(journal);
+
+    char *bucket_id = "368be0816766b28fd5f43af5";
+    char *file_id = "998960317b6725a3f8080c2b";
+
+    // download one shard at a time, and stop after a few shards
+    FILE *download_fp = fopen(download_file, "w+");
+
+    journal_download_state = storj_bridge_resolve_file(env,
+                                                       bucket_id,
+                                                       file_id,
+                                                       download_fp,
+                                                       NULL,
+                                                       check_resolve_file_journal_progress,
+                                                       check_resolve_file_journal);
+    if (!journal_download_state || journal_download_state->error_status != 0) {
+        return 1;
+    }
+
+    journal_download_state->journal_path = journal;
+    journal_download_state->download_max_concurrency = 1;
+
+    if (uv_run(env->loop, UV_RUN_DEFAULT)) {
+        return 1;
+    }
+
+    journal_download_state = NULL;
+
+    int canceled_status = journal_download_status;
+    int recorded_pointers = count_journal_records(journal, "pointer");
+
+    // continue the download to the same file without truncating it
+    download_fp = fopen(download_file, "r+");
+
+    storj_download_state_t *state = storj_bridge_resolve_file(env,
+                                                              bucket_id,
+                                                              file_id,
+                                                              download_fp,
+                                                              NULL,
+                                                              check_resolve_file_journal_progress,
+                                                              check_resolve_file_journal);
+    if (!state || state->error_status != 0) {
+        return 1;
+    }
+
+    state->journal_path = journal;
+
+    if (uv_run(env->loop, UV_RUN_DEFAULT)) {
+        return 1;
+    }
+
+    if (canceled_status != STORJ_TRANSFER_CANCELED ||
+        recorded_pointers < 1 || recorded_pointers >= 14 ||
+        journal_download_status != 0 ||
+        !journal_download_matches ||
+        access(journal, F_OK) == 0) {
+        fail("storj_bridge_resolve_file_journal");
+        printf("\t\tpointers: %d, status: %s\n", recorded_pointers,
+               storj_strerror(journal_download_status));
+    } else {
+        pass("storj_bridge_resolve_file_journal");
+    }
+
+    free(journal);
+    free(download_file);
+    storj_destroy_env(env);
+
+    return 0;
+}
+
+uint64_t rate_limit_start = 0;
+
+void check_resolve_file_rate_limit(int status, FILE *fd, void *handle)
+{
+    bool data_matches = !status && check_downloaded_data(fd);
+    uint64_t elapsed = get_time_milliseconds() - rate_limit_start;
+
+    fclose(fd);
+
+    // 14 shards of 16 MiB at 256 MiB per second, less a burst
+    if (status || !data_matches || elapsed < 700) {
+        fail("storj_env_set_rate_limits");
+        printf("\t\tstatus: %s, elapsed: %" PRIu64 " ms\n",
+               storj_strerror(status), elapsed);
+    } else {
+        pass("storj_env_set_rate_limits");
+    }
+}
+
+int test_download_rate_limit()
+{
+
+    // initialize event loop and environment
+    storj_env_t *env = storj_init_env(&bridge_options,
+                                      &encrypt_options,
+                                      &http_options,
+                                      &log_options);
+    assert(env != NULL);
+
+    storj_env_set_rate_limits(env, 0, 268435456);
+
+    char *download_file = calloc(strlen(folder) + 35 + 1, sizeof(char));
+    strcpy(download_file, folder);
+    strcat(download_file, "storj-test-download-rate-limit.data");
+    FILE *download_fp = fopen(download_file, "w+");
+
+    char *bucket_id = "368be0816766b28fd5f43af5";
+    char *file_id = "998960317b6725a3f8080c2b";
+
+    rate_limit_start = get_time_milliseconds();
+
+    storj_download_state_t *state = storj_bridge_resolve_file(env,
+                                                              bucket_id,
+                                                              file_id,
+                                                              download_fp,
+                                                              NULL,
+                                                              check_resolve_file_progress,
+                                                              check_resolve_file_rate_limit);
+    if (!state || state->error_status != 0) {
+        return 1;
+    }
+
+    free(download_file);
+
+    if (uv_run(env->loop, UV_RUN_DEFAULT)) {
+        return 1;
+    }
+
+    storj_destroy_env(env);
+
+    return 0;
+}
+
+storj_download_state_t *hedge_download_state = NULL;
+char *hedge_farmer_id = NULL;
+char *hedge_test_name = NULL;
+
+void check_resolve_file_hedge(int status, FILE *fd, void *handle)
+{
+    // the report of the slow shard is of the farmer it was received from
+    storj_pointer_t *pointer = &hedge_download_state->pointers[5];
+    char *farmer_id = pointer->report->farmer_id;
+
+    bool data_matches = !status && check_downloaded_data(fd);
+    bool farmer_matches = farmer_id && 0 == strcmp(farmer_id, hedge_farmer_id);
+
+    fclose(fd);
+
+    if (status || !data_matches || !farmer_matches || !pointer->hedged ||
+        mock_hedge_requests != 1) {
+        fail(hedge_test_name);
+        printf("\t\tstatus: %s, farmer: %s, hedge requests: %d\n",
+               storj_strerror(status), farmer_id, mock_hedge_requests);
+    } else {
+        pass(hedge_test_name);
+    }
+}
+
+int _test_download_hedge(mock_shards_t shards, char *farmer_id,
+                         char *test_name)
+{
+
+    // initialize event loop and environment
+    storj_env_t *env = storj_init_env(&bridge_options,
+                                      &encrypt_options,
+                                      &http_options,
+                                      &log_options);
+    assert(env != NULL);
+
+    char *download_file = calloc(strlen(folder) + 30 + 1, sizeof(char));
+    strcpy(download_file, folder);
+    strcat(download_file, "storj-test-download-hedge.data");
+    FILE *download_fp = fopen(download_file, "w+");
+
+    char *bucket_id = "368be0816766b28fd5f43af5";
+    char *file_id = "998960317b6725a3f8080c2b";
+
+    set_mock_shards(shards);
+    hedge_farmer_id = farmer_id;
+    hedge_test_name = test_name;
+
+    hedge_download_state = storj_bridge_resolve_file(env,
+                                                     bucket_id,
+                                                     file_id,
+                                                     download_fp,
+                                                     NULL,
+                                                     check_resolve_file_progress,
+                                                     check_resolve_file_hedge);
+    if (!hedge_download_state || hedge_download_state->error_status != 0) {
+        return 1;
+    }
+
+    free(download_file);
+
+    if (uv_run(env->loop, UV_RUN_DEFAULT)) {
+        return 1;
+    }
+
+    hedge_download_state = NULL;
+    set_mock_shards(MOCK_SHARDS_DEFAULT);
+
+    storj_destroy_env(env);
+
+    return 0;
+}
+
+int test_download_hedge()
+{
+    // a slow shard is received from the farmer of its hedge pointer first
+    _test_download_hedge(MOCK_SHARDS_SLOW_FARMER,
+                         "8c5e3a2bd5a7be16c2d5a86c9c2a7a08e2c6b0f7",
+                         "storj_bridge_resolve_file (hedge wins)");
+
+    // the first farmer catches up before the hedged copy is received
+    _test_download_hedge(MOCK_SHARDS_SLOW_HEDGE,
+                         "15a02aed7a92e593d03d6cd1f43c0ab504131296",
+                         "storj_bridge_resolve_file (primary wins)");
+
+    return 0;
+}
+
+void check_resolve_file_failed_farmer(int status, FILE *fd, void *handle)
+{
+    bool data_matches = !status && check_downloaded_data(fd);
+
+    fclose(fd);
+
+    // the parity shards are only downloaded once the farmer has failed
+    if (status || !data_matches || mock_parity_requests == 0 ||
+        mock_early_parity_requests != 0) {
+        fail("storj_bridge_resolve_file (failed farmer)");
+        printf("\t\tstatus: %s, parity requests: %d, early: %d\n",
+               storj_strerror(status), mock_parity_requests,
+               mock_early_parity_requests);
+    } else {
+        pass("storj_bridge_resolve_file (failed farmer)");
+    }
+}
+
+int test_download_failed_farmer()
+{
+
+    // initialize event loop and environment
+    storj_env_t *env = storj_init_env(&bridge_options,
+                                      &encrypt_options,
+                                      &http_options,
+                                      &log_options);
+    assert(env != NULL);
+
+    char *download_file = calloc(strlen(folder) + 38 + 1, sizeof(char));
+    strcpy(download_file, folder);
+    strcat(download_file, "storj-test-download-failed-farmer.data");
+    FILE *download_fp = fopen(download_file, "w+");
+
+    char *bucket_id = "368be0816766b28fd5f43af5";
+    char *file_id = "998960317b6725a3f8080c2b";
+
+    set_mock_shards(MOCK_SHARDS_FAILED_FARMER);
+
+    storj_download_state_t *state = storj_bridge_resolve_file(env,
+                                                              bucket_id,
+                                                              file_id,
+                                                              download_fp,
+                                                              NULL,
+                                                              check_resolve_file_progress,
+                                                              check_resolve_file_failed_farmer);
+    if (!state || state->error_status != 0) {
+        return 1;
+    }
+
+    free(download_file);
+
+    if (uv_run(env->loop, UV_RUN_DEFAULT)) {
+        return 1;
+    }
+
+    set_mock_shards(MOCK_SHARDS_DEFAULT);
+
+    storj_destroy_env(env);
+
+    return 0;
+}
+
+int test_journal()
+{
+    char *path = calloc(strlen(folder) + 18 + 1, sizeof(char));
+    strcpy(path, folder);
+    strcat(path, "storj-test.journal");
+
+    unlink(path);
+
+    int failed = 0;
+    storj_journal_t *journal = NULL;
+
+    if (journal_open(path, "transfer 1", &journal) ||
+        journal_find(journal, "shard", 0) ||
+        journal_append(journal, "shard", 0, "first") ||
+        journal_append(journal, "shard", 2, "second") ||
+        journal_append(journal, "shard", 0, "third")) {
+        fail("test_journal(0)");
+        return 1;
+    }
+    journal_close(journal, false);
+
+    // a line that wasn't completed is discarded
+    FILE *fp = fopen(path, "a");
+    fputs("shard 3 incompl", fp);
+    fclose(fp);
+
+    journal = NULL;
+    if (journal_open(path, "transfer 1", &journal)) {
+        fail("test_journal(1)");
+        return 1;
+    }
+
+    const char *value = journal_find(journal, "shard", 0);
+    if (!value || strcmp(value, "third") != 0) {
+        failed = 1;
+    }
+    value = journal_find(journal, "shard", 2);
+    if (!value || strcmp(value, "second") != 0) {
+        failed = 1;
+    }
+    if (journal_find(journal, "shard", 3) ||
+        journal_find(journal, "frame", 2)) {
+        failed = 1;
+    }
+    if (journal_append(journal, "shard", 3, "fourth")) {
+        failed = 1;
+    }
+    journal_close(journal, false);
+
+    journal = NULL;
+    if (journal_open(path, "transfer 1", &journal)) {
+        fail("test_journal(2)");
+        return 1;
+    }
+    value = journal_find(journal, "shard", 3);
+    if (!value || strcmp(value, "fourth") != 0) {
+        failed = 1;
+    }
+    journal_close(journal, false);
+
+    // the journal of another transfer is replaced
+    journal = NULL;
+    if (journal_open(path, "transfer 2", &journal)) {
+        fail("test_journal(3)");
+        return 1;
+    }
+    if (journal_find(journal, "shard", 0)) {
+        failed = 1;
+    }
+    journal_close(journal, true);
+
+    if (access(path, F_OK) == 0) {
+        failed = 1;
+    }
+
+    if (failed) {
+        fail("test_journal");
+    } else {
+        pass("test_journal");
+    }
+
+    free(path);
+
+    return 0;
+}
+
 int test_memory_mapping()
 {
 
@@ -1633,6 +2653,161 @@ int test_str_replace()
     return 0;
 }
 
+// Add a window of transfers of 1000 bytes that took 1 second together
+static bool add_concurrency_window(storj_concurrency_t *concurrency,
+                                   uint64_t start)
+{
+    bool changed = false;
+    uint32_t window = concurrency->limit;
+
+    for (uint32_t i = 0; i < window; i++) {
+        changed = concurrency_add_transfer(concurrency, 1000, start,
+                                           start + 1000);
+    }
+
+    return changed;
+}
+
+int test_concurrency()
+{
+    int failed = 0;
+    storj_concurrency_t concurrency;
+
+    concurrency_init(&concurrency, 1, 2, 16);
+    if (concurrency.limit != 2) {
+        failed = 1;
+    }
+
+    concurrency_init(&concurrency, 8, 32, 16);
+    if (concurrency.limit != 16 || concurrency.min != 16) {
+        failed = 1;
+    }
+
+    concurrency_init(&concurrency, 8, 2, 16);
+
+    // the limit is doubled while the throughput grows
+    if (!add_concurrency_window(&concurrency, 0) || concurrency.limit != 16) {
+        failed = 1;
+    }
+
+    // and is kept at the ceiling
+    if (add_concurrency_window(&concurrency, 1000) ||
+        concurrency.limit != 16) {
+        failed = 1;
+    }
+
+    // the same throughput can be reached with fewer transfers
+    if (!add_concurrency_window(&concurrency, 2000) ||
+        concurrency.limit != 12) {
+        failed = 1;
+    }
+
+    // the throughput dropped, so the limit is increased again
+    for (uint32_t i = 0; i < 12; i++) {
+        concurrency_add_transfer(&concurrency, 500, 3000, 4000);
+    }
+    if (concurrency.limit != 13) {
+        failed = 1;
+    }
+
+    // failures at the same time halve the limit once
+    if (!concurrency_add_failure(&concurrency) || concurrency.limit != 6 ||
+        concurrency_add_failure(&concurrency) || concurrency.limit != 6) {
+        failed = 1;
+    }
+
+    if (failed) {
+        fail("test_concurrency");
+    } else {
+        pass("test_concurrency");
+    }
+
+    return 0;
+}
+
+static bool add_farmer_report(storj_farmer_table_t *table, char *farmer_id,
+                              unsigned int code, uint64_t end)
+{
+    storj_exchange_report_t report = {
+        .farmer_id = farmer_id,
+        .code = code,
+        .start = end - 1000,
+        .end = end
+    };
+
+    return farmer_table_add_report(table, &report) == 0;
+}
+
+static bool check_exclude_list(storj_farmer_table_t *table, char *node_id,
+                               uint64_t now, char *expected)
+{
+    char *list = NULL;
+    if (farmer_table_exclude_list(table, node_id, now, &list)) {
+        return false;
+    }
+
+    bool matches = (!list && !expected) ||
+        (list && expected && 0 == strcmp(list, expected));
+
+    free(list);
+
+    return matches;
+}
+
+int test_farmer_table()
+{
+    int failed = 0;
+    uint64_t now = 1000000;
+
+    storj_farmer_table_t *table = farmer_table_new();
+    if (!table) {
+        fail("test_farmer_table(0)");
+        return 1;
+    }
+
+    // a farmer is excluded after a failure, and is bad after a few
+    if (!add_farmer_report(table, "a", STORJ_REPORT_FAILURE, now) ||
+        !check_exclude_list(table, NULL, now, "a") ||
+        farmer_table_is_bad(table, "a", now) ||
+        !add_farmer_report(table, "a", STORJ_REPORT_FAILURE, now) ||
+        !add_farmer_report(table, "a", STORJ_REPORT_FAILURE, now) ||
+        !farmer_table_is_bad(table, "a", now)) {
+        failed = 1;
+    }
+
+    if (!add_farmer_report(table, "b", STORJ_REPORT_SUCCESS, now) ||
+        farmer_table_find(table, "b")->error_rate != 0 ||
+        !check_exclude_list(table, "c", now, "a,c")) {
+        failed = 1;
+    }
+
+    // the farmers with the highest error rate are first
+    if (!add_farmer_report(table, "b", STORJ_REPORT_FAILURE, now + 1) ||
+        farmer_table_find(table, "b")->error_rate != 250 ||
+        !check_exclude_list(table, NULL, now, "a,b")) {
+        failed = 1;
+    }
+
+    // a success ends the exclusion, as does the time since the failure
+    if (!add_farmer_report(table, "a", STORJ_REPORT_SUCCESS, now) ||
+        !check_exclude_list(table, NULL, now, "b") ||
+        !check_exclude_list(table, "b", now, "b") ||
+        !check_exclude_list(table, NULL,
+                            now + 1 + STORJ_FARMER_EXCLUDE_TIME, NULL)) {
+        failed = 1;
+    }
+
+    farmer_table_destroy(table);
+
+    if (failed) {
+        fail("test_farmer_table");
+    } else {
+        pass("test_farmer_table");
+    }
+
+    return 0;
+}
+
 // Test Bridge Server
 struct MHD_Daemon *start_test_server()
 {
@@ -1646,6 +2821,80 @@ struct MHD_Daemon *start_test_server()
                             MHD_OPTION_END);
 }
 
+int test_report_queue()
+{
+    storj_env_t *env = storj_init_env(&bridge_options,
+                                      &encrypt_options,
+                                      &http_options,
+                                      &log_options);
+    assert(env != NULL);
+
+    storj_report_queue_t *queue = env->reports;
+
+    storj_exchange_report_t report = {
+        .data_hash = "269e72f24703be80bbb10499c91dc9b2022c4dc3",
+        .reporter_id = "testuser@storj.io",
+        .farmer_id = NULL,
+        .client_id = "testuser@storj.io",
+        .start = 1000,
+        .end = 2000,
+        .code = STORJ_REPORT_SUCCESS,
+        .message = STORJ_REPORT_SHARD_DOWNLOADED
+    };
+
+    // a report without a farmer isn't sent
+    int failed = report_queue_add(queue, &report) || queue->length != 0;
+
+    // a full batch is sent at once, the rest after the flush interval
+    report.farmer_id = "4bb49fb779e9233f9ed14f6ef34e29048911f018";
+    for (int i = 0; i < STORJ_REPORT_BATCH_SIZE + 8; i++) {
+        failed |= report_queue_add(queue, &report);
+    }
+
+    if (!queue->batch || queue->length != 8 ||
+        !uv_is_active((uv_handle_t *)queue->timer)) {
+        failed = 1;
+    }
+
+    if (uv_run(env->loop, UV_RUN_DEFAULT) ||
+        queue->batch || queue->length != 0) {
+        failed = 1;
+    }
+
+    storj_destroy_env(env);
+
+    // a batch that is being sent outlives the environment, and the reports
+    // that are still queued are dropped
+    env = storj_init_env(&bridge_options,
+                         &encrypt_options,
+                         &http_options,
+                         &log_options);
+    assert(env != NULL);
+
+    for (int i = 0; i < STORJ_REPORT_BATCH_SIZE + 8; i++) {
+        failed |= report_queue_add(env->reports, &report);
+    }
+
+    if (!env->reports->batch) {
+        failed = 1;
+    }
+
+    storj_destroy_env(env);
+
+    if (uv_run(uv_default_loop(), UV_RUN_DEFAULT)) {
+        failed = 1;
+    }
+
+    if (failed) {
+        fail("test_report_queue");
+        return 1;
+    }
+
+    pass("test_report_queue");
+
+    return 0;
+}
+
 int main(void)
 {
     // Make sure we have a tmp folder
@@ -1673,13 +2922,21 @@ int main(void)
 
     printf("Test Suite: Uploads\n");
     test_upload();
+    test_upload_stream();
     test_upload_cancel();
+    test_upload_journal();
     printf("\n");
 
     printf("Test Suite: Downloads\n");
     test_download();
+    test_download_stream();
+    test_download_range();
     test_download_null_mnemonic();
     test_download_cancel();
+    test_download_journal();
+    test_download_rate_limit();
+    test_download_hedge();
+    test_download_failed_farmer();
     printf("\n");
 
     printf("Test Suite: BIP39\n");
@@ -1696,6 +2953,9 @@ int main(void)
     printf("Test Suite: Crypto\n");
     test_generate_bucket_key();
     test_generate_file_key();
+    test_key_cache();
+    test_sha256_update_lanes();
+    test_aes256_ctr_crypt();
     test_increment_ctr_aes_iv();
     test_read_write_encrypted_file();
     test_meta_encryption();
@@ -1708,6 +2968,10 @@ int main(void)
     test_determine_shard_size();
     test_memory_mapping();
     test_str_replace();
+    test_journal();
+    test_concurrency();
+    test_farmer_table();
+    test_report_queue();
 
     int num_failed = tests_ran - test_status;
     printf(KGRN "\nPASSED: %i" RESET, test_status);
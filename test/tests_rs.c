@@ -81,6 +81,54 @@ void test_galois(void) {
     assert(galExp(13,7) == 43);
 }
 
+void test_mul_kernel(gf_mul_fn kernel, gf_mul_fn reference, int accumulate) {
+    gf src[1024 + 64], dst[1024 + 64], expect[1024 + 64];
+    int i, c, len, offset;
+
+    for(i = 0; i < (int)sizeof(src); i++) {
+        src[i] = (gf)(rand() % 256);
+    }
+
+    for(c = 1; c < 256; c += 7) {
+        for(len = 0; len < 1024; len += 61) {
+            for(offset = 0; offset < 3; offset++) {
+                for(i = 0; i < (int)sizeof(dst); i++) {
+                    dst[i] = expect[i] = (gf)(i * 31);
+                }
+                reference(expect + offset, src + offset, c, len, len, len + 5);
+                kernel(dst + offset, src + offset, c, len, len, len + 5);
+                assert(0 == memcmp(dst, expect, sizeof(dst)));
+            }
+        }
+    }
+
+    if(accumulate) {
+        /* past src_max the destination must be left untouched */
+        memset(dst, 0, sizeof(dst));
+        kernel(dst, src, 3, 100, 100, 40);
+        for(i = 40; i < 100; i++) {
+            assert(0 == dst[i]);
+        }
+    }
+}
+
+void test_mul_kernels(void) {
+    printf("%s:\n", __FUNCTION__);
+
+    test_mul_kernel(slow_addmul1, slow_addmul1, 1);
+
+#ifdef RS_HAVE_X86_SIMD
+    if(__builtin_cpu_supports("ssse3")) {
+        test_mul_kernel(ssse3_addmul1, slow_addmul1, 1);
+        test_mul_kernel(ssse3_mul1, slow_mul1, 0);
+    }
+    if(__builtin_cpu_supports("avx2")) {
+        test_mul_kernel(avx2_addmul1, slow_addmul1, 1);
+        test_mul_kernel(avx2_mul1, slow_mul1, 0);
+    }
+#endif
+}
+
 void test_sub_matrix(void) {
     int r, c, ptr, nrows = 10, ncols = 20;
     gf* m1 = (gf*)RS_MALLOC(nrows * ncols);
@@ -489,6 +537,48 @@ void test_encoding(void) {
     assert(0 == err);
 }
 
+void test_encoding_range(void) {
+    reed_solomon *rs;
+    uint8_t *data, *expect;
+    uint8_t *data_blocks[17];
+    uint8_t *fec_blocks[6];
+    int block_size = 3*RS_STRIPE_SIZE + 123;
+    int data_size = 17*block_size - 5000;
+    int nr_shards = 17 + 6;
+    int i, offset, length;
+
+    printf("%s:\n", __FUNCTION__);
+
+    rs = reed_solomon_new(17, 6);
+    data = test_create_random(rs, data_size, block_size);
+    expect = malloc(nr_shards * block_size);
+
+    for(i = 0; i < 17; i++) {
+        data_blocks[i] = data + i*block_size;
+    }
+    for(i = 0; i < 6; i++) {
+        fec_blocks[i] = expect + (17 + i)*block_size;
+    }
+    assert(0 == reed_solomon_encode(rs, data_blocks, fec_blocks, block_size, data_size));
+
+    // encode in uneven ranges, as separate threads would
+    for(i = 0; i < 6; i++) {
+        fec_blocks[i] = data + (17 + i)*block_size;
+    }
+    length = block_size / 3 + 7;
+    for(offset = 0; offset < block_size; offset += length) {
+        assert(0 == reed_solomon_encode_range(rs, data_blocks, fec_blocks,
+                                              block_size, data_size,
+                                              offset, length));
+    }
+
+    assert(0 == memcmp(data + 17*block_size, expect + 17*block_size, 6*block_size));
+
+    free(data);
+    free(expect);
+    reed_solomon_release(rs);
+}
+
 void test_reconstruct(void) {
 #define FEC_START (10*6)
     printf("%s:\n", __FUNCTION__);
@@ -849,12 +939,14 @@ int main(void) {
     fec_init();
 
     test_galois();
+    test_mul_kernels();
     test_sub_matrix();
     test_multiply();
     test_inverse();
     test_one_encoding();
     test_one_decoding();
     test_encoding();
+    test_encoding_range();
     test_reconstruct();
     printf("reach here means test all ok\n");
 